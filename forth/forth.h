@@ -38,15 +38,43 @@ SOFTWARE.
 // -DFORTH_INT_SIZE_8_BITS=1
 //
 //---------------------------------------------------------------------------
-// You can redefine how many characters are store in the dictionnary per 
-// entry. By default, it is 32. This doesn't mean word lengths are limited
-// to this. It first checks the length, then compares those characters.
-//
-// i.e.: if you want 3 characters per word
-// -DFORTH_DICT_CHAR_COUNT=3
+// Word names are stored back to back in a string arena. Each dictionnary 
+// entry only keeps an offset and a length into it, so names have no length
+// limit and short names don't waste space.
 //
 // The total size of a dictionnary is:
-// word_count * (FORTH_DICT_CHAR_COUNT + sizeof(forth_pointer) + 1)
+// word_count * (sizeof(forth_pointer) + 2 * sizeof(int)) + total name length
+//
+//---------------------------------------------------------------------------
+// Recently found words are kept in a small direct-mapped cache in front of
+// the dictionnary scan. The size must be a power of two, 0 disables it.
+//
+// -DFORTH_DICT_CACHE_SIZE=64
+//
+//---------------------------------------------------------------------------
+// With forth_create_context_ex, the data space can be a reserved range of
+// address space where pages are only committed as it fills up. It never
+// moves, so host pointers into it stay valid. Unix only.
+//
+//---------------------------------------------------------------------------
+// Stacks can be placed between guard pages instead of checking their 
+// capacity on every push. Overflows are caught by a SIGSEGV handler and
+// reported like any other error. Infinite stacks get a fixed size, in cell
+// count. Unix only.
+//
+// -DFORTH_GUARDED_STACKS=1
+// -DFORTH_GUARDED_STACK_SIZE=1048576
+//
+//---------------------------------------------------------------------------
+// ALLOCATE, FREE and RESIZE use a per-context heap, separate from the data
+// space. Blocks up to 2KB come from size classes with their own free lists,
+// larger ones are rounded to 4KB. Heap addresses have their top bit set.
+//
+//---------------------------------------------------------------------------
+// Scratch memory for interpreted S", PAD, WORD, PARSE and pictured numeric
+// output comes from a per-context transient region, reset at the start of
+// each forth_eval. It never touches the data space or the heap. Transient
+// addresses have their two top bits set.
 //
 //---------------------------------------------------------------------------
 // In this file, public API constants, typdefs, structs and functions
@@ -74,6 +102,8 @@ extern "C"
 #define FORTH_MEM_INFINITE -1
 #define FORTH_FALSE 0
 #define FORTH_TRUE -1
+#define FORTH_DEFAULT_RESERVE_SIZE (1 << 30)
+#define FORTH_DEFAULT_TRANSIENT_RESERVE 1024 // PAD, HOLD and a few strings
 
 typedef uintptr_t forth_pointer;
 
@@ -100,13 +130,36 @@ typedef uint64_t forth_uint;
 typedef uint64_t forth_double_length_uint;
 #endif
 
-#ifndef FORTH_DICT_CHAR_COUNT
-#define FORTH_DICT_CHAR_COUNT 32
+#ifndef FORTH_DICT_CACHE_SIZE
+#define FORTH_DICT_CACHE_SIZE 64
+#endif
+
+#define FORTH_HEAP_SIZE_CLASSES 8
+
+// Longest line forth_eval_stream can read
+#ifndef FORTH_INPUT_BUFFER_SIZE
+#define FORTH_INPUT_BUFFER_SIZE 4096
+#endif
+
+#ifndef FORTH_GUARDED_STACK_SIZE
+#define FORTH_GUARDED_STACK_SIZE (1 << 20)
 #endif
 
 typedef int (*forth_c_func)(struct forth_context*);
+
+typedef struct forth_c_word
+{
+    const char* name;
+    forth_c_func fn;
+} forth_c_word;
+
+static_assert(sizeof(forth_c_func) == sizeof(uintptr_t), "C functions are written as offsets");
 typedef int (*forth_log_func)(struct forth_context*, const char *fmt, ...);
 
+// Reads up to size bytes of code. Returns how many were read, 0 at the end
+// of the input, or a negative value on error
+typedef int (*forth_read_func)(void* user, char* buffer, int size);
+
 typedef struct forth_cell
 {
     union
@@ -117,11 +170,100 @@ typedef struct forth_cell
     };
 } forth_cell;
 
+typedef struct forth_dict_cache_entry
+{
+    uint32_t hash;
+    int position; // Position from the start of the owner's dictionnary
+    const struct forth_context* owner;
+} forth_dict_cache_entry;
+
+// Memory callbacks used for a context and all of its buffers. realloc can be
+// NULL, buffers are then moved with alloc and free.
+typedef struct forth_allocator
+{
+    void* (*alloc)(void* user, size_t size);
+    void* (*realloc)(void* user, void* ptr, size_t size);
+    void (*free)(void* user, void* ptr);
+    void* user;
+} forth_allocator;
+
+typedef struct forth_heap
+{
+    uint8_t* memory;
+    uint8_t* block_starts; // A bit per 8 bytes of memory, set where a block starts
+    int size;
+    int pointer;
+    int free_lists[FORTH_HEAP_SIZE_CLASSES + 1]; // Last one for large blocks
+    int used;       // Requested bytes of live blocks
+    int allocated;  // Bytes of live blocks, headers included
+    int block_count;
+} forth_heap;
+
+typedef struct forth_heap_stats
+{
+    size_t capacity;        // Heap buffer size
+    size_t extent;          // Bytes handed out to blocks so far
+    size_t allocated;       // Bytes of live blocks, headers included
+    size_t used;            // Bytes requested by live blocks
+    size_t free;            // Bytes waiting in free lists
+    int block_count;        // Live blocks
+    double fragmentation;   // Share of the extent not holding requested bytes
+} forth_heap_stats;
+
+typedef struct forth_stats
+{
+    size_t memory_used;         // Data space bytes in use, shared ones excluded
+    size_t memory_size;         // Data space bytes allocated or committed
+    size_t memory_reserved;     // Address space reserved, memory_size if malloc'd
+    size_t code_bytes;          // Used bytes from the first word defined on
+    size_t data_bytes;          // Used bytes before it
+    size_t memory_high_water;
+    int dict_entries;
+    int dict_capacity;
+    int dict_high_water;
+    int stack_depth;
+    int stack_capacity;
+    int stack_high_water;
+    int return_stack_depth;
+    int return_stack_capacity;
+    int return_stack_high_water;
+    int grow_count;             // Buffers grown since creation
+    double grow_time;           // Seconds spent growing them
+    int include_cache_hits;     // INCLUDEs loaded from the cache
+    int dict_cache_hits;        // Lookups that skipped the dictionnary scan
+} forth_stats;
+
+// A file loaded by INCLUDE, INCLUDED or REQUIRED, whatever the path naming it
+typedef struct forth_included_file
+{
+    uint64_t device;
+    uint64_t inode;
+} forth_included_file;
+
+// Where the code being interpreted comes from. Strings are a single input
+// buffer, streams are read one line at a time
+typedef struct forth_input
+{
+    const char* source;         // Start of the input buffer
+    forth_read_func read;       // NULL for strings
+    void* user;
+    char* buffer;               // Lines read from the stream
+    int buffer_filled;
+    int next_line;              // Offset of the next line in buffer
+    uint8_t end;                // Nothing left to read
+    int line;
+    int id;                     // Identifies the source for RESTORE-INPUT
+    forth_pointer to_in;        // 0 until >IN is used
+    forth_pointer source_copy;  // 0 until SOURCE is used
+} forth_input;
+
 typedef struct forth_context
 {
     uint8_t* memory;
     int memory_size;
     uint8_t memory_auto_resize;
+    int memory_reserved_size; // Reserved address space, 0 if malloc'd
+    uint8_t huge_pages;       // Buffers are advised for transparent huge pages
     forth_pointer memory_pointer;
     forth_pointer program_pointer;
 
@@ -135,16 +277,76 @@ typedef struct forth_context
     uint8_t return_stack_auto_resize;
     int return_stack_pointer;
 
-    uint8_t* dict_name_lens;
-    char* dict_names;
+    int* dict_name_offsets;
+    int* dict_name_lens;
     forth_pointer* dict_pointers;
+    char* dict_names;
+    int dict_names_size;
+    int dict_names_pointer;
     int dict_size;
     uint8_t dict_auto_resize;
     int dict_pointer;
     int default_dict_pointer;
+    forth_pointer default_memory_pointer;
+
+    // Where C functions are written in the data space, in increasing order.
+    // Saved images relocate them.
+    forth_pointer* fn_offsets;
+    int fn_offsets_size;
+    int fn_offsets_pointer;
+
+#if FORTH_DICT_CACHE_SIZE > 0
+    forth_dict_cache_entry dict_cache[FORTH_DICT_CACHE_SIZE];
+#endif
+    int dict_cache_hits;
+
+    const struct forth_context* parent;
+    forth_pointer shared_memory_size;
+    uint8_t frozen;
+
+    size_t block_size;
+    uint8_t* image;                     // Mapped image the buffers are in
+    size_t image_size;
+    int grow_count;
+    uint64_t grow_time;                 // In nanoseconds
+    int eval_allocation_count;          // Allocations made while evaluating
+    uint8_t forbid_eval_allocations;    // Make them fail instead
+
+    // Peak usage, to size contexts statically
+    forth_pointer memory_high_water;
+    int stack_high_water;
+    int return_stack_high_water;
+    int dict_high_water;
+    forth_allocator allocator;
+    forth_heap heap;
+
+    uint8_t* transient;
+    int transient_size;
+    int transient_pointer;
+    forth_pointer pad;          // 0 until PAD is used in the current eval
+    forth_pointer hold_start;   // Pictured numeric output buffer, 0 until <#
+    forth_pointer hold_pointer;
+    int eval_depth;
+
+    // A MARKER ran, what it removes goes once the running words return
+    uint8_t marker_pending;
+    int marker_dict_pointer;
+    forth_pointer marker_memory_pointer;
+
+    const char* include_cache_dir;  // Compiled INCLUDEs are cached there if set
+    int include_cache_hits;
+    uint8_t include_effects;        // Something ran outside of definitions
+
+    // Files loaded so far, REQUIRED doesn't load them again
+    forth_included_file* included_files;
+    int included_files_size;
+    int included_files_pointer;
 
     forth_log_func log;
     const char* code;
+    const char* code_end;
+    forth_input input;
+    int input_count;
     int state;
     const char* token;
     size_t token_len;
@@ -152,6 +354,33 @@ typedef struct forth_context
     forth_pointer base;
 } forth_context;
 
+typedef struct forth_context_options
+{
+    int memory_size;        // in bytes
+    int stack_size;         // in cell count
+    int return_stack_size;  // in pointer count
+    int dict_size;          // in word count
+
+    // Reserve memory_size bytes of address space for the data space, or
+    // FORTH_DEFAULT_RESERVE_SIZE if infinite, and commit pages as it fills up
+    uint8_t reserve_memory;
+
+    // Map the data space on huge page boundaries and advise transparent huge
+    // pages for it and the stacks. Implies reserve_memory when mmap is 
+    // available, falls back to regular pages when THP isn't.
+    uint8_t huge_pages;
+
+    // Allocator for the context and its buffers, malloc if NULL. Reserved
+    // memory and guarded stacks are mapped directly.
+    const forth_allocator* allocator;
+
+    // Existing directory where INCLUDE caches the code it compiles, keyed by
+    // the file's content and the dictionnary it's compiled against. Only 
+    // files that just define words are cached. Must outlive the context,
+    // NULL to disable.
+    const char* include_cache_dir;
+} forth_context_options;
+
 // Create a context. Returns NULL if failed to create
 //  memory_size         : in bytes
 //  stack_size          : in cell count
@@ -162,27 +391,175 @@ forth_context* forth_create_context(int memory_size       = FORTH_MEM_INFINITE,
                                     int return_stack_size = FORTH_MEM_INFINITE,
                                     int dict_size         = FORTH_MEM_INFINITE);
 
+// Options matching forth_create_context's defaults
+forth_context_options forth_default_context_options();
+
+// Create a context with extra options. Returns NULL if failed to create
+forth_context* forth_create_context_ex(const forth_context_options* options);
+
+// Freeze a fully loaded context so it can be used as the base of child
+// contexts. A frozen context can't evaluate code or get new words anymore.
+void forth_freeze_context(forth_context* ctx);
+
+// Shrink the auto-resized buffers down to their current usage plus some
+// slack, and give unused mapped pages back to the OS. High-water marks are
+// kept, reservations are not. Can't be called on a frozen context or during evaluation. Returns 
+// FORTH_SUCCESS on success
+int forth_trim(forth_context* ctx);
+
+// Create a context sharing the dictionnary and code of a frozen base context.
+// The child only allocates its own data space, stacks and new definitions,
+// with the base's allocator.
+// The base context must outlive all of its children. Returns NULL if failed
+// to create, or if base is not frozen.
+forth_context* forth_create_child_context(const forth_context* base,
+                                          int memory_size       = FORTH_MEM_INFINITE,
+                                          int stack_size        = FORTH_MEM_INFINITE,
+                                          int return_stack_size = FORTH_MEM_INFINITE,
+                                          int dict_size         = FORTH_MEM_INFINITE);
+
+// Create an independent copy of a context: memory, stacks and dictionnary.
+// The copy is made in a single allocation, with the context's allocator.
+// Returns NULL if failed to create
+forth_context* forth_clone_context(const forth_context* ctx);
+
 // Destroy a context
 void forth_destroy_context(forth_context* ctx);
 
+// Grow buffers ahead of time so evaluation doesn't have to. Makes sure there
+// is room for memory_bytes more bytes of data space, stack_cells more cells
+// on the stack, return_stack_cells more on the return stack and dict_words
+// more words. transient_bytes covers S", PAD and pictured numbers for one
+// evaluation, heap_bytes the ALLOCATE blocks (headers and rounding included).
+// Set forbid_eval_allocations on a warmed up context to make any allocation
+// left in forth_eval fail. Returns FORTH_SUCCESS on success
+int forth_reserve(forth_context* ctx, 
+                  int memory_bytes, 
+                  int stack_cells, 
+                  int return_stack_cells, 
+                  int dict_words,
+                  int transient_bytes   = FORTH_DEFAULT_TRANSIENT_RESERVE,
+                  int heap_bytes        = 0);
+
+// Fill stats with the usage of the ALLOCATE heap
+void forth_get_heap_stats(const forth_context* ctx, forth_heap_stats* stats);
+
+// Fill stats with the usage of the context's buffers
+void forth_get_stats(const forth_context* ctx, forth_stats* stats);
+
 // Returns cell on top of the stack, or NULL if stack is empty
 forth_cell* forth_get_top(forth_context* ctx, int offset = 0);
 
 // Evaluate code. Returns FORTH_SUCCESS on success
 int forth_eval(forth_context* ctx, const char* code);
 
+// Evaluate len bytes of code, that don't need to be null terminated. Nothing
+// past them is read. Returns FORTH_SUCCESS on success
+int forth_eval_n(forth_context* ctx, const char* code, size_t len);
+
+// Evaluate code read from a stream, one line at a time. Definitions and
+// comments can span lines. Strings made while interpreting only last until
+// the next line. Returns FORTH_SUCCESS on success
+int forth_eval_stream(forth_context* ctx, forth_read_func read, void* user);
+
+// forth_read_func reading from a FILE*
+int forth_read_file(void* file, char* buffer, int size);
+
 // Add a C-function word to the dictionnary. Returns FORTH_SUCCESS on success
 int forth_add_c_word(forth_context* ctx, const char* name, forth_c_func fn);
 
+// Save the data space, dictionnary and BASE of a context to a file. C 
+// functions are saved by name. With roots, only the named words and the 
+// words and C words they use are saved, packed together. Child contexts 
+// can't be saved. Returns FORTH_SUCCESS on success
+int forth_save_image(forth_context* ctx, const char* path, const char* const* roots = NULL, int root_count = 0);
+
+// Create a context from a saved image, in a single read. c_words are the
+// words that were added with forth_add_c_word, to relocate them. Images only
+// load in the configuration they were saved from. Returns NULL if failed 
+// to load
+forth_context* forth_load_image(const char* path, const forth_c_word* c_words = NULL, int c_word_count = 0);
+
+// Map a saved image read-only, so processes loading it share its pages. The
+// context is frozen, use it as the base of child contexts. C functions are
+// only patched, copying their pages, when the image comes from another 
+// program. Falls back to loading it where mmap isn't available. Returns NULL
+// if failed to map
+forth_context* forth_map_image(const char* path, const forth_c_word* c_words = NULL, int c_word_count = 0);
+
 //---------------------------------------------------------------------------
 // IMPLEMENTATION
 //---------------------------------------------------------------------------
 
 #if defined(FORTH_IMPLEMENT)
 
+#include <limits.h>
 #include <math.h>
 
+#if defined(__unix__) || defined(__APPLE__)
+#define FORTHI_HAS_MMAN 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define FORTHI_HAS_MMAN 0
+#endif
+
+extern "C++"
+{
+#include <chrono>
+}
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FORTHI_HAS_SSE2 1
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#else
+#define FORTHI_HAS_SSE2 0
+#endif
+
+#if FORTH_GUARDED_STACKS
+#if !FORTHI_HAS_MMAN
+#error "FORTH_GUARDED_STACKS requires mmap"
+#endif
+#include <setjmp.h>
+#include <signal.h>
+#endif
+
 #define FORTHI_MEM_ALLOC_CHUNK_SIZE 1024
+#define FORTHI_DICT_NAMES_ALLOC_SIZE 4096 // Fits the standard words
+#define FORTHI_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+#define FORTHI_CHILD_ALLOC_SIZE 128
+#define FORTHI_RESERVED_NAME_LEN 16
+#define FORTHI_TRIM_SLACK 128 // In bytes, cells or words
+#define FORTHI_SCAN_BLOCK_SIZE 16
+#define FORTHI_SCAN_SCALAR_LEN 16 // Measured crossover, shorter runs don't pay for blocks
+
+#define FORTHI_IMAGE_MAGIC "DFORTHIM"
+#define FORTHI_IMAGE_VERSION 2
+#define FORTHI_IMAGE_ALIGNMENT 65536 // Covers the page sizes in use
+#define FORTHI_INCLUDE_CACHE_MAGIC "DFORTHIC"
+#define FORTHI_INCLUDE_CACHE_VERSION 2
+#define FORTHI_INCLUDE_CACHE_PATH_SIZE 1024
+#define FORTHI_FILENAME_SIZE 260
+#define FORTHI_IMAGE_BUILTIN 0
+#define FORTHI_IMAGE_USER 1
+
+#define FORTHI_HEAP_BASE ((forth_pointer)1 << (sizeof(forth_pointer) * 8 - 1))
+#define FORTHI_HEAP_MIN_BLOCK_SIZE 16
+#define FORTHI_HEAP_LARGE_BLOCK_SIZE 4096
+#define FORTHI_HEAP_FREE_BLOCK 0xFFFFFFFF
+#define FORTHI_TRANSIENT_BASE ((forth_pointer)3 << (sizeof(forth_pointer) * 8 - 2))
+#define FORTHI_PAD_SIZE 256
+#define FORTHI_HOLD_SIZE 256
+#define FORTHI_COUNTED_STRING_MAX_LEN 255
+
+#define FORTHI_IOR_ALLOCATE -59
+#define FORTHI_IOR_FREE -60
+#define FORTHI_IOR_RESIZE -61
 
 #define FORTHI_STATE_INTERPRET 0
 #define FORTHI_STATE_COMPILE 1
@@ -230,16 +607,40 @@ int forth_add_c_word(forth_context* ctx, const char* name, forth_c_func fn);
 //---------------------------------------------------------------------------
 
 // Memory
+static uint8_t* forthi_memory_at(const forth_context* ctx, forth_pointer at);
+static int forthi_count_allocation(forth_context* ctx);
+static void* forthi_alloc_buffer(forth_context* ctx, size_t size);
+static void forthi_free_buffer(forth_context* ctx, void* buffer);
+static void* forthi_realloc_buffer(forth_context* ctx, void* buffer, size_t size, size_t new_size);
+static int forthi_next_capacity(int size);
 static int forthi_grow_memory(forth_context* ctx);
 static int forthi_grow_stack(forth_context* ctx);
 static int forthi_grow_return_stack(forth_context* ctx);
 static int forthi_grow_dictionnary(forth_context* ctx);
+static int forthi_grow_dictionnary_names(forth_context* ctx);
+static int forthi_grow_fn_offsets(forth_context* ctx);
+static void forthi_release_pages(void* start, void* end);
+static void forthi_advise_huge_pages(void* start, size_t size);
+static int forthi_commit_size(forth_context* ctx, int size);
+static uint64_t forthi_now();
+static void forthi_count_grow(forth_context* ctx, uint64_t start);
+static void forthi_release_memory(forth_context* ctx);
+static void forthi_update_high_water(forth_context* ctx);
+#if FORTH_GUARDED_STACKS
+static forth_cell* forthi_alloc_guarded_stack(int size);
+static void forthi_free_guarded_stack(forth_cell* stack, int size);
+static void forthi_install_guard_handler();
+#endif
 static int forthi_reserve_memory_space(forth_context* ctx, int size);
 static int forthi_check_valid_memory_range(forth_context* ctx, forth_pointer at, forth_pointer size = 1);
 static int forthi_write_byte(forth_context* ctx, uint8_t data);
 static int forthi_write_number(forth_context* ctx, forth_int data);
 static int forthi_write_number_at(forth_context* ctx, forth_int data, forth_pointer at);
 static int forthi_write_pointer(forth_context* ctx, forth_pointer data);
+static uintptr_t forthi_function_key(forth_c_func fn);
+static uintptr_t forthi_encode_function(forth_c_func fn);
+static void forthi_store_function(uint8_t* at, forth_c_func fn);
+static forth_c_func forthi_function_at(const uint8_t* at);
 static int forthi_write_function(forth_context* ctx, forth_c_func fn);
 static int forthi_write_text(forth_context* ctx, const char* text, size_t len);
 static int forthi_read_byte(forth_context* ctx, uint8_t* data);
@@ -249,6 +650,22 @@ static int forthi_read_number_at(forth_context* ctx, forth_int* data, forth_poin
 static int forthi_read_pointer(forth_context* ctx, forth_pointer* data);
 static const char* forthi_read_text(forth_context* ctx, forth_int* len);
 
+// Heap
+static void forthi_init_heap(forth_heap* heap);
+static int forthi_heap_size_class(forth_pointer block_size);
+static int forthi_grow_heap(forth_context* ctx, int bytes);
+static int forthi_heap_alloc(forth_context* ctx, forth_pointer size, forth_pointer* at);
+static int forthi_heap_free(forth_context* ctx, forth_pointer at);
+static int forthi_heap_resize(forth_context* ctx, forth_pointer at, forth_pointer size, forth_pointer* new_at);
+void forth_get_heap_stats(const forth_context* ctx, forth_heap_stats* stats);
+void forth_get_stats(const forth_context* ctx, forth_stats* stats);
+
+// Transient region
+static void forthi_reset_transient(forth_context* ctx);
+static int forthi_grow_transient(forth_context* ctx, int bytes);
+static int forthi_transient_alloc(forth_context* ctx, forth_pointer size, forth_pointer* at);
+static int forthi_transient_copy(forth_context* ctx, const char* text, size_t len, forth_pointer* at);
+
 // Stack
 static int forthi_push_cell(forth_context* ctx, forth_cell cell);
 static int forthi_push_int_number(forth_context* ctx, forth_int number);
@@ -272,33 +689,63 @@ static int forthi_compile_word_call(forth_context* ctx, forth_pointer pointer);
 
 // Dictionnary
 static int forthi_add_word(forth_context* ctx, const char* name, int name_len, forth_pointer memory_offset);
+static void forthi_truncate_dictionnary(forth_context* ctx, int dict_pointer);
+static void forthi_rewind(forth_context* ctx, int dict_pointer, forth_pointer memory_pointer);
 int forth_add_c_word(forth_context* ctx, const char* name, forth_c_func fn);
+static uint32_t forthi_hash_name(const char* name, size_t name_len);
+static void forthi_clear_dict_cache(forth_context* ctx);
+static int forthi_find_word_index(const forth_context* ctx, int index, const char* name, size_t name_len);
 static forth_pointer forthi_get_word(forth_context* ctx, const char* name, size_t name_len);
 static int forthi_get_word_index(forth_context* ctx, const char* name, size_t name_len);
 
 // Interpreting
 static int forthi_is_space(char c);
+static const char* forthi_skip_spaces(const char* code, const char* code_end);
+static const char* forthi_skip_token(const char* code, const char* code_end);
 static const char* forthi_trim_code(forth_context* ctx);
 static const char* forthi_read_until(forth_context* ctx, char delim);
 static const char* forthi_get_next_token(forth_context* ctx, size_t* token_len);
 static int forthi_interpret_token(forth_context* ctx);
 static int forthi_interpret(forth_context* ctx);
+static int forthi_refill(forth_context* ctx);
+static int forthi_run(forth_context* ctx);
+static int forthi_execute(forth_context* ctx);
+static int forthi_eval(forth_context* ctx, const char* code, size_t len);
 int forth_eval(forth_context* ctx, const char* code);
+int forth_eval_n(forth_context* ctx, const char* code, size_t len);
+int forth_eval_stream(forth_context* ctx, forth_read_func read, void* user);
+int forth_read_file(void* file, char* buffer, int size);
+
+// Include cache
+static uint64_t forthi_hash_bytes(uint64_t hash, const void* data, size_t size);
+static uint64_t forthi_hash_include_state(forth_context* ctx);
+static int forthi_include_cache_path(forth_context* ctx, const char* filename, char* path, size_t path_size);
+static int forthi_apply_include_cache(forth_context* ctx, const uint8_t* data, size_t size, 
+                                      uint64_t content_hash, uint64_t state_hash);
+static int forthi_load_include_cache(forth_context* ctx, const char* path, uint64_t content_hash, uint64_t state_hash);
+static void forthi_save_include_cache(forth_context* ctx, const char* path, uint64_t content_hash, uint64_t state_hash,
+                                      forth_pointer memory_pointer, int dict_pointer, int fn_offsets_pointer);
 
 // Standard words (Only those requiring forward declaration)
 static int forthi_word_abort_quote(forth_context* ctx);
+static int forthi_word_backslash(forth_context* ctx);
 static int forthi_word_BEGIN(forth_context* ctx);
+static int forthi_word_colon(forth_context* ctx);
 static int forthi_word_DO(forth_context* ctx);
 static int forthi_word_dot_quote(forth_context* ctx);
 static int forthi_word_ELSE(forth_context* ctx);
 static int forthi_word_EXECUTE(forth_context* ctx);
 static int forthi_word_IF(forth_context* ctx);
 static int forthi_word_LOOP(forth_context* ctx);
+static int forthi_word_marker_restore(forth_context* ctx);
+static void forthi_apply_marker(forth_context* ctx);
 static int forthi_word_NUMBER(forth_context* ctx);
 static int forthi_word_paren(forth_context* ctx);
 static int forthi_word_plus_loop(forth_context* ctx);
 static int forthi_word_slash_loop(forth_context* ctx);
+static int forthi_word_store(forth_context* ctx);
 static int forthi_word_REPEAT(forth_context* ctx);
+static int forthi_word_s_quote(forth_context* ctx);
 static int forthi_word_semicolon(forth_context* ctx);
 static int forthi_word_THEN(forth_context* ctx);
 static int forthi_word_UNTIL(forth_context* ctx);
@@ -308,84 +755,476 @@ static int forthi_word_WHILE(forth_context* ctx);
 // MEMORY
 //---------------------------------------------------------------------------
 
+static uint8_t* forthi_memory_at(const forth_context* ctx, forth_pointer at)
+{
+    // Addresses below shared_memory_size belong to the frozen base context
+    if (at < ctx->shared_memory_size)
+        return forthi_memory_at(ctx->parent, at);
+
+    if (at >= FORTHI_HEAP_BASE)
+    {
+        if (at >= FORTHI_TRANSIENT_BASE)
+            return ctx->transient + (at - FORTHI_TRANSIENT_BASE);
+        return ctx->heap.memory + (at - FORTHI_HEAP_BASE);
+    }
+
+    return ctx->memory + (at - ctx->shared_memory_size);
+}
+
+static void* forthi_default_alloc(void* user, size_t size)
+{
+    (void)user;
+    return malloc(size);
+}
+
+static void* forthi_default_realloc(void* user, void* ptr, size_t size)
+{
+    (void)user;
+    return realloc(ptr, size);
+}
+
+static void forthi_default_free(void* user, void* ptr)
+{
+    (void)user;
+    free(ptr);
+}
+
+static forth_allocator forthi_default_allocator()
+{
+    forth_allocator allocator;
+    allocator.alloc = forthi_default_alloc;
+    allocator.realloc = forthi_default_realloc;
+    allocator.free = forthi_default_free;
+    allocator.user = NULL;
+    return allocator;
+}
+
+static int forthi_count_allocation(forth_context* ctx)
+{
+    if (ctx->eval_depth == 0)
+        return FORTH_SUCCESS;
+
+    ctx->eval_allocation_count++;
+    if (ctx->forbid_eval_allocations)
+    {
+        FORTH_LOG(ctx, "Allocation during evaluation\n");
+        return FORTH_FAILURE;
+    }
+
+    return FORTH_SUCCESS;
+}
+
+static void* forthi_alloc_buffer(forth_context* ctx, size_t size)
+{
+    if (forthi_count_allocation(ctx) == FORTH_FAILURE)
+        return NULL;
+
+    return ctx->allocator.alloc(ctx->allocator.user, size);
+}
+
+// Buffers of a cloned context live in the same allocation as the context
+// itself, they are released all at once with it
+static int forthi_is_in_clone_block(forth_context* ctx, void* buffer)
+{
+    uint8_t* block = (uint8_t*)ctx;
+    return (uint8_t*)buffer >= block && (uint8_t*)buffer < block + ctx->block_size;
+}
+
+static void forthi_free_buffer(forth_context* ctx, void* buffer)
+{
+    if (forthi_is_in_clone_block(ctx, buffer))
+        return;
+
+    // Mapped images are unmapped at once too
+    if ((uint8_t*)buffer >= ctx->image && (uint8_t*)buffer < ctx->image + ctx->image_size)
+        return;
+
+    ctx->allocator.free(ctx->allocator.user, buffer);
+}
+
+static void* forthi_realloc_buffer(forth_context* ctx, void* buffer, size_t size, size_t new_size)
+{
+    // Buffers inside a cloned context's block can't be reallocated in place
+    int in_block = forthi_is_in_clone_block(ctx, buffer);
+    if (forthi_count_allocation(ctx) == FORTH_FAILURE)
+        return NULL;
+
+    if (!in_block && ctx->allocator.realloc)
+        return ctx->allocator.realloc(ctx->allocator.user, buffer, new_size);
+
+    void* new_buffer = ctx->allocator.alloc(ctx->allocator.user, new_size);
+    if (!new_buffer)
+        return NULL;
+
+    if (buffer)
+    {
+        memcpy(new_buffer, buffer, size);
+        forthi_free_buffer(ctx, buffer);
+    }
+    return new_buffer;
+}
+
+static int forthi_next_capacity(int size)
+{
+    // Grow geometrically so filling a buffer costs a logarithmic number of
+    // reallocations
+    if (size < FORTHI_MEM_ALLOC_CHUNK_SIZE)
+        return size + FORTHI_MEM_ALLOC_CHUNK_SIZE;
+    if (size > INT_MAX / 2)
+        return INT_MAX;
+    return size * 2;
+}
+
 static int forthi_grow_memory(forth_context* ctx)
 {
-    int new_size = ctx->memory_size + FORTHI_MEM_ALLOC_CHUNK_SIZE;
+    uint64_t start = forthi_now();
+    int own_size = ctx->memory_size - (int)ctx->shared_memory_size;
+    int new_size = forthi_next_capacity(own_size);
+    if (new_size == own_size || new_size > INT_MAX - (int)ctx->shared_memory_size)
+        return FORTH_FAILURE;
+
+#if FORTHI_HAS_MMAN
+    // Reserved memory grows in place by committing more of its pages
+    if (ctx->memory_reserved_size)
+    {
+        new_size = forthi_commit_size(ctx, new_size);
+        if (new_size > ctx->memory_reserved_size)
+            new_size = ctx->memory_reserved_size;
+        if (new_size == own_size)
+            return FORTH_FAILURE;
+
+        if (mprotect(ctx->memory + own_size, new_size - own_size, PROT_READ | PROT_WRITE) != 0)
+            return FORTH_FAILURE;
+
+        ctx->memory_size += new_size - own_size;
+        forthi_count_grow(ctx, start);
+
+        return FORTH_SUCCESS;
+    }
+#endif
 
-    uint8_t* new_memory = (uint8_t*)malloc(new_size);
+    uint8_t* new_memory = (uint8_t*)forthi_realloc_buffer(ctx, ctx->memory, own_size, new_size);
     if (!new_memory)
         return FORTH_FAILURE;
 
-    memcpy(new_memory, ctx->memory, ctx->memory_size);
-    free(ctx->memory);
     ctx->memory = new_memory;
-    ctx->memory_size = new_size;
+    ctx->memory_size += new_size - own_size;
+    forthi_count_grow(ctx, start);
+    if (ctx->huge_pages)
+        forthi_advise_huge_pages(ctx->memory, new_size);
 
     return FORTH_SUCCESS;
 }
 
 static int forthi_grow_stack(forth_context* ctx)
 {
-    int new_size = sizeof(forth_cell) * (ctx->stack_size + FORTHI_MEM_ALLOC_CHUNK_SIZE);
+    uint64_t start = forthi_now();
+    int new_size = forthi_next_capacity(ctx->stack_size);
+    if (new_size == ctx->stack_size)
+        return FORTH_FAILURE;
 
-    forth_cell* new_stack = (forth_cell*)malloc(new_size);
+    forth_cell* new_stack = (forth_cell*)forthi_realloc_buffer(ctx, ctx->stack, 
+        sizeof(forth_cell) * ctx->stack_size, sizeof(forth_cell) * new_size);
     if (!new_stack)
         return FORTH_FAILURE;
 
-    memcpy(new_stack, ctx->stack, ctx->stack_size * sizeof(forth_cell));
-    free(ctx->stack);
     ctx->stack = new_stack;
     ctx->stack_size = new_size;
+    forthi_count_grow(ctx, start);
+    if (ctx->huge_pages)
+        forthi_advise_huge_pages(ctx->stack, sizeof(forth_cell) * new_size);
 
     return FORTH_SUCCESS;
 }
 
 static int forthi_grow_return_stack(forth_context* ctx)
 {
-    int new_size = sizeof(forth_cell) * (ctx->return_stack_size + FORTHI_MEM_ALLOC_CHUNK_SIZE);
+    uint64_t start = forthi_now();
+    int new_size = forthi_next_capacity(ctx->return_stack_size);
+    if (new_size == ctx->return_stack_size)
+        return FORTH_FAILURE;
 
-    forth_cell* new_stack = (forth_cell*)malloc(new_size);
+    forth_cell* new_stack = (forth_cell*)forthi_realloc_buffer(ctx, ctx->return_stack, 
+        sizeof(forth_cell) * ctx->return_stack_size, sizeof(forth_cell) * new_size);
     if (!new_stack)
         return FORTH_FAILURE;
 
-    memcpy(new_stack, ctx->return_stack, ctx->return_stack_size * sizeof(forth_cell));
-    free(ctx->return_stack);
     ctx->return_stack = new_stack;
     ctx->return_stack_size = new_size;
+    forthi_count_grow(ctx, start);
+    if (ctx->huge_pages)
+        forthi_advise_huge_pages(ctx->return_stack, sizeof(forth_cell) * new_size);
 
     return FORTH_SUCCESS;
 }
 
 static int forthi_grow_dictionnary(forth_context* ctx)
 {
-    uint8_t* new_name_lens = (uint8_t*)malloc(ctx->dict_size + FORTHI_MEM_ALLOC_CHUNK_SIZE);
+    uint64_t start = forthi_now();
+    int new_size = forthi_next_capacity(ctx->dict_size);
+    if (new_size == ctx->dict_size)
+        return FORTH_FAILURE;
+
+    // Resize all arrays first, the entries are only moved once they all made it
+    int* new_name_offsets = (int*)forthi_realloc_buffer(ctx, ctx->dict_name_offsets, 
+        sizeof(int) * ctx->dict_size, sizeof(int) * new_size);
+    if (!new_name_offsets)
+        return FORTH_FAILURE;
+    ctx->dict_name_offsets = new_name_offsets;
+
+    int* new_name_lens = (int*)forthi_realloc_buffer(ctx, ctx->dict_name_lens, 
+        sizeof(int) * ctx->dict_size, sizeof(int) * new_size);
     if (!new_name_lens)
         return FORTH_FAILURE;
-    memcpy(new_name_lens + FORTHI_MEM_ALLOC_CHUNK_SIZE, ctx->dict_name_lens, ctx->dict_size);
-    free(ctx->dict_name_lens);
     ctx->dict_name_lens = new_name_lens;
 
-    char* new_names = (char*)malloc((ctx->dict_size + FORTHI_MEM_ALLOC_CHUNK_SIZE) * FORTH_DICT_CHAR_COUNT);
+    forth_pointer* new_pointers = (forth_pointer*)forthi_realloc_buffer(ctx, ctx->dict_pointers, 
+        sizeof(forth_pointer) * ctx->dict_size, sizeof(forth_pointer) * new_size);
+    if (!new_pointers)
+        return FORTH_FAILURE;
+    ctx->dict_pointers = new_pointers;
+
+    // Entries are stored at the end of the arrays
+    int from = ctx->dict_size - ctx->dict_pointer;
+    int to = new_size - ctx->dict_pointer;
+    memmove(ctx->dict_name_offsets + to, ctx->dict_name_offsets + from, sizeof(int) * ctx->dict_pointer);
+    memmove(ctx->dict_name_lens + to, ctx->dict_name_lens + from, sizeof(int) * ctx->dict_pointer);
+    memmove(ctx->dict_pointers + to, ctx->dict_pointers + from, sizeof(forth_pointer) * ctx->dict_pointer);
+
+    ctx->dict_size = new_size;
+    forthi_count_grow(ctx, start);
+
+    return FORTH_SUCCESS;
+}
+
+static int forthi_grow_dictionnary_names(forth_context* ctx)
+{
+    uint64_t start = forthi_now();
+    int new_size = forthi_next_capacity(ctx->dict_names_size);
+    if (new_size == ctx->dict_names_size)
+        return FORTH_FAILURE;
+
+    char* new_names = (char*)forthi_realloc_buffer(ctx, ctx->dict_names, ctx->dict_names_size, new_size);
     if (!new_names)
         return FORTH_FAILURE;
-    memcpy(new_names + FORTHI_MEM_ALLOC_CHUNK_SIZE * FORTH_DICT_CHAR_COUNT, 
-        ctx->dict_names, ctx->dict_size * FORTH_DICT_CHAR_COUNT);
-    free(ctx->dict_names);
+
     ctx->dict_names = new_names;
+    ctx->dict_names_size = new_size;
+    forthi_count_grow(ctx, start);
 
-    forth_pointer* new_pointers = 
-        (forth_pointer*)malloc((ctx->dict_size + FORTHI_MEM_ALLOC_CHUNK_SIZE) * sizeof(forth_pointer));
-    if (!new_pointers)
+    return FORTH_SUCCESS;
+}
+
+static int forthi_grow_fn_offsets(forth_context* ctx)
+{
+    uint64_t start = forthi_now();
+    int new_size = forthi_next_capacity(ctx->fn_offsets_size);
+    if (new_size == ctx->fn_offsets_size)
+        return FORTH_FAILURE;
+
+    forth_pointer* new_offsets = (forth_pointer*)forthi_realloc_buffer(ctx, ctx->fn_offsets, 
+        sizeof(forth_pointer) * ctx->fn_offsets_size, sizeof(forth_pointer) * new_size);
+    if (!new_offsets)
         return FORTH_FAILURE;
-    memcpy(new_pointers + FORTHI_MEM_ALLOC_CHUNK_SIZE, ctx->dict_pointers, ctx->dict_size * sizeof(forth_pointer));
-    free(ctx->dict_pointers);
-    ctx->dict_pointers = new_pointers;
 
-    ctx->dict_size += FORTHI_MEM_ALLOC_CHUNK_SIZE;
+    ctx->fn_offsets = new_offsets;
+    ctx->fn_offsets_size = new_size;
+    forthi_count_grow(ctx, start);
 
     return FORTH_SUCCESS;
 }
 
+// Gives the pages past memory_pointer back to the OS. Their content is lost,
+// they come back zeroed when memory_pointer moves over them again.
+static void forthi_release_memory(forth_context* ctx)
+{
+    forthi_release_pages(forthi_memory_at(ctx, ctx->memory_pointer), 
+        ctx->memory + (ctx->memory_size - ctx->shared_memory_size));
+}
+
+// Releases the whole pages between start and end
+static void forthi_release_pages(void* start, void* end)
+{
+#if FORTHI_HAS_MMAN
+    uintptr_t page_size = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t page_start = ((uintptr_t)start + page_size - 1) & ~(page_size - 1);
+    uintptr_t page_end = (uintptr_t)end & ~(page_size - 1);
+
+    if (page_start < page_end)
+        madvise((void*)page_start, page_end - page_start, MADV_DONTNEED);
+#endif
+}
+
+// Advises the huge pages fully inside the buffer. Does nothing where 
+// transparent huge pages aren't supported.
+static void forthi_advise_huge_pages(void* start, size_t size)
+{
+#if FORTHI_HAS_MMAN && defined(MADV_HUGEPAGE)
+    uintptr_t page_start = ((uintptr_t)start + FORTHI_HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(FORTHI_HUGE_PAGE_SIZE - 1);
+    uintptr_t page_end = ((uintptr_t)start + size) & ~(uintptr_t)(FORTHI_HUGE_PAGE_SIZE - 1);
+
+    if (page_start < page_end)
+        madvise((void*)page_start, page_end - page_start, MADV_HUGEPAGE);
+#else
+    (void)start;
+    (void)size;
+#endif
+}
+
+// Reserved memory is committed by whole pages, or whole huge pages so they
+// aren't split by the protection change
+static int forthi_commit_size(forth_context* ctx, int size)
+{
+#if FORTHI_HAS_MMAN
+    int page_size = ctx->huge_pages ? FORTHI_HUGE_PAGE_SIZE : (int)sysconf(_SC_PAGESIZE);
+    if (size > INT_MAX - page_size)
+        return INT_MAX / page_size * page_size;
+    return (size + page_size - 1) / page_size * page_size;
+#else
+    (void)ctx;
+    return size;
+#endif
+}
+
+static uint64_t forthi_now()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void forthi_count_grow(forth_context* ctx, uint64_t start)
+{
+    ctx->grow_count++;
+    ctx->grow_time += forthi_now() - start;
+}
+
+// Stack peaks are caught when popping, this catches what's left on them
+static void forthi_update_high_water(forth_context* ctx)
+{
+    if (ctx->memory_pointer > ctx->memory_high_water)
+        ctx->memory_high_water = ctx->memory_pointer;
+    if (ctx->stack_pointer > ctx->stack_high_water)
+        ctx->stack_high_water = ctx->stack_pointer;
+    if (ctx->return_stack_pointer > ctx->return_stack_high_water)
+        ctx->return_stack_high_water = ctx->return_stack_pointer;
+    if (ctx->dict_pointer > ctx->dict_high_water)
+        ctx->dict_high_water = ctx->dict_pointer;
+}
+
+#if FORTH_GUARDED_STACKS
+typedef struct forthi_guard_state
+{
+    sigjmp_buf jump;
+    forth_context* ctx;
+    const char* message;
+    struct forthi_guard_state* previous;
+} forthi_guard_state;
+
+static thread_local forthi_guard_state* forthi_current_guard = NULL;
+static struct sigaction forthi_previous_sigsegv;
+static size_t forthi_guard_page_size; // sysconf can't be called from the handler
+
+// The stack is placed against the page after it, so the first push past its
+// end faults. There is a guard page before it too.
+static forth_cell* forthi_alloc_guarded_stack(int size)
+{
+    size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    size_t size_in_bytes = sizeof(forth_cell) * size;
+    size_t pages_size = (size_in_bytes + page_size - 1) / page_size * page_size;
+
+    uint8_t* region = (uint8_t*)mmap(NULL, pages_size + 2 * page_size, PROT_READ | PROT_WRITE, 
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if ((void*)region == MAP_FAILED)
+        return NULL;
+
+    if (mprotect(region, page_size, PROT_NONE) != 0 ||
+        mprotect(region + page_size + pages_size, page_size, PROT_NONE) != 0)
+    {
+        munmap(region, pages_size + 2 * page_size);
+        return NULL;
+    }
+
+    return (forth_cell*)(region + page_size + pages_size - size_in_bytes);
+}
+
+static void forthi_free_guarded_stack(forth_cell* stack, int size)
+{
+    size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    size_t size_in_bytes = sizeof(forth_cell) * size;
+    size_t pages_size = (size_in_bytes + page_size - 1) / page_size * page_size;
+    uint8_t* region = (uint8_t*)stack + size_in_bytes - pages_size - page_size;
+
+    munmap(region, pages_size + 2 * page_size);
+}
+
+static int forthi_is_in_guard_page(const forth_cell* stack, int size, const uint8_t* address)
+{
+    size_t page_size = forthi_guard_page_size;
+    const uint8_t* end = (const uint8_t*)(stack + size);
+    const uint8_t* start = (const uint8_t*)((uintptr_t)stack & ~(uintptr_t)(page_size - 1));
+
+    return (address >= end && address < end + page_size) ||
+           (address >= start - page_size && address < start);
+}
+
+static void forthi_guard_handler(int sig, siginfo_t* info, void* ucontext)
+{
+    forthi_guard_state* guard = forthi_current_guard;
+    if (guard)
+    {
+        forth_context* ctx = guard->ctx;
+        const uint8_t* address = (const uint8_t*)info->si_addr;
+
+        if (forthi_is_in_guard_page(ctx->stack, ctx->stack_size, address))
+            guard->message = address < (const uint8_t*)ctx->stack ? "Stack underflow\n" : "Stack overflow\n";
+        else if (forthi_is_in_guard_page(ctx->return_stack, ctx->return_stack_size, address))
+            guard->message = address < (const uint8_t*)ctx->return_stack ? 
+                "Return stack underflow\n" : "Return stack overflow\n";
+
+        if (guard->message)
+            siglongjmp(guard->jump, 1);
+    }
+
+    // Not ours, the previous handler gets it and we stay installed
+    const struct sigaction* previous = &forthi_previous_sigsegv;
+    if (previous->sa_flags & SA_SIGINFO)
+    {
+        previous->sa_sigaction(sig, info, ucontext);
+        return;
+    }
+
+    if (previous->sa_handler != SIG_DFL && previous->sa_handler != SIG_IGN)
+    {
+        previous->sa_handler(sig);
+        return;
+    }
+
+    // A fault can't be ignored, it would happen again forever
+    signal(SIGSEGV, SIG_DFL);
+    raise(SIGSEGV);
+}
+
+static int forthi_setup_guard_handler()
+{
+    forthi_guard_page_size = (size_t)sysconf(_SC_PAGESIZE);
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(struct sigaction));
+    action.sa_sigaction = forthi_guard_handler;
+    action.sa_flags = SA_SIGINFO;
+    sigemptyset(&action.sa_mask);
+    return sigaction(SIGSEGV, &action, &forthi_previous_sigsegv);
+}
+
+// Called when creating contexts. Installed once, handlers installed after
+// it are expected to chain to it, so the previous one is never replaced.
+static void forthi_install_guard_handler()
+{
+    static const int installed = forthi_setup_guard_handler();
+    (void)installed;
+}
+#endif
+
 static int forthi_reserve_memory_space(forth_context* ctx, int size)
 {
     int space_left = (int)ctx->memory_size - (int)ctx->memory_pointer;
@@ -441,11 +1280,33 @@ static int forthi_reserve_aligned_memory_space(forth_context* ctx, forth_pointer
 
 static int forthi_check_valid_memory_range(forth_context* ctx, forth_pointer at, forth_pointer size)
 {
+    if (at >= FORTHI_HEAP_BASE)
+    {
+        forth_pointer end = at >= FORTHI_TRANSIENT_BASE ? 
+            FORTHI_TRANSIENT_BASE + (forth_pointer)ctx->transient_pointer :
+            FORTHI_HEAP_BASE + (forth_pointer)ctx->heap.pointer;
+        if (at + size > end)
+        {
+            FORTH_LOG(ctx, "Invalid memory address\n");
+            return FORTH_FAILURE;
+        }
+        return FORTH_SUCCESS;
+    }
+
     if (at + size > ctx->memory_pointer)
     {
         FORTH_LOG(ctx, "Invalid memory address\n");
         return FORTH_FAILURE;
     }
+
+    // A range can't span both the shared and the own memory, they are not
+    // contiguous
+    if (at < ctx->shared_memory_size && at + size > ctx->shared_memory_size)
+    {
+        FORTH_LOG(ctx, "Invalid memory address\n");
+        return FORTH_FAILURE;
+    }
+
     return FORTH_SUCCESS;
 }
 
@@ -472,7 +1333,7 @@ static int forthi_write_byte(forth_context* ctx, uint8_t data)
     if (forthi_reserve_memory_space(ctx, 1) == FORTH_FAILURE)
         return FORTH_FAILURE;
 
-    ctx->memory[ctx->memory_pointer++] = data;
+    *forthi_memory_at(ctx, ctx->memory_pointer++) = data;
 
     return FORTH_SUCCESS;
 }
@@ -482,7 +1343,7 @@ static int forthi_write_number(forth_context* ctx, forth_int data)
     if (forthi_reserve_memory_space(ctx, sizeof(forth_int)) == FORTH_FAILURE)
         return FORTH_FAILURE;
 
-    *(forth_int*)&ctx->memory[ctx->memory_pointer] = data;
+    *(forth_int*)forthi_memory_at(ctx, ctx->memory_pointer) = data;
     ctx->memory_pointer += (int)sizeof(forth_int);
 
     return FORTH_SUCCESS;
@@ -493,7 +1354,13 @@ static int forthi_write_number_at(forth_context* ctx, forth_int data, forth_poin
     if (forthi_check_valid_memory_range(ctx, at, (forth_pointer)sizeof(forth_int)) == FORTH_FAILURE)
         return FORTH_FAILURE;
 
-    *(forth_int*)&ctx->memory[at] = data;
+    if (at < ctx->shared_memory_size)
+    {
+        FORTH_LOG(ctx, "Read-only memory address\n");
+        return FORTH_FAILURE;
+    }
+
+    *(forth_int*)forthi_memory_at(ctx, at) = data;
 
     return FORTH_SUCCESS;
 }
@@ -503,23 +1370,62 @@ static int forthi_write_pointer(forth_context* ctx, forth_pointer data)
     if (forthi_reserve_memory_space(ctx, sizeof(forth_pointer)) == FORTH_FAILURE)
         return FORTH_FAILURE;
 
-    *(forth_pointer*)&ctx->memory[ctx->memory_pointer] = data;
+    *(forth_pointer*)forthi_memory_at(ctx, ctx->memory_pointer) = data;
     ctx->memory_pointer += (forth_pointer)sizeof(forth_pointer);
 
     return FORTH_SUCCESS;
 }
 
-static int forthi_write_function(forth_context* ctx, forth_c_func fn)
+static uintptr_t forthi_function_key(forth_c_func fn)
 {
-    if (forthi_reserve_memory_space(ctx, sizeof(fn)) == FORTH_FAILURE)
-        return FORTH_FAILURE;
-
-    memcpy(ctx->memory + ctx->memory_pointer, &fn, sizeof(forth_c_func));
-    ctx->memory_pointer += (forth_pointer)sizeof(forth_c_func);
-    //*(forth_c_func*)&ctx->memory[ctx->memory_pointer] = fn;
-    //ctx->memory_pointer += (int)sizeof(forth_c_func);
-
-    return FORTH_SUCCESS;
+    uintptr_t key;
+    memcpy(&key, &fn, sizeof(forth_c_func));
+    return key;
+}
+
+// C functions are written relative to one of ours. The same program then
+// writes the same bytes wherever it's loaded, and mapped images don't need 
+// to be relocated.
+static uintptr_t forthi_encode_function(forth_c_func fn)
+{
+    return forthi_function_key(fn) - forthi_function_key(forthi_word_store);
+}
+
+static void forthi_store_function(uint8_t* at, forth_c_func fn)
+{
+    uintptr_t value = forthi_encode_function(fn);
+    memcpy(at, &value, sizeof(uintptr_t));
+}
+
+static forth_c_func forthi_function_at(const uint8_t* at)
+{
+    uintptr_t key;
+    memcpy(&key, at, sizeof(uintptr_t));
+    key += forthi_function_key(forthi_word_store);
+
+    forth_c_func fn;
+    memcpy(&fn, &key, sizeof(forth_c_func));
+    return fn;
+}
+
+static int forthi_write_function(forth_context* ctx, forth_c_func fn)
+{
+    if (forthi_reserve_memory_space(ctx, sizeof(fn)) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    if (ctx->fn_offsets_pointer == ctx->fn_offsets_size && forthi_grow_fn_offsets(ctx) == FORTH_FAILURE)
+    {
+        FORTH_LOG(ctx, "Out of memory\n");
+        return FORTH_FAILURE;
+    }
+    ctx->fn_offsets[ctx->fn_offsets_pointer++] = ctx->memory_pointer;
+
+    forthi_store_function(forthi_memory_at(ctx, ctx->memory_pointer), fn);
+    ctx->memory_pointer += (forth_pointer)sizeof(forth_c_func);
+    //*(forth_c_func*)&ctx->memory[ctx->memory_pointer] = fn;
+    //ctx->memory_pointer += (int)sizeof(forth_c_func);
+
+    return FORTH_SUCCESS;
 }
 
 static int forthi_write_text(forth_context* ctx, const char* text, size_t len)
@@ -530,7 +1436,7 @@ static int forthi_write_text(forth_context* ctx, const char* text, size_t len)
     if (forthi_reserve_memory_space(ctx, (int)len) == FORTH_FAILURE)
         return FORTH_FAILURE;
 
-    memcpy(ctx->memory + ctx->memory_pointer, text, len);
+    memcpy(forthi_memory_at(ctx, ctx->memory_pointer), text, len);
     ctx->memory_pointer += (forth_pointer)len;
 
     return FORTH_SUCCESS;
@@ -541,7 +1447,7 @@ static int forthi_read_byte(forth_context* ctx, uint8_t* data)
     if (forthi_check_valid_memory_range(ctx, ctx->program_pointer) == FORTH_FAILURE)
         return FORTH_FAILURE;
 
-    *data = ctx->memory[ctx->program_pointer++];
+    *data = *forthi_memory_at(ctx, ctx->program_pointer++);
     return FORTH_SUCCESS;
 }
 
@@ -550,7 +1456,7 @@ static int forthi_read_function(forth_context* ctx, forth_c_func* data)
     if (forthi_check_valid_memory_range(ctx, ctx->program_pointer, sizeof(forth_c_func)) == FORTH_FAILURE)
         return FORTH_FAILURE;
 
-    memcpy(data, ctx->memory + ctx->program_pointer, sizeof(forth_c_func));
+    *data = forthi_function_at(forthi_memory_at(ctx, ctx->program_pointer));
     ctx->program_pointer += (forth_pointer)sizeof(forth_c_func);
     //*data = *(forth_c_func*)&ctx->memory[ctx->program_pointer];
     //ctx->program_pointer += sizeof(forth_c_func);
@@ -563,7 +1469,7 @@ static int forthi_read_number(forth_context* ctx, forth_int* data)
     if (forthi_check_valid_memory_range(ctx, ctx->program_pointer, sizeof(forth_int)) == FORTH_FAILURE)
         return FORTH_FAILURE;
 
-    *data = *(forth_int*)&ctx->memory[ctx->program_pointer];
+    *data = *(forth_int*)forthi_memory_at(ctx, ctx->program_pointer);
     ctx->program_pointer += sizeof(forth_int);
 
     return FORTH_SUCCESS;
@@ -574,7 +1480,7 @@ static int forthi_read_number_at(forth_context* ctx, forth_int* data, forth_poin
     if (forthi_check_valid_memory_range(ctx, at, sizeof(forth_int)) == FORTH_FAILURE)
         return FORTH_FAILURE;
 
-    *data = *(forth_int*)&ctx->memory[at];
+    *data = *(forth_int*)forthi_memory_at(ctx, at);
 
     return FORTH_SUCCESS;
 }
@@ -584,7 +1490,7 @@ static int forthi_read_pointer(forth_context* ctx, forth_pointer* data)
     if (forthi_check_valid_memory_range(ctx, ctx->program_pointer, sizeof(forth_pointer)) == FORTH_FAILURE)
         return FORTH_FAILURE;
 
-    *data = *(forth_pointer*)&ctx->memory[ctx->program_pointer];
+    *data = *(forth_pointer*)forthi_memory_at(ctx, ctx->program_pointer);
     ctx->program_pointer += (forth_pointer)sizeof(forth_pointer);
 
     return FORTH_SUCCESS;
@@ -600,18 +1506,341 @@ static const char* forthi_read_text(forth_context* ctx, forth_int* len)
     if (forthi_check_valid_memory_range(ctx, ctx->program_pointer, (forth_pointer)*len) == FORTH_FAILURE)
         return FORTH_FAILURE;
 
-    text = (const char*)&ctx->memory[ctx->program_pointer];
+    text = (const char*)forthi_memory_at(ctx, ctx->program_pointer);
     ctx->program_pointer += (forth_pointer)*len;
 
     return text;
 }
 
+//---------------------------------------------------------------------------
+// HEAP
+//---------------------------------------------------------------------------
+
+// Each block starts with this header. Free blocks keep the offset of the next
+// free block of their list right after it.
+typedef struct forthi_heap_block
+{
+    uint32_t capacity;  // Block size, header included
+    uint32_t size;      // Requested size, FORTHI_HEAP_FREE_BLOCK once freed
+} forthi_heap_block;
+
+// Bytes of the block_starts bitmap for a heap of that size
+static int forthi_heap_block_starts_size(int size)
+{
+    int granules = size / (int)sizeof(forthi_heap_block);
+    return (granules + 7) / 8;
+}
+
+static void forthi_init_heap(forth_heap* heap)
+{
+    memset(heap, 0, sizeof(forth_heap));
+    for (int i = 0; i <= FORTH_HEAP_SIZE_CLASSES; i++)
+        heap->free_lists[i] = -1;
+}
+
+// Returns the size class of a block, FORTH_HEAP_SIZE_CLASSES for large blocks
+static int forthi_heap_size_class(forth_pointer block_size)
+{
+    int size_class = 0;
+    while (size_class < FORTH_HEAP_SIZE_CLASSES && 
+           ((forth_pointer)FORTHI_HEAP_MIN_BLOCK_SIZE << size_class) < block_size)
+        size_class++;
+    return size_class;
+}
+
+static forthi_heap_block* forthi_heap_block_at(forth_context* ctx, int offset)
+{
+    return (forthi_heap_block*)(ctx->heap.memory + offset);
+}
+
+static int* forthi_heap_next_free(forth_context* ctx, int offset)
+{
+    return (int*)(ctx->heap.memory + offset + sizeof(forthi_heap_block));
+}
+
+// Makes room for bytes more past the heap pointer
+static int forthi_grow_heap(forth_context* ctx, int bytes)
+{
+    forth_heap* heap = &ctx->heap;
+    if (bytes > INT_MAX - heap->pointer)
+        return FORTH_FAILURE;
+
+    while (heap->pointer + bytes > heap->size)
+    {
+        uint64_t start = forthi_now();
+        int new_size = forthi_next_capacity(heap->size);
+        if (new_size == heap->size)
+            return FORTH_FAILURE;
+
+        uint8_t* new_memory = (uint8_t*)forthi_realloc_buffer(ctx, heap->memory, heap->pointer, new_size);
+        if (!new_memory)
+            return FORTH_FAILURE;
+        heap->memory = new_memory;
+
+        int starts_size = forthi_heap_block_starts_size(heap->size);
+        int new_starts_size = forthi_heap_block_starts_size(new_size);
+        uint8_t* new_starts = (uint8_t*)forthi_realloc_buffer(ctx, heap->block_starts, starts_size, 
+            new_starts_size);
+        if (!new_starts)
+            return FORTH_FAILURE;
+        memset(new_starts + starts_size, 0, (size_t)(new_starts_size - starts_size));
+        heap->block_starts = new_starts;
+
+        heap->size = new_size;
+        forthi_count_grow(ctx, start);
+    }
+
+    return FORTH_SUCCESS;
+}
+
+static int forthi_heap_alloc(forth_context* ctx, forth_pointer size, forth_pointer* at)
+{
+    forth_heap* heap = &ctx->heap;
+    if (size > (forth_pointer)INT_MAX - FORTHI_HEAP_LARGE_BLOCK_SIZE)
+        return FORTH_FAILURE;
+
+    // Free blocks need room for the next offset
+    forth_pointer block_size = sizeof(forthi_heap_block) + (size < sizeof(int) ? sizeof(int) : size);
+    int size_class = forthi_heap_size_class(block_size);
+    if (size_class < FORTH_HEAP_SIZE_CLASSES)
+        block_size = (forth_pointer)FORTHI_HEAP_MIN_BLOCK_SIZE << size_class;
+    else
+        block_size = (block_size + FORTHI_HEAP_LARGE_BLOCK_SIZE - 1) / FORTHI_HEAP_LARGE_BLOCK_SIZE * 
+            FORTHI_HEAP_LARGE_BLOCK_SIZE;
+
+    // Reuse a free block. Large blocks are first fit.
+    int offset = -1;
+    int* link = &heap->free_lists[size_class];
+    while (*link != -1)
+    {
+        if (forthi_heap_block_at(ctx, *link)->capacity >= block_size)
+        {
+            offset = *link;
+            *link = *forthi_heap_next_free(ctx, offset);
+            block_size = forthi_heap_block_at(ctx, offset)->capacity;
+            break;
+        }
+        link = forthi_heap_next_free(ctx, *link);
+    }
+
+    // Or carve a new one
+    if (offset == -1)
+    {
+        if (block_size > (forth_pointer)(INT_MAX - heap->pointer))
+            return FORTH_FAILURE;
+
+        if (forthi_grow_heap(ctx, (int)block_size) == FORTH_FAILURE)
+            return FORTH_FAILURE;
+
+        offset = heap->pointer;
+        heap->pointer += (int)block_size;
+        forthi_heap_block_at(ctx, offset)->capacity = (uint32_t)block_size;
+
+        int granule = offset / (int)sizeof(forthi_heap_block);
+        heap->block_starts[granule / 8] |= (uint8_t)(1 << (granule % 8));
+    }
+
+    forthi_heap_block_at(ctx, offset)->size = (uint32_t)size;
+    heap->used += (int)size;
+    heap->allocated += (int)block_size;
+    heap->block_count++;
+
+    *at = FORTHI_HEAP_BASE + offset + sizeof(forthi_heap_block);
+    return FORTH_SUCCESS;
+}
+
+// Returns the block offset of a heap address, or -1 if it's not a live block
+static int forthi_heap_block_offset(forth_context* ctx, forth_pointer at)
+{
+    if (at < FORTHI_HEAP_BASE + sizeof(forthi_heap_block) || 
+        at >= FORTHI_HEAP_BASE + (forth_pointer)ctx->heap.pointer ||
+        (at - FORTHI_HEAP_BASE) % sizeof(forthi_heap_block) != 0)
+        return -1;
+
+    // Addresses inside a block's data would read it as a header
+    int offset = (int)(at - FORTHI_HEAP_BASE - sizeof(forthi_heap_block));
+    int granule = offset / (int)sizeof(forthi_heap_block);
+    if (!(ctx->heap.block_starts[granule / 8] & (1 << (granule % 8))))
+        return -1;
+
+    if (forthi_heap_block_at(ctx, offset)->size == FORTHI_HEAP_FREE_BLOCK)
+        return -1;
+
+    return offset;
+}
+
+static int forthi_heap_free(forth_context* ctx, forth_pointer at)
+{
+    forth_heap* heap = &ctx->heap;
+    int offset = forthi_heap_block_offset(ctx, at);
+    if (offset == -1)
+        return FORTH_FAILURE;
+
+    forthi_heap_block* block = forthi_heap_block_at(ctx, offset);
+    int size_class = forthi_heap_size_class(block->capacity);
+
+    heap->used -= (int)block->size;
+    heap->allocated -= (int)block->capacity;
+    heap->block_count--;
+
+    block->size = FORTHI_HEAP_FREE_BLOCK;
+    *forthi_heap_next_free(ctx, offset) = heap->free_lists[size_class];
+    heap->free_lists[size_class] = offset;
+
+    return FORTH_SUCCESS;
+}
+
+static int forthi_heap_resize(forth_context* ctx, forth_pointer at, forth_pointer size, forth_pointer* new_at)
+{
+    int offset = forthi_heap_block_offset(ctx, at);
+    if (offset == -1)
+        return FORTH_FAILURE;
+
+    // Grow or shrink in place when the block has room for it. Written so
+    // huge sizes can't wrap around.
+    forthi_heap_block* block = forthi_heap_block_at(ctx, offset);
+    if (size <= block->capacity - sizeof(forthi_heap_block))
+    {
+        ctx->heap.used += (int)size - (int)block->size;
+        block->size = (uint32_t)size;
+        *new_at = at;
+        return FORTH_SUCCESS;
+    }
+
+    forth_pointer old_size = block->size;
+    if (forthi_heap_alloc(ctx, size, new_at) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    // The heap may have moved
+    memcpy(forthi_memory_at(ctx, *new_at), forthi_memory_at(ctx, at), old_size);
+    return forthi_heap_free(ctx, at);
+}
+
+void forth_get_heap_stats(const forth_context* ctx, forth_heap_stats* stats)
+{
+    if (!ctx || !stats)
+        return;
+
+    stats->capacity = (size_t)ctx->heap.size;
+    stats->extent = (size_t)ctx->heap.pointer;
+    stats->allocated = (size_t)ctx->heap.allocated;
+    stats->used = (size_t)ctx->heap.used;
+    stats->free = stats->extent - stats->allocated;
+    stats->block_count = ctx->heap.block_count;
+    stats->fragmentation = stats->extent ? (double)(stats->extent - stats->used) / (double)stats->extent : 0.0;
+}
+
+void forth_get_stats(const forth_context* ctx, forth_stats* stats)
+{
+    if (!ctx || !stats)
+        return;
+
+    stats->memory_used = (size_t)(ctx->memory_pointer - ctx->shared_memory_size);
+    stats->memory_size = (size_t)ctx->memory_size - (size_t)ctx->shared_memory_size;
+    stats->memory_reserved = ctx->memory_reserved_size ? (size_t)ctx->memory_reserved_size : stats->memory_size;
+
+    // Words are laid out in definition order. What's before the first one
+    // only holds data, like BASE.
+    stats->code_bytes = ctx->dict_pointer ? 
+        (size_t)(ctx->memory_pointer - ctx->dict_pointers[ctx->dict_size - 1]) : 0;
+    stats->data_bytes = stats->memory_used - stats->code_bytes;
+
+    stats->dict_entries = ctx->dict_pointer;
+    stats->dict_capacity = ctx->dict_size;
+    stats->stack_depth = ctx->stack_pointer;
+    stats->stack_capacity = ctx->stack_size;
+    stats->return_stack_depth = ctx->return_stack_pointer;
+    stats->return_stack_capacity = ctx->return_stack_size;
+
+    // The current usage may not have been caught yet
+    stats->memory_high_water = (size_t)((ctx->memory_high_water > ctx->memory_pointer ? 
+        ctx->memory_high_water : ctx->memory_pointer) - ctx->shared_memory_size);
+    stats->dict_high_water = ctx->dict_high_water > ctx->dict_pointer ? ctx->dict_high_water : ctx->dict_pointer;
+    stats->stack_high_water = ctx->stack_high_water > ctx->stack_pointer ? 
+        ctx->stack_high_water : ctx->stack_pointer;
+    stats->return_stack_high_water = ctx->return_stack_high_water > ctx->return_stack_pointer ? 
+        ctx->return_stack_high_water : ctx->return_stack_pointer;
+
+    stats->grow_count = ctx->grow_count;
+    stats->grow_time = (double)ctx->grow_time / 1e9;
+    stats->include_cache_hits = ctx->include_cache_hits;
+    stats->dict_cache_hits = ctx->dict_cache_hits;
+}
+
+//---------------------------------------------------------------------------
+// TRANSIENT REGION
+//---------------------------------------------------------------------------
+
+static void forthi_reset_transient(forth_context* ctx)
+{
+    ctx->transient_pointer = 0;
+    ctx->pad = 0;
+    ctx->hold_start = 0;
+    ctx->hold_pointer = 0;
+    ctx->input.to_in = 0;
+    ctx->input.source_copy = 0;
+}
+
+// Makes room for bytes more past the transient pointer. Addresses are
+// offsets, they survive the region moving
+static int forthi_grow_transient(forth_context* ctx, int bytes)
+{
+    while (ctx->transient_pointer + bytes > ctx->transient_size)
+    {
+        uint64_t start = forthi_now();
+        int new_size = forthi_next_capacity(ctx->transient_size);
+        if (new_size == ctx->transient_size)
+            return FORTH_FAILURE;
+
+        uint8_t* new_transient = (uint8_t*)forthi_realloc_buffer(ctx, ctx->transient, 
+            ctx->transient_pointer, new_size);
+        if (!new_transient)
+            return FORTH_FAILURE;
+
+        ctx->transient = new_transient;
+        ctx->transient_size = new_size;
+        forthi_count_grow(ctx, start);
+    }
+
+    return FORTH_SUCCESS;
+}
+
+static int forthi_transient_alloc(forth_context* ctx, forth_pointer size, forth_pointer* at)
+{
+    if (size > (forth_pointer)(INT_MAX - ctx->transient_pointer))
+    {
+        FORTH_LOG(ctx, "Out of memory\n");
+        return FORTH_FAILURE;
+    }
+
+    if (forthi_grow_transient(ctx, (int)size) == FORTH_FAILURE)
+    {
+        FORTH_LOG(ctx, "Out of memory\n");
+        return FORTH_FAILURE;
+    }
+
+    *at = FORTHI_TRANSIENT_BASE + (forth_pointer)ctx->transient_pointer;
+    ctx->transient_pointer += (int)size;
+
+    return FORTH_SUCCESS;
+}
+
+static int forthi_transient_copy(forth_context* ctx, const char* text, size_t len, forth_pointer* at)
+{
+    if (forthi_transient_alloc(ctx, (forth_pointer)len, at) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    memcpy(forthi_memory_at(ctx, *at), text, len);
+    return FORTH_SUCCESS;
+}
+
 //---------------------------------------------------------------------------
 // STACK
 //---------------------------------------------------------------------------
 
 static int forthi_push_cell(forth_context* ctx, forth_cell cell)
 {
+#if !FORTH_GUARDED_STACKS
     if (ctx->stack_pointer >= ctx->stack_size)
     {
         if (!ctx->stack_auto_resize)
@@ -626,6 +1855,7 @@ static int forthi_push_cell(forth_context* ctx, forth_cell cell)
             return FORTH_FAILURE;
         }
     }
+#endif
 
     ctx->stack[ctx->stack_pointer++] = cell;
     return FORTH_SUCCESS;
@@ -693,6 +1923,10 @@ static int forthi_pop(forth_context* ctx, int count)
         return FORTH_FAILURE;
     }
 
+    // Tracked here rather than in the push hot path
+    if (ctx->stack_pointer > ctx->stack_high_water)
+        ctx->stack_high_water = ctx->stack_pointer;
+
     ctx->stack_pointer -= count;
     return FORTH_SUCCESS;
 }
@@ -714,6 +1948,7 @@ forth_cell* forth_get_top(forth_context* ctx, int offset)
 
 static int forthi_push_return_cell(forth_context* ctx, forth_cell cell)
 {
+#if !FORTH_GUARDED_STACKS
     if (ctx->return_stack_pointer >= ctx->return_stack_size)
     {
         if (!ctx->return_stack_auto_resize)
@@ -728,6 +1963,7 @@ static int forthi_push_return_cell(forth_context* ctx, forth_cell cell)
             return FORTH_FAILURE;
         }
     }
+#endif
 
     ctx->return_stack[ctx->return_stack_pointer++] = cell;
     return FORTH_SUCCESS;
@@ -755,6 +1991,9 @@ static int forthi_pop_return(forth_context* ctx, int count)
         return FORTH_FAILURE;
     }
 
+    if (ctx->return_stack_pointer > ctx->return_stack_high_water)
+        ctx->return_stack_high_water = ctx->return_stack_pointer;
+
     ctx->return_stack_pointer -= count;
     return FORTH_SUCCESS;
 }
@@ -793,6 +2032,7 @@ static int forthi_compile_function_call(forth_context* ctx, forth_c_func fn)
     // Call them at compile time
     if (fn == forthi_word_abort_quote ||
         fn == forthi_word_dot_quote ||
+        fn == forthi_word_s_quote ||
         fn == forthi_word_semicolon ||
         fn == forthi_word_IF ||
         fn == forthi_word_ELSE ||
@@ -848,19 +2088,71 @@ static int forthi_add_word(forth_context* ctx, const char* name, int name_len, f
         }
     }
 
+    while (name_len > ctx->dict_names_size - ctx->dict_names_pointer)
+    {
+        if (forthi_grow_dictionnary_names(ctx) == FORTH_FAILURE)
+        {
+            FORTH_LOG(ctx, "Out of memory\n");
+            return FORTH_FAILURE;
+        }
+    }
+
     int index = ctx->dict_size - ctx->dict_pointer - 1;
+    ctx->dict_name_offsets[index] = ctx->dict_names_pointer;
     ctx->dict_name_lens[index] = name_len;
     ctx->dict_pointers[index] = memory_offset;
-    int name_copy_len = name_len > FORTH_DICT_CHAR_COUNT ? FORTH_DICT_CHAR_COUNT : name_len;
-    memcpy(ctx->dict_names + index * FORTH_DICT_CHAR_COUNT, name, name_copy_len);
+    memcpy(ctx->dict_names + ctx->dict_names_pointer, name, name_len);
 
+    ctx->dict_names_pointer += name_len;
     ctx->dict_pointer++;
 
+#if FORTH_DICT_CACHE_SIZE > 0
+    // The new word shadows whatever was cached under its name
+    uint32_t hash = forthi_hash_name(name, name_len);
+    ctx->dict_cache[hash & (FORTH_DICT_CACHE_SIZE - 1)].owner = NULL;
+#endif
+
     return FORTH_SUCCESS;
 }
 
+static void forthi_truncate_dictionnary(forth_context* ctx, int dict_pointer)
+{
+    ctx->dict_pointer = dict_pointer;
+
+    // Names are appended in definition order, so the arena ends right after
+    // the name of the most recent entry left
+    if (dict_pointer > 0)
+    {
+        int index = ctx->dict_size - dict_pointer;
+        ctx->dict_names_pointer = ctx->dict_name_offsets[index] + ctx->dict_name_lens[index];
+    }
+    else
+    {
+        ctx->dict_names_pointer = 0;
+    }
+}
+
+// Drops the words defined after dict_pointer and the memory they used
+static void forthi_rewind(forth_context* ctx, int dict_pointer, forth_pointer memory_pointer)
+{
+    forthi_update_high_water(ctx);
+    forthi_truncate_dictionnary(ctx, dict_pointer);
+    forthi_clear_dict_cache(ctx);
+    ctx->memory_pointer = memory_pointer;
+    forthi_release_memory(ctx);
+
+    while (ctx->fn_offsets_pointer > 0 && ctx->fn_offsets[ctx->fn_offsets_pointer - 1] >= memory_pointer)
+        ctx->fn_offsets_pointer--;
+}
+
 int forth_add_c_word(forth_context* ctx, const char* name, forth_c_func fn)
 {
+    if (ctx->frozen)
+    {
+        FORTH_LOG(ctx, "Context is frozen\n");
+        return FORTH_FAILURE;
+    }
+
     forth_pointer memory_pointer = ctx->memory_pointer;
 
     if (forthi_write_byte(ctx, FORTHI_INST_CALL_C_FUNCTION) == FORTH_FAILURE)
@@ -872,42 +2164,98 @@ int forth_add_c_word(forth_context* ctx, const char* name, forth_c_func fn)
     return forthi_add_word(ctx, name, (int)strlen(name), memory_pointer);
 }
 
-static forth_pointer forthi_get_word(forth_context* ctx, const char* name, size_t name_len)
+static uint32_t forthi_hash_name(const char* name, size_t name_len)
 {
-    int index = ctx->dict_size - ctx->dict_pointer;
-    if (ctx->state == FORTHI_STATE_COMPILE)
-        index++; // Skip word being compiled
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < name_len; i++)
+    {
+        hash ^= (uint8_t)name[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void forthi_clear_dict_cache(forth_context* ctx)
+{
+#if FORTH_DICT_CACHE_SIZE > 0
+    memset(ctx->dict_cache, 0, sizeof(ctx->dict_cache));
+#endif
+}
+
+static int forthi_is_word_named(const forth_context* ctx, int index, const char* name, size_t name_len)
+{
+    return ctx->dict_name_lens[index] == (int)name_len &&
+        memcmp(ctx->dict_names + ctx->dict_name_offsets[index], name, name_len) == 0;
+}
 
-    size_t compare_len = name_len > FORTH_DICT_CHAR_COUNT ? FORTH_DICT_CHAR_COUNT : name_len;
+static int forthi_find_word_index(const forth_context* ctx, int index, const char* name, size_t name_len)
+{
     while (index < ctx->dict_size)
     {
-        if (ctx->dict_name_lens[index] == name_len)
-            if (strncmp(ctx->dict_names + index * FORTH_DICT_CHAR_COUNT, name, compare_len) == 0)
-                return ctx->dict_pointers[index];
+        if (forthi_is_word_named(ctx, index, name, name_len))
+            return index;
 
         index++;
     }
 
-    return (forth_pointer)-1;
+    return index;
 }
 
-static int forthi_get_word_index(forth_context* ctx, const char* name, size_t name_len)
+static forth_pointer forthi_get_word(forth_context* ctx, const char* name, size_t name_len)
 {
-    int index = ctx->dict_size - ctx->dict_pointer;
-    if (ctx->state == FORTHI_STATE_COMPILE)
-        index++; // Skip word being compiled
+#if FORTH_DICT_CACHE_SIZE > 0
+    uint32_t hash = forthi_hash_name(name, name_len);
+    forth_dict_cache_entry* entry = &ctx->dict_cache[hash & (FORTH_DICT_CACHE_SIZE - 1)];
+    if (entry->owner && entry->hash == hash && entry->position < entry->owner->dict_pointer)
+    {
+        int index = entry->owner->dict_size - entry->position - 1;
+        if (forthi_is_word_named(entry->owner, index, name, name_len))
+        {
+            ctx->dict_cache_hits++;
+            return entry->owner->dict_pointers[index];
+        }
+    }
+#endif
 
-    size_t compare_len = name_len > FORTH_DICT_CHAR_COUNT ? FORTH_DICT_CHAR_COUNT : name_len;
-    while (index < ctx->dict_size)
+    const forth_context* owner = ctx;
+    int index = forthi_get_word_index(ctx, name, name_len);
+    if (index == ctx->dict_size)
     {
-        if (ctx->dict_name_lens[index] == name_len)
-            if (strncmp(ctx->dict_names + index * FORTH_DICT_CHAR_COUNT, name, compare_len) == 0)
-                return index;
+        // Fallback to the words shared by the base contexts
+        for (owner = ctx->parent; owner; owner = owner->parent)
+        {
+            index = forthi_find_word_index(owner, owner->dict_size - owner->dict_pointer, name, name_len);
+            if (index < owner->dict_size)
+                break;
+        }
 
-        index++;
+        if (!owner)
+            return (forth_pointer)-1;
     }
 
-    return index;
+#if FORTH_DICT_CACHE_SIZE > 0
+    // While compiling, the word found might be shadowed once the current 
+    // definition is done
+    if (ctx->state != FORTHI_STATE_COMPILE || 
+        !forthi_is_word_named(ctx, ctx->dict_size - ctx->dict_pointer, name, name_len))
+    {
+        entry->hash = hash;
+        entry->position = owner->dict_size - index - 1;
+        entry->owner = owner;
+    }
+#endif
+
+    return owner->dict_pointers[index];
+}
+
+static int forthi_get_word_index(forth_context* ctx, const char* name, size_t name_len)
+{
+    int index = ctx->dict_size - ctx->dict_pointer;
+    if (ctx->state == FORTHI_STATE_COMPILE)
+        index++; // Skip word being compiled
+
+    return forthi_find_word_index(ctx, index, name, name_len);
 }
 
 //---------------------------------------------------------------------------
@@ -919,60 +2267,133 @@ static int forthi_is_space(char c)
     return !c || c == ' ' || c == '\t' || c == '\n' || c == '\r';
 }
 
-static const char* forthi_trim_code(forth_context* ctx)
+#if FORTHI_HAS_SSE2
+// One bit per space character in the block at code
+static int forthi_space_mask(const char* code)
 {
-    while (*ctx->code && forthi_is_space(*ctx->code))
-        ctx->code++;
+    __m128i block = _mm_loadu_si128((const __m128i*)code);
+    __m128i spaces = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(block, _mm_setzero_si128()), _mm_cmpeq_epi8(block, _mm_set1_epi8(' '))),
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8('\t')), _mm_cmpeq_epi8(block, _mm_set1_epi8('\n'))),
+                     _mm_cmpeq_epi8(block, _mm_set1_epi8('\r'))));
+    return _mm_movemask_epi8(spaces);
+}
 
-    return ctx->code;
+static int forthi_lowest_bit(int mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, (unsigned long)mask);
+    return (int)index;
+#else
+    return __builtin_ctz((unsigned)mask);
+#endif
 }
+#endif
 
-static const char* forthi_read_until(forth_context* ctx, char delim)
+// Runs are scanned byte by byte first, most of them end there. Long ones,
+// like indentation or long names, continue a block at a time. Blocks never
+// read past code_end.
+static const char* forthi_skip_spaces(const char* code, const char* code_end)
 {
-    while (*ctx->code && *ctx->code != delim)
-        ctx->code++;
-    if (!*ctx->code)
-        return ctx->code;
+    const char* scalar_end = code_end - code > FORTHI_SCAN_SCALAR_LEN ? code + FORTHI_SCAN_SCALAR_LEN : code_end;
+    while (code < scalar_end && forthi_is_space(*code))
+        code++;
+    if (code < scalar_end)
+        return code;
 
-    return ctx->code;
+#if FORTHI_HAS_SSE2
+    for (; code_end - code >= FORTHI_SCAN_BLOCK_SIZE; code += FORTHI_SCAN_BLOCK_SIZE)
+    {
+        int mask = ~forthi_space_mask(code) & 0xFFFF;
+        if (mask)
+            return code + forthi_lowest_bit(mask);
+    }
+#endif
+
+    while (code < code_end && forthi_is_space(*code))
+        code++;
+
+    return code;
 }
 
-static const char* forthi_get_next_token(forth_context* ctx, size_t* token_len)
+static const char* forthi_skip_token(const char* code, const char* code_end)
 {
-    const char* token_start = forthi_trim_code(ctx);
+    const char* scalar_end = code_end - code > FORTHI_SCAN_SCALAR_LEN ? code + FORTHI_SCAN_SCALAR_LEN : code_end;
+    while (code < scalar_end && !forthi_is_space(*code))
+        code++;
+    if (code < scalar_end)
+        return code;
 
-    while (*ctx->code)
+#if FORTHI_HAS_SSE2
+    for (; code_end - code >= FORTHI_SCAN_BLOCK_SIZE; code += FORTHI_SCAN_BLOCK_SIZE)
     {
-        ctx->code++;
-        if (forthi_is_space(*ctx->code))
-        {
-            *token_len = ctx->code - token_start;
-            return token_start;
-        }
+        int mask = forthi_space_mask(code);
+        if (mask)
+            return code + forthi_lowest_bit(mask);
     }
+#endif
 
-    return NULL;
+    while (code < code_end && !forthi_is_space(*code))
+        code++;
+
+    return code;
 }
 
-static int forthi_interpret_token(forth_context* ctx)
+// The code is bounded by code_end, it isn't null terminated when it's a 
+// mapped file
+static const char* forthi_trim_code(forth_context* ctx)
+{
+    ctx->code = forthi_skip_spaces(ctx->code, ctx->code_end);
+    return ctx->code;
+}
+
+static const char* forthi_read_until(forth_context* ctx, char delim)
+{
+    while (ctx->code < ctx->code_end && *ctx->code != delim)
+        ctx->code++;
+
+    return ctx->code;
+}
+
+static const char* forthi_get_next_token(forth_context* ctx, size_t* token_len)
+{
+    const char* token_start = forthi_trim_code(ctx);
+    if (ctx->code == ctx->code_end)
+        return NULL;
+
+    ctx->code = forthi_skip_token(ctx->code, ctx->code_end);
+
+    *token_len = ctx->code - token_start;
+    return token_start;
+}
+
+static int forthi_interpret_token(forth_context* ctx)
 {
     forth_pointer memory_pointer = forthi_get_word(ctx, ctx->token, ctx->token_len);
     if (memory_pointer != (forth_pointer)-1)
     {
-        uint8_t word_type = ctx->memory[memory_pointer];
+        uint8_t word_type = *forthi_memory_at(ctx, memory_pointer);
         if (word_type == FORTHI_INST_CALL_C_FUNCTION)
         {
-            forth_c_func fn = NULL;
-            memcpy(&fn, ctx->memory + memory_pointer + 1, sizeof(forth_c_func));
+            forth_c_func fn = forthi_function_at(forthi_memory_at(ctx, memory_pointer + 1));
             if (ctx->state == FORTHI_STATE_INTERPRET)
+            {
+                // Definitions and comments are all a cached INCLUDE replays
+                if (fn != forthi_word_colon && fn != forthi_word_paren && fn != forthi_word_backslash)
+                    ctx->include_effects = 1;
                 return fn(ctx);
+            }
             else
+            {
                 return forthi_compile_function_call(ctx, fn);
+            }
         }
         else if (word_type == FORTHI_INST_EXECUTE)
         {
             if (ctx->state == FORTHI_STATE_INTERPRET)
             {
+                ctx->include_effects = 1;
                 forthi_push_pointer(ctx, (forth_pointer)(memory_pointer + 1));
                 return forthi_word_EXECUTE(ctx);
             }
@@ -985,35 +2406,165 @@ static int forthi_interpret_token(forth_context* ctx)
         return FORTH_FAILURE;
     }
 
+    if (ctx->state == FORTHI_STATE_INTERPRET)
+        ctx->include_effects = 1;
+
     if (forthi_word_NUMBER(ctx) == FORTH_FAILURE)
         return FORTH_FAILURE;
 
     return FORTH_SUCCESS;
 }
 
+// Moves the parsing to where the code set >IN, if it changed it
+static void forthi_follow_to_in(forth_context* ctx, forth_int offset)
+{
+    forth_int value = *(forth_int*)forthi_memory_at(ctx, ctx->input.to_in);
+    if (value == offset)
+        return;
+
+    size_t len = (size_t)(ctx->code_end - ctx->input.source);
+    size_t position = (size_t)(forth_uint)value;
+    ctx->code = ctx->input.source + (position < len ? position : len);
+}
+
 static int forthi_interpret(forth_context* ctx)
 {
-    while ((ctx->token = forthi_get_next_token(ctx, &ctx->token_len)))
+    for (;;)
     {
-        if (forthi_interpret_token(ctx) == FORTH_FAILURE)
+        while ((ctx->token = forthi_get_next_token(ctx, &ctx->token_len)))
+        {
+            forth_int offset = (forth_int)(ctx->code - ctx->input.source);
+            if (ctx->input.to_in)
+                *(forth_int*)forthi_memory_at(ctx, ctx->input.to_in) = offset;
+
+            if (forthi_interpret_token(ctx) == FORTH_FAILURE)
+                return FORTH_FAILURE;
+
+            if (ctx->input.to_in)
+                forthi_follow_to_in(ctx, offset);
+        }
+
+        if (!ctx->input.read)
+            return FORTH_SUCCESS;
+
+        // Streams run in constant memory, the transient region is per line
+        if (ctx->eval_depth == 1)
+            forthi_reset_transient(ctx);
+
+        int refilled = forthi_refill(ctx);
+        if (refilled < 0)
             return FORTH_FAILURE;
+        if (!refilled)
+            return FORTH_SUCCESS;
     }
+}
 
-    return FORTH_SUCCESS;
+// Makes the next line of the stream the input buffer. Returns 1 if there was
+// one, 0 at the end of the input or for strings, -1 on error
+static int forthi_refill(forth_context* ctx)
+{
+    forth_input* input = &ctx->input;
+    if (!input->read)
+        return 0;
+
+    int start = input->next_line;
+    int search = start;
+    int line_end;
+    for (;;)
+    {
+        const char* newline = (const char*)memchr(input->buffer + search, '\n',
+            (size_t)(input->buffer_filled - search));
+        if (newline)
+        {
+            line_end = (int)(newline - input->buffer);
+            input->next_line = line_end + 1;
+            break;
+        }
+
+        if (input->end)
+        {
+            if (start == input->buffer_filled)
+                return 0;
+            line_end = input->buffer_filled;
+            input->next_line = line_end;
+            break;
+        }
+
+        // Make room for the rest of the line
+        if (start > 0)
+        {
+            memmove(input->buffer, input->buffer + start, (size_t)(input->buffer_filled - start));
+            input->buffer_filled -= start;
+            start = 0;
+        }
+        search = input->buffer_filled;
+
+        int room = FORTH_INPUT_BUFFER_SIZE - input->buffer_filled;
+        if (room == 0)
+        {
+            FORTH_LOG(ctx, "Input line too long\n");
+            return -1;
+        }
+
+        int count = input->read(input->user, input->buffer + input->buffer_filled, room);
+        if (count < 0)
+        {
+            FORTH_LOG(ctx, "Error reading input\n");
+            return -1;
+        }
+
+        if (count == 0)
+            input->end = 1;
+        else
+            input->buffer_filled += count < room ? count : room;
+    }
+
+    input->source = input->buffer + start;
+    input->line++;
+    input->source_copy = 0;
+    ctx->code = input->source;
+    ctx->code_end = input->buffer + line_end;
+
+    return 1;
 }
 
-int forth_eval(forth_context* ctx, const char* code)
+static int forthi_run(forth_context* ctx)
 {
-    if (!ctx)
-        return FORTH_FAILURE;
+    ctx->state = FORTHI_STATE_INTERPRET;
 
-    if (!code)
+    // Nested evaluations, like INCLUDE, keep the transient data of the outer one
+    if (ctx->eval_depth == 0)
+        forthi_reset_transient(ctx);
+    ctx->eval_depth++;
+
+#if FORTH_GUARDED_STACKS
+    // Stack overflows land here from the SIGSEGV handler
+    forthi_guard_state guard;
+    guard.ctx = ctx;
+    guard.message = NULL;
+    guard.previous = forthi_current_guard;
+    if (sigsetjmp(guard.jump, 1))
+    {
+        forthi_current_guard = guard.previous;
+        ctx->eval_depth--;
+        forthi_apply_marker(ctx);
+        forthi_update_high_water(ctx);
+        FORTH_LOG(ctx, "%s", guard.message);
+        ctx->stack_pointer = 0;
+        ctx->return_stack_pointer = 0;
         return FORTH_FAILURE;
+    }
 
-    ctx->code = code;
-    ctx->state = FORTHI_STATE_INTERPRET;
+    forthi_current_guard = &guard;
+    int result = forthi_interpret(ctx);
+    forthi_current_guard = guard.previous;
+#else
+    int result = forthi_interpret(ctx);
+#endif
+    ctx->eval_depth--;
+    forthi_update_high_water(ctx);
 
-    if (forthi_interpret(ctx) == FORTH_FAILURE)
+    if (result == FORTH_FAILURE)
     {
         ctx->stack_pointer = 0;
         ctx->return_stack_pointer = 0;
@@ -1022,207 +2573,610 @@ int forth_eval(forth_context* ctx, const char* code)
     return FORTH_SUCCESS;
 }
 
-//---------------------------------------------------------------------------
-// STANDARD WORDS
-//---------------------------------------------------------------------------
-
-static int forthi_word_store(forth_context* ctx)
+// Makes code the input, and gives back the outer one once evaluated
+static int forthi_eval(forth_context* ctx, const char* code, size_t len)
 {
-    FORTH_LOG(ctx, "Unimplemented\n");
-    return FORTH_FAILURE;
-}
+    if (ctx->frozen)
+    {
+        FORTH_LOG(ctx, "Context is frozen\n");
+        return FORTH_FAILURE;
+    }
 
-static int forthi_word_number_sign(forth_context* ctx)
-{
-    FORTH_LOG(ctx, "Unimplemented\n");
-    return FORTH_FAILURE;
-}
+    forth_input outer_input = ctx->input;
+    const char* outer_code = ctx->code;
+    const char* outer_code_end = ctx->code_end;
 
-static int forthi_word_number_sign_greater(forth_context* ctx)
-{
-    FORTH_LOG(ctx, "Unimplemented\n");
-    return FORTH_FAILURE;
-}
+    memset(&ctx->input, 0, sizeof(ctx->input));
+    ctx->input.source = code;
+    ctx->input.id = ++ctx->input_count;
+    ctx->code = code;
+    ctx->code_end = code + len;
 
-static int forthi_word_number_sign_s(forth_context* ctx)
-{
-    FORTH_LOG(ctx, "Unimplemented\n");
-    return FORTH_FAILURE;
-}
+    int result = forthi_run(ctx);
 
-static int forthi_word_tick(forth_context* ctx)
-{
-    FORTH_LOG(ctx, "Unimplemented\n");
-    return FORTH_FAILURE;
+    ctx->input = outer_input;
+    ctx->code = outer_code;
+    ctx->code_end = outer_code_end;
+
+    return result;
 }
 
-static int forthi_word_paren(forth_context* ctx)
+int forth_eval(forth_context* ctx, const char* code)
 {
-    forthi_read_until(ctx, ')');
+    if (!ctx)
+        return FORTH_FAILURE;
 
-    if (*ctx->code)
-        ctx->code++;
+    if (!code)
+        return FORTH_FAILURE;
 
-    return FORTH_SUCCESS;
+    return forthi_eval(ctx, code, strlen(code));
 }
 
-static int forthi_word_paren_local_paren(forth_context* ctx)
+int forth_eval_n(forth_context* ctx, const char* code, size_t len)
 {
-    FORTH_LOG(ctx, "Unimplemented\n");
-    return FORTH_FAILURE;
-}
+    if (!ctx)
+        return FORTH_FAILURE;
 
-static int forthi_word_star(forth_context* ctx)
-{
-    if (forthi_pop(ctx, 2) == FORTH_FAILURE)
+    if (!code)
         return FORTH_FAILURE;
 
-    forth_int n1 = ctx->stack[ctx->stack_pointer].int_value;
-    forth_int n2 = ctx->stack[ctx->stack_pointer + 1].int_value;
-    return forthi_push_int_number(ctx, n1 * n2);
+    return forthi_eval(ctx, code, len);
 }
 
-static int forthi_word_star_slash(forth_context* ctx)
+int forth_eval_stream(forth_context* ctx, forth_read_func read, void* user)
 {
-    if (forthi_pop(ctx, 3) == FORTH_FAILURE)
+    if (!ctx)
         return FORTH_FAILURE;
 
-    forth_int n1 = ctx->stack[ctx->stack_pointer].int_value;
-    forth_int n2 = ctx->stack[ctx->stack_pointer + 1].int_value;
-    forth_int n3 = ctx->stack[ctx->stack_pointer + 2].int_value;
+    if (!read)
+        return FORTH_FAILURE;
 
-    forth_double_length_int intermediate = (forth_double_length_int)n1 * (forth_double_length_int)n2;
-    return forthi_push_int_number(ctx, (forth_int)floor((double)intermediate / (double)n3));
-}
+    if (ctx->frozen)
+    {
+        FORTH_LOG(ctx, "Context is frozen\n");
+        return FORTH_FAILURE;
+    }
 
-static int forthi_word_star_slash_mod(forth_context* ctx)
-{
-    if (forthi_pop(ctx, 3) == FORTH_FAILURE)
+    char* buffer = (char*)forthi_alloc_buffer(ctx, FORTH_INPUT_BUFFER_SIZE);
+    if (!buffer)
+    {
+        FORTH_LOG(ctx, "Out of memory\n");
         return FORTH_FAILURE;
+    }
 
-    forth_uint u1 = ctx->stack[ctx->stack_pointer].uint_value;
-    forth_uint u2 = ctx->stack[ctx->stack_pointer + 1].uint_value;
-    forth_uint u3 = ctx->stack[ctx->stack_pointer + 2].uint_value;
+    forth_input outer_input = ctx->input;
+    const char* outer_code = ctx->code;
+    const char* outer_code_end = ctx->code_end;
 
-    forth_double_length_uint intermediate = (forth_double_length_uint)u1 * (forth_double_length_uint)u2;
+    // Starts on an empty line, the interpreter reads the first one
+    memset(&ctx->input, 0, sizeof(ctx->input));
+    ctx->input.source = buffer;
+    ctx->input.read = read;
+    ctx->input.user = user;
+    ctx->input.buffer = buffer;
+    ctx->input.id = ++ctx->input_count;
+    ctx->code = buffer;
+    ctx->code_end = buffer;
 
-    if (forthi_push_uint_number(ctx, (forth_uint)(intermediate % (forth_double_length_uint)u3)) == FORTH_FAILURE)
-        return FORTH_FAILURE;
-    
-    return forthi_push_uint_number(ctx, (forth_uint)(intermediate / (forth_double_length_uint)u3));
+    int result = forthi_run(ctx);
+
+    ctx->input = outer_input;
+    ctx->code = outer_code;
+    ctx->code_end = outer_code_end;
+    forthi_free_buffer(ctx, buffer);
+
+    return result;
 }
 
-static int forthi_word_plus(forth_context* ctx)
+int forth_read_file(void* file, char* buffer, int size)
 {
-    if (forthi_pop(ctx, 2) == FORTH_FAILURE)
-        return FORTH_FAILURE;
+    size_t count = fread(buffer, 1, (size_t)size, (FILE*)file);
+    if (count == 0 && ferror((FILE*)file))
+        return -1;
 
-    forth_int n1 = ctx->stack[ctx->stack_pointer].int_value;
-    forth_int n2 = ctx->stack[ctx->stack_pointer + 1].int_value;
-    return forthi_push_int_number(ctx, n1 + n2);
+    return (int)count;
 }
 
-static int forthi_word_plus_store(forth_context* ctx)
+//---------------------------------------------------------------------------
+// INCLUDE CACHE
+//---------------------------------------------------------------------------
+
+// Followed by the code, padded so what comes next is aligned, the C function
+// offsets, then the words' pointers, name lengths and names, in definition
+// order
+typedef struct forthi_include_cache_header
+{
+    char magic[8];
+    uint32_t version;
+    uint8_t int_size;
+    uint8_t pointer_size;
+    uint8_t function_size;
+    uint8_t padding;
+    uint64_t content_hash;
+    uint64_t state_hash;
+    uint64_t memory_pointer;
+    uint64_t code_size;
+    int32_t word_count;
+    int32_t names_size;
+    int32_t fn_offset_count;
+    int32_t padding2;
+} forthi_include_cache_header;
+
+static uint64_t forthi_hash_bytes(uint64_t hash, const void* data, size_t size)
+{
+    // FNV-1a
+    const uint8_t* bytes = (const uint8_t*)data;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// What the compiled code depends on: the data space, with BASE and the C
+// functions, and the dictionnary
+static uint64_t forthi_hash_include_state(forth_context* ctx)
 {
-    FORTH_LOG(ctx, "Unimplemented\n");
-    return FORTH_FAILURE;
+    uint64_t hash = forthi_hash_bytes(14695981039346656037ull, ctx->memory, ctx->memory_pointer);
+    int dict_index = ctx->dict_size - ctx->dict_pointer;
+    hash = forthi_hash_bytes(hash, ctx->dict_pointers + dict_index, sizeof(forth_pointer) * ctx->dict_pointer);
+    hash = forthi_hash_bytes(hash, ctx->dict_name_lens + dict_index, sizeof(int) * ctx->dict_pointer);
+    return forthi_hash_bytes(hash, ctx->dict_names, ctx->dict_names_pointer);
 }
 
-static int forthi_word_plus_field(forth_context* ctx)
+// Space taken by the code in cache files
+static size_t forthi_include_cache_code_space(uint64_t code_size)
 {
-    FORTH_LOG(ctx, "Unimplemented\n");
-    return FORTH_FAILURE;
+    return (size_t)((code_size + sizeof(forth_pointer) - 1) / sizeof(forth_pointer) * sizeof(forth_pointer));
 }
 
-static int forthi_word_plus_loop(forth_context* ctx)
+// One cache file per included file, named after it
+static int forthi_include_cache_path(forth_context* ctx, const char* filename, char* path, size_t path_size)
 {
-    if (ctx->state == FORTHI_STATE_INTERPRET)
-    {
-        FORTH_LOG(ctx, "Interpreting a compile-only word\n");
+    int len = snprintf(path, path_size, "%s/", ctx->include_cache_dir);
+    if (len < 0 || (size_t)len >= path_size)
         return FORTH_FAILURE;
-    }
 
-    if (ctx->state == FORTHI_STATE_COMPILE)
+    for (const char* c = filename; *c; c++)
     {
-        if (forthi_pop(ctx, 1) == FORTH_FAILURE)
+        if ((size_t)len + 1 >= path_size)
             return FORTH_FAILURE;
-
-        return forthi_write_pointer(ctx, ctx->stack[ctx->stack_pointer].pointer_value);
+        path[len++] = (*c == '/' || *c == '\\' || *c == ':') ? '_' : *c;
     }
 
-    if (ctx->state == FORTHI_STATE_EXECUTE)
-    {
-        if (ctx->return_stack_pointer < 2)
-        {
-            FORTH_LOG(ctx, "Return stack underflow\n");
-            return FORTH_FAILURE;
-        }
+    if ((size_t)len + sizeof(".fcache") > path_size)
+        return FORTH_FAILURE;
+    memcpy(path + len, ".fcache", sizeof(".fcache"));
+    return FORTH_SUCCESS;
+}
 
-        if (forthi_pop(ctx, 1) == FORTH_FAILURE)
-            return FORTH_FAILURE;
-        
-        forth_int i = ctx->return_stack[ctx->return_stack_pointer - 1].int_value;
-        forth_int prev_i = i;
-        forth_int i_tick = ctx->return_stack[ctx->return_stack_pointer - 2].int_value;
-        forth_int inc = ctx->stack[ctx->stack_pointer].int_value;
-        forth_int diff = i_tick - i;
-        i += inc;
+static int forthi_apply_include_cache(forth_context* ctx, const uint8_t* data, size_t size, 
+                                      uint64_t content_hash, uint64_t state_hash)
+{
+    forthi_include_cache_header header;
+    if (size < sizeof(forthi_include_cache_header))
+        return FORTH_FAILURE;
+    memcpy(&header, data, sizeof(forthi_include_cache_header));
 
-        if (inc > 0 && prev_i > i)
-        {
-            ctx->program_pointer += sizeof(forth_pointer);
-            return forthi_pop_return(ctx, 2);
-        }
+    if (memcmp(header.magic, FORTHI_INCLUDE_CACHE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != FORTHI_INCLUDE_CACHE_VERSION ||
+        header.int_size != sizeof(forth_int) ||
+        header.pointer_size != sizeof(forth_pointer) ||
+        header.function_size != sizeof(forth_c_func) ||
+        header.content_hash != content_hash ||
+        header.state_hash != state_hash ||
+        header.memory_pointer != (uint64_t)ctx->memory_pointer ||
+        header.word_count < 0 || header.names_size < 0 || header.fn_offset_count < 0 ||
+        header.code_size > (uint64_t)INT_MAX)
+        return FORTH_FAILURE;
 
-        if ((diff > 0 && i < i_tick) || (diff <= 0 && i >= i_tick))
-        {
-            ctx->return_stack[ctx->return_stack_pointer - 1].int_value = i;
+    size_t expected_size = sizeof(forthi_include_cache_header) + forthi_include_cache_code_space(header.code_size) + 
+        sizeof(forth_pointer) * (size_t)header.fn_offset_count + 
+        (sizeof(forth_pointer) + sizeof(int)) * (size_t)header.word_count + (size_t)header.names_size;
+    if (size != expected_size)
+        return FORTH_FAILURE;
 
-            if (forthi_check_valid_memory_range(ctx, ctx->program_pointer, sizeof(forth_pointer)) == FORTH_FAILURE)
-                return FORTH_FAILURE;
+    const uint8_t* code = data + sizeof(forthi_include_cache_header);
+    const forth_pointer* fn_offsets = (const forth_pointer*)(code + forthi_include_cache_code_space(header.code_size));
+    const forth_pointer* pointers = fn_offsets + header.fn_offset_count;
+    const int* name_lens = (const int*)(pointers + header.word_count);
+    const char* names = (const char*)(name_lens + header.word_count);
 
-            ctx->program_pointer = *(forth_pointer*)&ctx->memory[ctx->program_pointer];
-            return FORTH_SUCCESS;
-        }
+    forth_pointer memory_pointer = ctx->memory_pointer;
+    forth_pointer code_end = memory_pointer + (forth_pointer)header.code_size;
+    for (int i = 0; i < header.fn_offset_count; i++)
+        if (fn_offsets[i] < memory_pointer || fn_offsets[i] + sizeof(forth_c_func) > code_end || 
+            (i > 0 && fn_offsets[i] < fn_offsets[i - 1] + sizeof(forth_c_func)))
+            return FORTH_FAILURE;
 
-        ctx->program_pointer += sizeof(forth_pointer);
-        return forthi_pop_return(ctx, 2);
+    int names_size = 0;
+    for (int i = 0; i < header.word_count; i++)
+    {
+        if (pointers[i] < memory_pointer || pointers[i] >= code_end || 
+            name_lens[i] < 0 || name_lens[i] > header.names_size - names_size)
+            return FORTH_FAILURE;
+        names_size += name_lens[i];
     }
 
-    return FORTH_FAILURE;
-}
+    if (!ctx->dict_auto_resize && ctx->dict_size - ctx->dict_pointer < header.word_count)
+        return FORTH_FAILURE;
 
-static int forthi_word_slash_loop(forth_context* ctx)
-{
-    if (ctx->state == FORTHI_STATE_INTERPRET)
-    {
-        FORTH_LOG(ctx, "Interpreting a compile-only word\n");
+    if (forthi_reserve_memory_space(ctx, (forth_pointer)header.code_size) == FORTH_FAILURE)
         return FORTH_FAILURE;
-    }
 
-    if (ctx->state == FORTHI_STATE_COMPILE)
+    int dict_pointer = ctx->dict_pointer;
+    memcpy(forthi_memory_at(ctx, memory_pointer), code, (size_t)header.code_size);
+    ctx->memory_pointer = code_end;
+
+    const char* name = names;
+    for (int i = 0; i < header.fn_offset_count; i++)
     {
-        if (forthi_pop(ctx, 1) == FORTH_FAILURE)
+        if (ctx->fn_offsets_pointer == ctx->fn_offsets_size && forthi_grow_fn_offsets(ctx) == FORTH_FAILURE)
+        {
+            forthi_rewind(ctx, dict_pointer, memory_pointer);
             return FORTH_FAILURE;
-
-        return forthi_write_pointer(ctx, ctx->stack[ctx->stack_pointer].pointer_value);
+        }
+        ctx->fn_offsets[ctx->fn_offsets_pointer++] = fn_offsets[i];
     }
 
-    if (ctx->state == FORTHI_STATE_EXECUTE)
+    for (int i = 0; i < header.word_count; i++)
     {
-        if (ctx->return_stack_pointer < 2)
+        if (forthi_add_word(ctx, name, name_lens[i], pointers[i]) == FORTH_FAILURE)
         {
-            FORTH_LOG(ctx, "Return stack underflow\n");
+            forthi_rewind(ctx, dict_pointer, memory_pointer);
             return FORTH_FAILURE;
         }
+        name += name_lens[i];
+    }
 
-        if (forthi_pop(ctx, 1) == FORTH_FAILURE)
-            return FORTH_FAILURE;
+    return FORTH_SUCCESS;
+}
 
-        forth_uint i = ctx->return_stack[ctx->return_stack_pointer - 1].uint_value;
-        forth_uint i_tick = ctx->return_stack[ctx->return_stack_pointer - 2].uint_value;
-        forth_uint inc = ctx->stack[ctx->stack_pointer].uint_value;
-        i += inc;
+// Appends the code and words of a file compiled before from the same state.
+// Fails without changing anything otherwise.
+static int forthi_load_include_cache(forth_context* ctx, const char* path, uint64_t content_hash, uint64_t state_hash)
+{
+    FILE* file = fopen(path, "rb");
+    if (!file)
+        return FORTH_FAILURE;
+
+    fseek(file, 0, SEEK_END);
+    long file_size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    uint8_t* data = file_size > 0 ? (uint8_t*)forthi_alloc_buffer(ctx, (size_t)file_size) : NULL;
+    size_t byte_read = data ? fread(data, 1, (size_t)file_size, file) : 0;
+    fclose(file);
+
+    int result = FORTH_FAILURE;
+    if (data && byte_read == (size_t)file_size)
+        result = forthi_apply_include_cache(ctx, data, byte_read, content_hash, state_hash);
+
+    if (data)
+        forthi_free_buffer(ctx, data);
+    return result;
+}
+
+// Saves what a file added, from the state before it. Best effort, the file
+// just gets compiled again next time if this fails.
+static void forthi_save_include_cache(forth_context* ctx, const char* path, uint64_t content_hash, uint64_t state_hash,
+                                      forth_pointer memory_pointer, int dict_pointer, int fn_offsets_pointer)
+{
+    forthi_include_cache_header header;
+    memset(&header, 0, sizeof(forthi_include_cache_header));
+    memcpy(header.magic, FORTHI_INCLUDE_CACHE_MAGIC, sizeof(header.magic));
+    header.version = FORTHI_INCLUDE_CACHE_VERSION;
+    header.int_size = (uint8_t)sizeof(forth_int);
+    header.pointer_size = (uint8_t)sizeof(forth_pointer);
+    header.function_size = (uint8_t)sizeof(forth_c_func);
+    header.content_hash = content_hash;
+    header.state_hash = state_hash;
+    header.memory_pointer = (uint64_t)memory_pointer;
+    header.code_size = (uint64_t)(ctx->memory_pointer - memory_pointer);
+    header.word_count = ctx->dict_pointer - dict_pointer;
+    header.fn_offset_count = ctx->fn_offsets_pointer - fn_offsets_pointer;
+
+    int names_start = 0;
+    if (dict_pointer > 0)
+    {
+        int index = ctx->dict_size - dict_pointer;
+        names_start = ctx->dict_name_offsets[index] + ctx->dict_name_lens[index];
+    }
+    header.names_size = ctx->dict_names_pointer - names_start;
+
+    // Written aside, so a reader never sees half of it
+    char temp_path[FORTHI_INCLUDE_CACHE_PATH_SIZE + 4];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", path);
+    FILE* file = fopen(temp_path, "wb");
+    if (!file)
+        return;
+
+    static const uint8_t padding[sizeof(forth_pointer)] = {0};
+    size_t padding_size = forthi_include_cache_code_space(header.code_size) - (size_t)header.code_size;
+    uint8_t result = 
+        fwrite(&header, sizeof(forthi_include_cache_header), 1, file) == 1 &&
+        fwrite(forthi_memory_at(ctx, memory_pointer), 1, (size_t)header.code_size, file) == (size_t)header.code_size &&
+        fwrite(padding, 1, padding_size, file) == padding_size &&
+        fwrite(ctx->fn_offsets + fn_offsets_pointer, sizeof(forth_pointer), header.fn_offset_count, file) == 
+            (size_t)header.fn_offset_count;
+
+    // Oldest first, the way they get added back
+    for (int i = ctx->dict_size - dict_pointer - 1; result && i >= ctx->dict_size - ctx->dict_pointer; i--)
+        result = fwrite(&ctx->dict_pointers[i], sizeof(forth_pointer), 1, file) == 1;
+    for (int i = ctx->dict_size - dict_pointer - 1; result && i >= ctx->dict_size - ctx->dict_pointer; i--)
+        result = fwrite(&ctx->dict_name_lens[i], sizeof(int), 1, file) == 1;
+    result = result && 
+        fwrite(ctx->dict_names + names_start, 1, header.names_size, file) == (size_t)header.names_size;
+
+    if (fclose(file) != 0 || !result || rename(temp_path, path) != 0)
+        remove(temp_path);
+}
+
+//---------------------------------------------------------------------------
+// STANDARD WORDS
+//---------------------------------------------------------------------------
+
+static int forthi_word_store(forth_context* ctx)
+{
+    FORTH_LOG(ctx, "Unimplemented\n");
+    return FORTH_FAILURE;
+}
+
+static int forthi_hold(forth_context* ctx, char c)
+{
+    if (!ctx->hold_start)
+    {
+        FORTH_LOG(ctx, "Missing <#\n");
+        return FORTH_FAILURE;
+    }
+
+    if (ctx->hold_pointer == ctx->hold_start)
+    {
+        FORTH_LOG(ctx, "Pictured numeric output overflow\n");
+        return FORTH_FAILURE;
+    }
+
+    *forthi_memory_at(ctx, --ctx->hold_pointer) = (uint8_t)c;
+    return FORTH_SUCCESS;
+}
+
+static int forthi_word_number_sign(forth_context* ctx)
+{
+    if (forthi_pop(ctx, 2) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    forth_double_length_uint ud = forthi_to_double_length_uint(ctx->stack[ctx->stack_pointer].uint_value, 
+                                                               ctx->stack[ctx->stack_pointer + 1].uint_value);
+
+    forth_int base;
+    if (forthi_read_number_at(ctx, &base, ctx->base) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    if (base < 2 || base > 36)
+    {
+        FORTH_LOG(ctx, "Invalid BASE\n");
+        return FORTH_FAILURE;
+    }
+
+    int digit = (int)(ud % (forth_double_length_uint)base);
+    if (forthi_hold(ctx, (char)(digit < 10 ? '0' + digit : 'A' + digit - 10)) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    return forthi_push_double_length_uint(ctx, ud / (forth_double_length_uint)base);
+}
+
+static int forthi_word_number_sign_greater(forth_context* ctx)
+{
+    if (forthi_pop(ctx, 2) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    if (!ctx->hold_start)
+    {
+        FORTH_LOG(ctx, "Missing <#\n");
+        return FORTH_FAILURE;
+    }
+
+    if (forthi_push_pointer(ctx, ctx->hold_pointer) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+    return forthi_push_int_number(ctx, (forth_int)(ctx->hold_start + FORTHI_HOLD_SIZE - ctx->hold_pointer));
+}
+
+static int forthi_word_number_sign_s(forth_context* ctx)
+{
+    do
+    {
+        if (forthi_word_number_sign(ctx) == FORTH_FAILURE)
+            return FORTH_FAILURE;
+    } while (ctx->stack[ctx->stack_pointer - 1].uint_value || ctx->stack[ctx->stack_pointer - 2].uint_value);
+
+    return FORTH_SUCCESS;
+}
+
+static int forthi_word_tick(forth_context* ctx)
+{
+    FORTH_LOG(ctx, "Unimplemented\n");
+    return FORTH_FAILURE;
+}
+
+static int forthi_word_paren(forth_context* ctx)
+{
+    // In streams, comments go on over the next lines
+    for (;;)
+    {
+        forthi_read_until(ctx, ')');
+
+        if (ctx->code < ctx->code_end)
+        {
+            ctx->code++;
+            return FORTH_SUCCESS;
+        }
+
+        int refilled = forthi_refill(ctx);
+        if (refilled < 0)
+            return FORTH_FAILURE;
+        if (!refilled)
+            return FORTH_SUCCESS;
+    }
+}
+
+static int forthi_word_paren_local_paren(forth_context* ctx)
+{
+    FORTH_LOG(ctx, "Unimplemented\n");
+    return FORTH_FAILURE;
+}
+
+static int forthi_word_star(forth_context* ctx)
+{
+    if (forthi_pop(ctx, 2) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    forth_int n1 = ctx->stack[ctx->stack_pointer].int_value;
+    forth_int n2 = ctx->stack[ctx->stack_pointer + 1].int_value;
+    return forthi_push_int_number(ctx, n1 * n2);
+}
+
+static int forthi_word_star_slash(forth_context* ctx)
+{
+    if (forthi_pop(ctx, 3) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    forth_int n1 = ctx->stack[ctx->stack_pointer].int_value;
+    forth_int n2 = ctx->stack[ctx->stack_pointer + 1].int_value;
+    forth_int n3 = ctx->stack[ctx->stack_pointer + 2].int_value;
+
+    forth_double_length_int intermediate = (forth_double_length_int)n1 * (forth_double_length_int)n2;
+    return forthi_push_int_number(ctx, (forth_int)floor((double)intermediate / (double)n3));
+}
+
+static int forthi_word_star_slash_mod(forth_context* ctx)
+{
+    if (forthi_pop(ctx, 3) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    forth_uint u1 = ctx->stack[ctx->stack_pointer].uint_value;
+    forth_uint u2 = ctx->stack[ctx->stack_pointer + 1].uint_value;
+    forth_uint u3 = ctx->stack[ctx->stack_pointer + 2].uint_value;
+
+    forth_double_length_uint intermediate = (forth_double_length_uint)u1 * (forth_double_length_uint)u2;
+
+    if (forthi_push_uint_number(ctx, (forth_uint)(intermediate % (forth_double_length_uint)u3)) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+    
+    return forthi_push_uint_number(ctx, (forth_uint)(intermediate / (forth_double_length_uint)u3));
+}
+
+static int forthi_word_plus(forth_context* ctx)
+{
+    if (forthi_pop(ctx, 2) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    forth_int n1 = ctx->stack[ctx->stack_pointer].int_value;
+    forth_int n2 = ctx->stack[ctx->stack_pointer + 1].int_value;
+    return forthi_push_int_number(ctx, n1 + n2);
+}
+
+static int forthi_word_plus_store(forth_context* ctx)
+{
+    FORTH_LOG(ctx, "Unimplemented\n");
+    return FORTH_FAILURE;
+}
+
+static int forthi_word_plus_field(forth_context* ctx)
+{
+    FORTH_LOG(ctx, "Unimplemented\n");
+    return FORTH_FAILURE;
+}
+
+static int forthi_word_plus_loop(forth_context* ctx)
+{
+    if (ctx->state == FORTHI_STATE_INTERPRET)
+    {
+        FORTH_LOG(ctx, "Interpreting a compile-only word\n");
+        return FORTH_FAILURE;
+    }
+
+    if (ctx->state == FORTHI_STATE_COMPILE)
+    {
+        if (forthi_pop(ctx, 1) == FORTH_FAILURE)
+            return FORTH_FAILURE;
+
+        return forthi_write_pointer(ctx, ctx->stack[ctx->stack_pointer].pointer_value);
+    }
+
+    if (ctx->state == FORTHI_STATE_EXECUTE)
+    {
+        if (ctx->return_stack_pointer < 2)
+        {
+            FORTH_LOG(ctx, "Return stack underflow\n");
+            return FORTH_FAILURE;
+        }
+
+        if (forthi_pop(ctx, 1) == FORTH_FAILURE)
+            return FORTH_FAILURE;
+        
+        forth_int i = ctx->return_stack[ctx->return_stack_pointer - 1].int_value;
+        forth_int prev_i = i;
+        forth_int i_tick = ctx->return_stack[ctx->return_stack_pointer - 2].int_value;
+        forth_int inc = ctx->stack[ctx->stack_pointer].int_value;
+        forth_int diff = i_tick - i;
+        i += inc;
+
+        if (inc > 0 && prev_i > i)
+        {
+            ctx->program_pointer += sizeof(forth_pointer);
+            return forthi_pop_return(ctx, 2);
+        }
+
+        if ((diff > 0 && i < i_tick) || (diff <= 0 && i >= i_tick))
+        {
+            ctx->return_stack[ctx->return_stack_pointer - 1].int_value = i;
+
+            if (forthi_check_valid_memory_range(ctx, ctx->program_pointer, sizeof(forth_pointer)) == FORTH_FAILURE)
+                return FORTH_FAILURE;
+
+            ctx->program_pointer = *(forth_pointer*)forthi_memory_at(ctx, ctx->program_pointer);
+            return FORTH_SUCCESS;
+        }
+
+        ctx->program_pointer += sizeof(forth_pointer);
+        return forthi_pop_return(ctx, 2);
+    }
+
+    return FORTH_FAILURE;
+}
+
+static int forthi_word_slash_loop(forth_context* ctx)
+{
+    if (ctx->state == FORTHI_STATE_INTERPRET)
+    {
+        FORTH_LOG(ctx, "Interpreting a compile-only word\n");
+        return FORTH_FAILURE;
+    }
+
+    if (ctx->state == FORTHI_STATE_COMPILE)
+    {
+        if (forthi_pop(ctx, 1) == FORTH_FAILURE)
+            return FORTH_FAILURE;
+
+        return forthi_write_pointer(ctx, ctx->stack[ctx->stack_pointer].pointer_value);
+    }
+
+    if (ctx->state == FORTHI_STATE_EXECUTE)
+    {
+        if (ctx->return_stack_pointer < 2)
+        {
+            FORTH_LOG(ctx, "Return stack underflow\n");
+            return FORTH_FAILURE;
+        }
+
+        if (forthi_pop(ctx, 1) == FORTH_FAILURE)
+            return FORTH_FAILURE;
+
+        forth_uint i = ctx->return_stack[ctx->return_stack_pointer - 1].uint_value;
+        forth_uint i_tick = ctx->return_stack[ctx->return_stack_pointer - 2].uint_value;
+        forth_uint inc = ctx->stack[ctx->stack_pointer].uint_value;
+        i += inc;
         if (i < i_tick)
         {
             ctx->return_stack[ctx->return_stack_pointer - 1].uint_value = i;
@@ -1230,7 +3184,7 @@ static int forthi_word_slash_loop(forth_context* ctx)
             if (forthi_check_valid_memory_range(ctx, ctx->program_pointer, sizeof(forth_pointer)) == FORTH_FAILURE)
                 return FORTH_FAILURE;
 
-            ctx->program_pointer = *(forth_pointer*)&ctx->memory[ctx->program_pointer];
+            ctx->program_pointer = *(forth_pointer*)forthi_memory_at(ctx, ctx->program_pointer);
             return FORTH_SUCCESS;
         }
 
@@ -1311,13 +3265,13 @@ static int forthi_word_dot_quote(forth_context* ctx)
         return FORTH_SUCCESS;
     }
 
-    if (*ctx->code)
+    if (ctx->code < ctx->code_end)
         ctx->code++;
 
     const char* string_start = ctx->code;
     const char* string_end = forthi_read_until(ctx, '\"');
 
-    if (*ctx->code)
+    if (ctx->code < ctx->code_end)
         ctx->code++;
 
     size_t len = string_end - string_start;
@@ -1613,7 +3567,7 @@ static int forthi_word_colon(forth_context* ctx)
 
     if (forthi_reserve_memory_space(ctx, 1) == FORTH_FAILURE)
         return FORTH_FAILURE;
-    ctx->memory[ctx->memory_pointer++] = FORTHI_INST_EXECUTE;
+    *forthi_memory_at(ctx, ctx->memory_pointer++) = FORTHI_INST_EXECUTE;
 
     return FORTH_SUCCESS;
 }
@@ -1661,8 +3615,13 @@ static int forthi_word_less_than(forth_context* ctx)
 
 static int forthi_word_less_number_sign(forth_context* ctx)
 {
-    FORTH_LOG(ctx, "Unimplemented\n");
-    return FORTH_FAILURE;
+    // The same buffer is reused by every <# of an evaluation
+    if (!ctx->hold_start &&
+        forthi_transient_alloc(ctx, FORTHI_HOLD_SIZE, &ctx->hold_start) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    ctx->hold_pointer = ctx->hold_start + FORTHI_HOLD_SIZE;
+    return FORTH_SUCCESS;
 }
 
 static int forthi_word_not_equals(forth_context* ctx)
@@ -1709,8 +3668,13 @@ static int forthi_word_to_float(forth_context* ctx)
 
 static int forthi_word_to_in(forth_context* ctx)
 {
-    FORTH_LOG(ctx, "Unimplemented\n");
-    return FORTH_FAILURE;
+    // The interpreter keeps it up to date once it exists
+    if (!ctx->input.to_in && 
+        forthi_transient_alloc(ctx, sizeof(forth_int), &ctx->input.to_in) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    *(forth_int*)forthi_memory_at(ctx, ctx->input.to_in) = (forth_int)(ctx->code - ctx->input.source);
+    return forthi_push_pointer(ctx, ctx->input.to_in);
 }
 
 static int forthi_word_to_number(forth_context* ctx)
@@ -1798,13 +3762,13 @@ static int forthi_word_abort_quote(forth_context* ctx)
         return FORTH_FAILURE;
     }
 
-    if (*ctx->code)
+    if (ctx->code < ctx->code_end)
         ctx->code++;
 
     const char* string_start = ctx->code;
     const char* string_end = forthi_read_until(ctx, '\"');
 
-    if (*ctx->code)
+    if (ctx->code < ctx->code_end)
         ctx->code++;
 
     size_t len = string_end - string_start;
@@ -1870,8 +3834,16 @@ static int forthi_word_ALIGNED(forth_context* ctx)
 
 static int forthi_word_ALLOCATE(forth_context* ctx)
 {
-    FORTH_LOG(ctx, "Unimplemented\n");
-    return FORTH_FAILURE;
+    if (forthi_pop(ctx, 1) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    forth_pointer at = 0;
+    forth_uint size = ctx->stack[ctx->stack_pointer].uint_value;
+    int ior = forthi_heap_alloc(ctx, size, &at) == FORTH_SUCCESS ? 0 : FORTHI_IOR_ALLOCATE;
+
+    if (forthi_push_pointer(ctx, at) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+    return forthi_push_int_number(ctx, ior);
 }
 
 static int forthi_word_ALLOT(forth_context* ctx)
@@ -2436,7 +4408,7 @@ static int forthi_word_ELSE(forth_context* ctx)
         if (forthi_write_pointer(ctx, 0) == FORTH_FAILURE)
             return FORTH_FAILURE;
 
-        *(forth_pointer*)&ctx->memory[false_branch_pointer] = ctx->memory_pointer;
+        *(forth_pointer*)forthi_memory_at(ctx, false_branch_pointer) = ctx->memory_pointer;
 
         return FORTH_SUCCESS;
     }
@@ -2472,7 +4444,7 @@ static int forthi_word_emit_question(forth_context* ctx)
 
 static int forthi_word_EMPTY(forth_context* ctx)
 {
-    ctx->dict_pointer = ctx->default_dict_pointer;
+    forthi_rewind(ctx, ctx->default_dict_pointer, ctx->default_memory_pointer);
     return FORTH_SUCCESS;
 }
 
@@ -2520,11 +4492,6 @@ static int forthi_word_EVALUATE(forth_context* ctx)
 
 static int forthi_word_EXECUTE(forth_context* ctx)
 {
-    uint8_t inst;
-    forth_c_func fn;
-    forth_int number;
-    forth_pointer pointer;
-
     if (forthi_pop(ctx) == FORTH_FAILURE)
         return FORTH_FAILURE;
 
@@ -2532,6 +4499,18 @@ static int forthi_word_EXECUTE(forth_context* ctx)
     ctx->program_pointer = ctx->stack[ctx->stack_pointer].pointer_value;
     ctx->state = FORTHI_STATE_EXECUTE;
 
+    int result = forthi_execute(ctx);
+    forthi_apply_marker(ctx);
+    return result;
+}
+
+static int forthi_execute(forth_context* ctx)
+{
+    uint8_t inst;
+    forth_c_func fn;
+    forth_int number;
+    forth_pointer pointer;
+
     while (ctx->return_stack_pointer > 0)
     {
         if (forthi_read_byte(ctx, &inst) == FORTH_FAILURE)
@@ -2910,7 +4889,14 @@ static int forthi_word_FORGET(forth_context* ctx)
         return FORTH_FAILURE;
     }
 
-    ctx->dict_pointer = ctx->dict_size - index - 1;
+    int dict_pointer = ctx->dict_size - index - 1;
+    if (dict_pointer < ctx->default_dict_pointer)
+    {
+        FORTH_LOG(ctx, "Protected word\n");
+        return FORTH_FAILURE;
+    }
+
+    forthi_rewind(ctx, dict_pointer, ctx->dict_pointers[index]);
     return FORTH_SUCCESS;
 }
 
@@ -2934,8 +4920,11 @@ static int forthi_word_f_over(forth_context* ctx)
 
 static int forthi_word_FREE(forth_context* ctx)
 {
-    FORTH_LOG(ctx, "Unimplemented\n");
-    return FORTH_FAILURE;
+    if (forthi_pop(ctx, 1) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    forth_pointer at = ctx->stack[ctx->stack_pointer].pointer_value;
+    return forthi_push_int_number(ctx, forthi_heap_free(ctx, at) == FORTH_SUCCESS ? 0 : FORTHI_IOR_FREE);
 }
 
 static int forthi_word_f_rote(forth_context* ctx)
@@ -3046,14 +5035,31 @@ static int forthi_word_HEX(forth_context* ctx)
 
 static int forthi_word_HOLD(forth_context* ctx)
 {
-    FORTH_LOG(ctx, "Unimplemented\n");
-    return FORTH_FAILURE;
+    if (forthi_pop(ctx, 1) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    return forthi_hold(ctx, (char)ctx->stack[ctx->stack_pointer].int_value);
 }
 
 static int forthi_word_HOLDS(forth_context* ctx)
 {
-    FORTH_LOG(ctx, "Unimplemented\n");
-    return FORTH_FAILURE;
+    if (forthi_pop(ctx, 2) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    forth_pointer at = ctx->stack[ctx->stack_pointer].pointer_value;
+    forth_uint len = ctx->stack[ctx->stack_pointer + 1].uint_value;
+    if (forthi_check_valid_memory_range(ctx, at, len) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    // Held from the end, like digits
+    while (len > 0)
+    {
+        len--;
+        if (forthi_hold(ctx, (char)*forthi_memory_at(ctx, at + len)) == FORTH_FAILURE)
+            return FORTH_FAILURE;
+    }
+
+    return FORTH_SUCCESS;
 }
 
 static int forthi_word_I(forth_context* ctx)
@@ -3118,69 +5124,292 @@ static int forthi_word_IMMEDIATE(forth_context* ctx)
     return FORTH_FAILURE;
 }
 
-static int forthi_word_INCLUDE(forth_context* ctx)
+// Source files are mapped where possible, the code is then read in place
+typedef struct forthi_source
 {
-    if (ctx->state == FORTHI_STATE_INTERPRET)
+    const char* text;
+    size_t size;
+    uint8_t mapped;
+    forth_included_file file;
+} forthi_source;
+
+static int forthi_open_source(forth_context* ctx, const char* filename, forthi_source* source)
+{
+    source->text = NULL;
+    source->size = 0;
+    source->mapped = 0;
+    memset(&source->file, 0, sizeof(source->file));
+
+#if FORTHI_HAS_MMAN
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
     {
-        size_t filename_len;
-        const char* filename = forthi_get_next_token(ctx, &filename_len);
-        if (!filename || filename_len > 259)
-        {
-            FORTH_LOG(ctx, "No such file or directory\n");
-            return FORTH_FAILURE;
-        }
+        FORTH_LOG(ctx, "No such file or directory\n");
+        return FORTH_FAILURE;
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0)
+    {
+        close(fd);
+        FORTH_LOG(ctx, "Error reading file\n");
+        return FORTH_FAILURE;
+    }
 
-        char zs_filename[260];
-        memcpy(zs_filename, filename, filename_len);
-        zs_filename[filename_len] = '\0';
+    source->file.device = (uint64_t)file_stat.st_dev;
+    source->file.inode = (uint64_t)file_stat.st_ino;
+    source->size = (size_t)file_stat.st_size;
+    if (source->size == 0)
+    {
+        close(fd);
+        return FORTH_SUCCESS;
+    }
 
-        FILE* file = fopen(zs_filename, "rb");
-        if (!file)
-        {
-            FORTH_LOG(ctx, "No such file or directory\n");
-            return FORTH_FAILURE;
-        }
+    void* text = mmap(NULL, source->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (text == MAP_FAILED)
+    {
+        FORTH_LOG(ctx, "Error reading file\n");
+        return FORTH_FAILURE;
+    }
+
+    madvise(text, source->size, MADV_SEQUENTIAL);
+    source->text = (const char*)text;
+    source->mapped = 1;
+    return FORTH_SUCCESS;
+#else
+    FILE* file = fopen(filename, "rb");
+    if (!file)
+    {
+        FORTH_LOG(ctx, "No such file or directory\n");
+        return FORTH_FAILURE;
+    }
+
+    // Without inodes, files are told apart by their path
+    source->file.inode = forthi_hash_bytes(14695981039346656037ull, filename, strlen(filename));
+
+    fseek(file, 0, SEEK_END);
+    source->size = (size_t)ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    if (source->size == 0)
+    {
+        fclose(file);
+        return FORTH_SUCCESS;
+    }
+
+    char* text = (char*)forthi_alloc_buffer(ctx, source->size);
+    if (!text)
+    {
+        fclose(file);
+        FORTH_LOG(ctx, "Out of memory\n");
+        return FORTH_FAILURE;
+    }
+
+    size_t byte_read = fread(text, 1, source->size, file);
+    fclose(file);
+    source->text = text;
+
+    if (byte_read != source->size)
+    {
+        forthi_free_buffer(ctx, text);
+        source->text = NULL;
+        FORTH_LOG(ctx, "Error reading file\n");
+        return FORTH_FAILURE;
+    }
+
+    return FORTH_SUCCESS;
+#endif
+}
+
+static void forthi_close_source(forth_context* ctx, forthi_source* source)
+{
+    if (!source->text)
+        return;
+
+#if FORTHI_HAS_MMAN
+    if (source->mapped)
+    {
+        munmap((void*)source->text, source->size);
+        return;
+    }
+#endif
+
+    forthi_free_buffer(ctx, (void*)source->text);
+}
+
+// Identifies a file with a single stat, without opening it
+static int forthi_find_file(forth_context* ctx, const char* filename, forth_included_file* file)
+{
+#if FORTHI_HAS_MMAN
+    struct stat file_stat;
+    if (stat(filename, &file_stat) != 0)
+    {
+        FORTH_LOG(ctx, "No such file or directory\n");
+        return FORTH_FAILURE;
+    }
 
-        fseek(file, 0, SEEK_END);
-        size_t file_size = (size_t)ftell(file);
-        fseek(file, 0, SEEK_SET);
+    file->device = (uint64_t)file_stat.st_dev;
+    file->inode = (uint64_t)file_stat.st_ino;
+#else
+    file->device = 0;
+    file->inode = forthi_hash_bytes(14695981039346656037ull, filename, strlen(filename));
+#endif
+    return FORTH_SUCCESS;
+}
 
-        if (file_size == 0)
+// Child contexts also know the files their base loaded
+static int forthi_is_file_included(const forth_context* ctx, const forth_included_file* file)
+{
+    for (; ctx; ctx = ctx->parent)
+    {
+        for (int i = 0; i < ctx->included_files_pointer; i++)
         {
-            fclose(file);
-            return FORTH_SUCCESS; // Nothing to load, its a success nothing gets copied
+            if (ctx->included_files[i].inode == file->inode && ctx->included_files[i].device == file->device)
+                return 1;
         }
+    }
+
+    return 0;
+}
+
+static int forthi_add_included_file(forth_context* ctx, const forth_included_file* file)
+{
+    if (forthi_is_file_included(ctx, file))
+        return FORTH_SUCCESS;
 
-        char* file_content = (char*)malloc(file_size + 1);
-        if (!file_content)
+    if (ctx->included_files_pointer == ctx->included_files_size)
+    {
+        int new_size = ctx->included_files_size ? ctx->included_files_size * 2 : 16;
+        forth_included_file* new_files = (forth_included_file*)forthi_realloc_buffer(ctx, ctx->included_files,
+            sizeof(forth_included_file) * ctx->included_files_size, sizeof(forth_included_file) * new_size);
+        if (!new_files)
         {
-            fclose(file);
             FORTH_LOG(ctx, "Out of memory\n");
             return FORTH_FAILURE;
         }
-        size_t byte_read = fread(file_content, 1, file_size, file);
-        file_content[file_size] = '\0';
-        fclose(file);
 
-        if (byte_read != file_size)
+        ctx->included_files = new_files;
+        ctx->included_files_size = new_size;
+    }
+
+    ctx->included_files[ctx->included_files_pointer++] = *file;
+    return FORTH_SUCCESS;
+}
+
+static int forthi_include_file(forth_context* ctx, const char* filename)
+{
+    forthi_source source;
+    if (forthi_open_source(ctx, filename, &source) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    // Marked before it runs, so files requiring each other don't loop
+    if (forthi_add_included_file(ctx, &source.file) == FORTH_FAILURE)
+    {
+        forthi_close_source(ctx, &source);
+        return FORTH_FAILURE;
+    }
+
+    if (source.size == 0)
+        return FORTH_SUCCESS; // Nothing to load, its a success nothing gets copied
+
+    // Child contexts would depend on their base too, they don't cache
+    char cache_path[FORTHI_INCLUDE_CACHE_PATH_SIZE];
+    uint8_t use_cache = ctx->include_cache_dir && !ctx->parent &&
+        forthi_include_cache_path(ctx, filename, cache_path, sizeof(cache_path)) == FORTH_SUCCESS;
+    uint64_t content_hash = 0;
+    uint64_t state_hash = 0;
+    if (use_cache)
+    {
+        content_hash = forthi_hash_bytes(14695981039346656037ull, source.text, source.size);
+        state_hash = forthi_hash_include_state(ctx);
+        if (forthi_load_include_cache(ctx, cache_path, content_hash, state_hash) == FORTH_SUCCESS)
         {
-            free(file_content);
-            FORTH_LOG(ctx, "Error reading file\n");
-            return FORTH_FAILURE;
+            forthi_close_source(ctx, &source);
+            ctx->include_cache_hits++;
+            return FORTH_SUCCESS;
         }
-        
-        const char* previous_code = ctx->code;
+    }
 
-        int result = forth_eval(ctx, file_content);
-        
-        free(file_content);
-        ctx->code = previous_code;
+    forth_pointer memory_pointer = ctx->memory_pointer;
+    int dict_pointer = ctx->dict_pointer;
+    int fn_offsets_pointer = ctx->fn_offsets_pointer;
+    uint8_t outer_effects = ctx->include_effects;
+    ctx->include_effects = 0;
+
+    int result = forthi_eval(ctx, source.text, source.size);
+
+    if (use_cache && result == FORTH_SUCCESS && !ctx->include_effects && ctx->state == FORTHI_STATE_INTERPRET)
+        forthi_save_include_cache(ctx, cache_path, content_hash, state_hash, 
+            memory_pointer, dict_pointer, fn_offsets_pointer);
+    ctx->include_effects |= outer_effects;
+
+    forthi_close_source(ctx, &source);
+
+    return result;
+}
+
+// Copies a file name to a null terminated buffer of FORTHI_FILENAME_SIZE
+static int forthi_copy_filename(forth_context* ctx, const char* name, size_t len, char* filename)
+{
+    if (!name || len == 0 || len >= FORTHI_FILENAME_SIZE)
+    {
+        FORTH_LOG(ctx, "No such file or directory\n");
+        return FORTH_FAILURE;
+    }
+
+    memcpy(filename, name, len);
+    filename[len] = '\0';
+    return FORTH_SUCCESS;
+}
 
-        return result;
+// The file name following INCLUDE or REQUIRE
+static int forthi_parse_filename(forth_context* ctx, char* filename)
+{
+    if (ctx->state != FORTHI_STATE_INTERPRET)
+    {
+        FORTH_LOG(ctx, "Interpret-only word\n");
+        return FORTH_FAILURE;
     }
 
-    FORTH_LOG(ctx, "Interpret-only word\n");
-    return FORTH_FAILURE;
+    size_t len;
+    const char* name = forthi_get_next_token(ctx, &len);
+    return forthi_copy_filename(ctx, name, len, filename);
+}
+
+// The ( c-addr u ) file name given to INCLUDED or REQUIRED
+static int forthi_pop_filename(forth_context* ctx, char* filename)
+{
+    if (forthi_pop(ctx, 2) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    forth_pointer at = ctx->stack[ctx->stack_pointer].pointer_value;
+    size_t len = (size_t)ctx->stack[ctx->stack_pointer + 1].uint_value;
+    if (len > 0 && forthi_check_valid_memory_range(ctx, at, (forth_pointer)len) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    return forthi_copy_filename(ctx, len > 0 ? (const char*)forthi_memory_at(ctx, at) : NULL, len, filename);
+}
+
+static int forthi_require_file(forth_context* ctx, const char* filename)
+{
+    forth_included_file file;
+    if (forthi_find_file(ctx, filename, &file) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    if (forthi_is_file_included(ctx, &file))
+        return FORTH_SUCCESS;
+
+    return forthi_include_file(ctx, filename);
+}
+
+static int forthi_word_INCLUDE(forth_context* ctx)
+{
+    char filename[FORTHI_FILENAME_SIZE];
+    if (forthi_parse_filename(ctx, filename) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    return forthi_include_file(ctx, filename);
 }
 
 static int forthi_word_INCLUDE_FILE(forth_context* ctx)
@@ -3191,8 +5420,11 @@ static int forthi_word_INCLUDE_FILE(forth_context* ctx)
 
 static int forthi_word_INCLUDED(forth_context* ctx)
 {
-    FORTH_LOG(ctx, "Unimplemented\n");
-    return FORTH_FAILURE;
+    char filename[FORTHI_FILENAME_SIZE];
+    if (forthi_pop_filename(ctx, filename) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    return forthi_include_file(ctx, filename);
 }
 
 static int forthi_word_INVERT(forth_context* ctx)
@@ -3449,7 +5681,7 @@ static int forthi_word_LOOP(forth_context* ctx)
             if (forthi_check_valid_memory_range(ctx, ctx->program_pointer, sizeof(forth_pointer)) == FORTH_FAILURE)
                 return FORTH_FAILURE;
 
-            ctx->program_pointer = *(forth_pointer*)&ctx->memory[ctx->program_pointer];
+            ctx->program_pointer = *(forth_pointer*)forthi_memory_at(ctx, ctx->program_pointer);
             return FORTH_SUCCESS;
         }
 
@@ -3486,8 +5718,74 @@ static int forthi_word_m_plus(forth_context* ctx)
 
 static int forthi_word_MARKER(forth_context* ctx)
 {
-    FORTH_LOG(ctx, "Unimplemented\n");
-    return FORTH_FAILURE;
+    if (ctx->state != FORTHI_STATE_INTERPRET)
+    {
+        FORTH_LOG(ctx, "Interpret-only word\n");
+        return FORTH_FAILURE;
+    }
+
+    size_t word_name_len;
+    const char* word_name = forthi_get_next_token(ctx, &word_name_len);
+    if (!word_name || !word_name_len)
+    {
+        FORTH_LOG(ctx, "Expected name after 'MARKER'\n");
+        return FORTH_FAILURE;
+    }
+
+    // The marker's code holds the snapshot to go back to, which is the state
+    // right before the marker itself was defined
+    forth_pointer memory_pointer = ctx->memory_pointer;
+    int dict_pointer = ctx->dict_pointer;
+
+    if (forthi_add_word(ctx, word_name, (int)word_name_len, memory_pointer) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    if (forthi_write_byte(ctx, FORTHI_INST_EXECUTE) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    if (forthi_write_byte(ctx, FORTHI_INST_CALL_C_FUNCTION) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    if (forthi_write_function(ctx, forthi_word_marker_restore) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    if (forthi_write_pointer(ctx, memory_pointer) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    return forthi_write_pointer(ctx, (forth_pointer)dict_pointer);
+}
+
+// Rewinds to the marker that ran, once nothing runs the code it removes
+static void forthi_apply_marker(forth_context* ctx)
+{
+    if (!ctx->marker_pending)
+        return;
+
+    ctx->marker_pending = 0;
+    forthi_rewind(ctx, ctx->marker_dict_pointer, ctx->marker_memory_pointer);
+}
+
+static int forthi_word_marker_restore(forth_context* ctx)
+{
+    forth_pointer memory_pointer;
+    forth_pointer dict_pointer;
+
+    if (forthi_read_pointer(ctx, &memory_pointer) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    if (forthi_read_pointer(ctx, &dict_pointer) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    // The words calling the marker may be removed too, they still have to
+    // return through their code. The earliest marker wins.
+    if (!ctx->marker_pending || (int)dict_pointer < ctx->marker_dict_pointer)
+    {
+        ctx->marker_pending = 1;
+        ctx->marker_dict_pointer = (int)dict_pointer;
+        ctx->marker_memory_pointer = memory_pointer;
+    }
+
+    return forthi_word_semicolon(ctx);
 }
 
 static int forthi_word_MAX(forth_context* ctx)
@@ -3581,92 +5879,149 @@ static int forthi_word_n_r_from(forth_context* ctx)
     return FORTH_FAILURE;
 }
 
-static int forthi_word_NUMBER(forth_context* ctx)
+// Value of a digit in any base up to 36, or 255 if it isn't one
+static uint32_t forthi_digit_value(char c)
 {
-    if (ctx->token_len == 0 || ctx->token == NULL)
+    uint32_t digit = (uint32_t)(uint8_t)c - '0';
+    if (digit < 10)
+        return digit;
+
+    digit = ((uint32_t)(uint8_t)c | 0x20) - 'a';
+    return digit < 26 ? digit + 10 : 255;
+}
+
+// Parses a number like the standard's text interpreter: a 'c' character, or
+// an optional #, $ or % base prefix, an optional minus sign, digits in that 
+// base and a trailing dot for double cell numbers. 0x is also accepted in 
+// hexadecimal. Digits are accumulated as they're checked, in a single pass 
+// that never reads past len.
+static int forthi_parse_number(forth_context* ctx, const char* text, size_t len, 
+                               forth_double_length_uint* number, uint8_t* negative, uint8_t* is_double)
+{
+    *negative = 0;
+    *is_double = 0;
+
+    if (len == 3 && text[0] == '\'' && text[2] == '\'')
     {
-        FORTH_LOG(ctx, "Invalid memory\n");
-        return FORTH_FAILURE;
+        *number = (forth_double_length_uint)(uint8_t)text[1];
+        return FORTH_SUCCESS;
     }
 
     forth_int base;
     if (forthi_read_number_at(ctx, &base, ctx->base) == FORTH_FAILURE)
         return FORTH_FAILURE;
 
-    forth_int number;
-
-    forth_int sign = 1;
-    if (ctx->token[0] == '-')
+    size_t i = 0;
+    if (len > 0)
     {
-        sign = -1;
-        ctx->token++;
-        ctx->token_len--;
+        switch (text[0])
+        {
+            case '#': base = 10; i++; break;
+            case '$': base = 16; i++; break;
+            case '%': base = 2; i++; break;
+        }
     }
 
-    if (base == 10)
+    if (base < 2 || base > 36)
     {
-        for (size_t i = 0; i < ctx->token_len; i++)
-        {
-            char c = ctx->token[i];
-            if (c < '0' || c > '9')
-            {
-                FORTH_LOG(ctx, "Undefined word\n");
-                return FORTH_FAILURE;
-            }
-        }
-
-        number = (forth_int)atoi(ctx->token);
+        FORTH_LOG(ctx, "Unsupported base\n");
+        return FORTH_FAILURE;
     }
-    else if (base == 8)
+
+    *negative = i < len && text[i] == '-';
+    i += *negative;
+
+    if (base == 16 && len - i > 2 && text[i] == '0' && (text[i + 1] | 0x20) == 'x')
+        i += 2;
+
+    // A trailing dot makes it a double cell number
+    if (len > i + 1 && text[len - 1] == '.')
     {
-        for (size_t i = 0; i < ctx->token_len; i++)
-        {
-            char c = ctx->token[i];
-            if (c < '0' || c > '7')
-            {
-                FORTH_LOG(ctx, "Undefined word\n");
-                return FORTH_FAILURE;
-            }
-        }
+        *is_double = 1;
+        len--;
+    }
 
-        number = (forth_int)strtol(ctx->token, NULL, 8);
+    if (i == len)
+    {
+        FORTH_LOG(ctx, "Undefined word\n");
+        return FORTH_FAILURE;
     }
-    else if (base == 16)
+
+    // Checked against the largest value before each digit is added, 
+    // without dividing in the loop
+    const forth_double_length_uint max = *is_double ? (forth_double_length_uint)-1 : 
+                                                      (forth_double_length_uint)(forth_uint)-1;
+    const forth_double_length_uint cutoff = max / (forth_double_length_uint)base;
+    const uint32_t cutoff_digit = (uint32_t)(max % (forth_double_length_uint)base);
+
+    forth_double_length_uint magnitude = 0;
+    for (; i < len; i++)
     {
-        if (ctx->token_len > 2 && ctx->token[0] == '0' && toupper(ctx->token[1]) == 'X')
+        uint32_t digit = forthi_digit_value(text[i]);
+        if (digit >= (uint32_t)base)
         {
-            ctx->token += 2;
-            ctx->token_len -= 2;
+            FORTH_LOG(ctx, "Undefined word\n");
+            return FORTH_FAILURE;
         }
 
-        for (size_t i = 0; i < ctx->token_len; i++)
+        if (magnitude > cutoff || (magnitude == cutoff && digit > cutoff_digit))
         {
-            char c = ctx->token[i];
-            if ((c < '0' || c > '9') &&
-                (toupper(c) < 'A' || toupper(c) > 'F'))
-            {
-                FORTH_LOG(ctx, "Undefined word\n");
-                return FORTH_FAILURE;
-            }
+            FORTH_LOG(ctx, "Number out of range\n");
+            return FORTH_FAILURE;
         }
+        magnitude = magnitude * (forth_double_length_uint)base + digit;
+    }
 
-        number = (forth_int)strtol(ctx->token, NULL, 16);
+    // Negative numbers go one further than positive signed ones
+    if (*negative && magnitude > (max >> 1) + 1)
+    {
+        FORTH_LOG(ctx, "Number out of range\n");
+        return FORTH_FAILURE;
     }
-    else
+
+    *number = *negative ? (forth_double_length_uint)0 - magnitude : magnitude;
+    return FORTH_SUCCESS;
+}
+
+static int forthi_word_NUMBER(forth_context* ctx)
+{
+    if (ctx->token_len == 0 || ctx->token == NULL)
     {
-        FORTH_LOG(ctx, "Unsupported base\n");
+        FORTH_LOG(ctx, "Invalid memory\n");
         return FORTH_FAILURE;
     }
 
-    number *= sign;
+    forth_double_length_uint number;
+    uint8_t negative;
+    uint8_t is_double;
+    if (forthi_parse_number(ctx, ctx->token, ctx->token_len, &number, &negative, &is_double) == FORTH_FAILURE)
+        return FORTH_FAILURE;
 
-    if (ctx->state == FORTHI_STATE_INTERPRET)
-        return forthi_push_int_number(ctx, number);
-    else if (ctx->state == FORTHI_STATE_COMPILE)
-        return forthi_compile_push_int_number(ctx, number);
-    
-    FORTH_LOG(ctx, "Undefined word\n");
-    return FORTH_FAILURE;
+    if (ctx->state != FORTHI_STATE_INTERPRET && ctx->state != FORTHI_STATE_COMPILE)
+    {
+        FORTH_LOG(ctx, "Undefined word\n");
+        return FORTH_FAILURE;
+    }
+
+    forth_uint cells[2];
+    cells[0] = (forth_uint)number;
+#if FORTH_INT_SIZE_64_BITS
+    // There is no 128 bits maths, the high cell only carries the sign
+    cells[1] = negative && number != 0 ? (forth_uint)-1 : 0;
+#else
+    cells[1] = (forth_uint)(number >> (sizeof(forth_uint) * 8));
+#endif
+
+    for (int i = 0; i < 1 + is_double; i++)
+    {
+        int result = ctx->state == FORTHI_STATE_INTERPRET ? 
+            forthi_push_uint_number(ctx, cells[i]) :
+            forthi_compile_push_int_number(ctx, (forth_int)cells[i]);
+        if (result == FORTH_FAILURE)
+            return FORTH_FAILURE;
+    }
+
+    return FORTH_SUCCESS;
 }
 
 static int forthi_word_OCTAL(forth_context* ctx)
@@ -3721,8 +6076,10 @@ static int forthi_word_OVER(forth_context* ctx)
 
 static int forthi_word_PAD(forth_context* ctx)
 {
-    FORTH_LOG(ctx, "Unimplemented\n");
-    return FORTH_FAILURE;
+    if (!ctx->pad && forthi_transient_alloc(ctx, FORTHI_PAD_SIZE, &ctx->pad) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    return forthi_push_pointer(ctx, ctx->pad);
 }
 
 static int forthi_word_PAGE(forth_context* ctx)
@@ -3733,8 +6090,29 @@ static int forthi_word_PAGE(forth_context* ctx)
 
 static int forthi_word_PARSE(forth_context* ctx)
 {
-    FORTH_LOG(ctx, "Unimplemented\n");
-    return FORTH_FAILURE;
+    if (forthi_pop(ctx, 1) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    char delim = (char)ctx->stack[ctx->stack_pointer].int_value;
+
+    // Skip the space after PARSE
+    if (ctx->code < ctx->code_end)
+        ctx->code++;
+
+    const char* string_start = ctx->code;
+    const char* string_end = forthi_read_until(ctx, delim);
+
+    if (ctx->code < ctx->code_end)
+        ctx->code++;
+
+    size_t len = string_end - string_start;
+    forth_pointer at;
+    if (forthi_transient_copy(ctx, string_start, len, &at) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    if (forthi_push_pointer(ctx, at) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+    return forthi_push_int_number(ctx, (forth_int)len);
 }
 
 static int forthi_word_PARSE_NAME(forth_context* ctx)
@@ -3818,8 +6196,12 @@ static int forthi_word_RECURSE(forth_context* ctx)
 
 static int forthi_word_REFILL(forth_context* ctx)
 {
-    FORTH_LOG(ctx, "Unimplemented\n");
-    return FORTH_FAILURE;
+    // Strings have nothing more to give
+    int refilled = forthi_refill(ctx);
+    if (refilled < 0)
+        return FORTH_FAILURE;
+
+    return forthi_push_int_number(ctx, refilled ? FORTH_TRUE : FORTH_FALSE);
 }
 
 static int forthi_word_RENAME_FILE(forth_context* ctx)
@@ -3850,7 +6232,7 @@ static int forthi_word_REPEAT(forth_context* ctx)
         if (forthi_check_valid_memory_range(ctx, while_pointer, sizeof(forth_pointer)) == FORTH_FAILURE)
             return FORTH_FAILURE;
 
-        *(forth_pointer*)&ctx->memory[while_pointer] = ctx->memory_pointer;
+        *(forth_pointer*)forthi_memory_at(ctx, while_pointer) = ctx->memory_pointer;
 
         return FORTH_SUCCESS;
     }
@@ -3888,20 +6270,37 @@ static int forthi_word_REPRESENT(forth_context* ctx)
 
 static int forthi_word_REQUIRE(forth_context* ctx)
 {
-    FORTH_LOG(ctx, "Unimplemented\n");
-    return FORTH_FAILURE;
+    char filename[FORTHI_FILENAME_SIZE];
+    if (forthi_parse_filename(ctx, filename) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    return forthi_require_file(ctx, filename);
 }
 
 static int forthi_word_REQUIRED(forth_context* ctx)
 {
-    FORTH_LOG(ctx, "Unimplemented\n");
-    return FORTH_FAILURE;
+    char filename[FORTHI_FILENAME_SIZE];
+    if (forthi_pop_filename(ctx, filename) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    return forthi_require_file(ctx, filename);
 }
 
 static int forthi_word_RESIZE(forth_context* ctx)
 {
-    FORTH_LOG(ctx, "Unimplemented\n");
-    return FORTH_FAILURE;
+    if (forthi_pop(ctx, 2) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    forth_pointer at = ctx->stack[ctx->stack_pointer].pointer_value;
+    forth_uint size = ctx->stack[ctx->stack_pointer + 1].uint_value;
+
+    // On failure, the original block is left untouched
+    forth_pointer new_at = at;
+    int ior = forthi_heap_resize(ctx, at, size, &new_at) == FORTH_SUCCESS ? 0 : FORTHI_IOR_RESIZE;
+
+    if (forthi_push_pointer(ctx, new_at) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+    return forthi_push_int_number(ctx, ior);
 }
 
 static int forthi_word_RESIZE_FILE(forth_context* ctx)
@@ -3912,8 +6311,28 @@ static int forthi_word_RESIZE_FILE(forth_context* ctx)
 
 static int forthi_word_RESTORE_INPUT(forth_context* ctx)
 {
-    FORTH_LOG(ctx, "Unimplemented\n");
-    return FORTH_FAILURE;
+    if (forthi_pop(ctx, 1) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    forth_int count = ctx->stack[ctx->stack_pointer].int_value;
+    if (count < 0 || count > ctx->stack_pointer)
+    {
+        FORTH_LOG(ctx, "Stack underflow\n");
+        return FORTH_FAILURE;
+    }
+    forthi_pop(ctx, (int)count);
+
+    // Only positions in the current input buffer can be restored
+    const forth_cell* saved = &ctx->stack[ctx->stack_pointer];
+    size_t len = (size_t)(ctx->code_end - ctx->input.source);
+    uint8_t restored = count == 3 && 
+        saved[2].int_value == (forth_int)ctx->input.id &&
+        saved[1].int_value == (forth_int)ctx->input.line &&
+        (size_t)(forth_uint)saved[0].int_value <= len;
+    if (restored)
+        ctx->code = ctx->input.source + (forth_uint)saved[0].int_value;
+
+    return forthi_push_int_number(ctx, restored ? FORTH_FALSE : FORTH_TRUE);
 }
 
 static int forthi_word_ROLL(forth_context* ctx)
@@ -3946,8 +6365,45 @@ static int forthi_word_r_shift(forth_context* ctx)
 
 static int forthi_word_s_quote(forth_context* ctx)
 {
-    FORTH_LOG(ctx, "Unimplemented\n");
-    return FORTH_FAILURE;
+    // Compiled strings are kept with the code
+    if (ctx->state == FORTHI_STATE_EXECUTE)
+    {
+        forth_int len;
+        if (forthi_read_number(ctx, &len) == FORTH_FAILURE)
+            return FORTH_FAILURE;
+
+        forth_pointer at = ctx->program_pointer;
+        if (forthi_check_valid_memory_range(ctx, at, (forth_pointer)len) == FORTH_FAILURE)
+            return FORTH_FAILURE;
+        ctx->program_pointer += (forth_pointer)len;
+
+        if (forthi_push_pointer(ctx, at) == FORTH_FAILURE)
+            return FORTH_FAILURE;
+        return forthi_push_int_number(ctx, len);
+    }
+
+    if (ctx->code < ctx->code_end)
+        ctx->code++;
+
+    const char* string_start = ctx->code;
+    const char* string_end = forthi_read_until(ctx, '\"');
+
+    if (ctx->code < ctx->code_end)
+        ctx->code++;
+
+    size_t len = string_end - string_start;
+
+    if (ctx->state == FORTHI_STATE_COMPILE)
+        return forthi_write_text(ctx, string_start, len);
+
+    // Interpreted strings only live until the next evaluation
+    forth_pointer at;
+    if (forthi_transient_copy(ctx, string_start, len, &at) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    if (forthi_push_pointer(ctx, at) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+    return forthi_push_int_number(ctx, (forth_int)len);
 }
 
 static int forthi_word_s_to_d(forth_context* ctx)
@@ -3970,8 +6426,14 @@ static int forthi_word_SAVE_BUFFERS(forth_context* ctx)
 
 static int forthi_word_SAVE_INPUT(forth_context* ctx)
 {
-    FORTH_LOG(ctx, "Unimplemented\n");
-    return FORTH_FAILURE;
+    if (forthi_push_int_number(ctx, (forth_int)(ctx->code - ctx->input.source)) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+    if (forthi_push_int_number(ctx, (forth_int)ctx->input.line) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+    if (forthi_push_int_number(ctx, (forth_int)ctx->input.id) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    return forthi_push_int_number(ctx, 3);
 }
 
 static int forthi_word_s_c_r(forth_context* ctx)
@@ -4060,8 +6522,13 @@ static int forthi_word_s_floats(forth_context* ctx)
 
 static int forthi_word_SIGN(forth_context* ctx)
 {
-    FORTH_LOG(ctx, "Unimplemented\n");
-    return FORTH_FAILURE;
+    if (forthi_pop(ctx, 1) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    if (ctx->stack[ctx->stack_pointer].int_value < 0)
+        return forthi_hold(ctx, '-');
+
+    return FORTH_SUCCESS;
 }
 
 static int forthi_word_SLITERAL(forth_context* ctx)
@@ -4078,8 +6545,16 @@ static int forthi_word_s_m_slash_rem(forth_context* ctx)
 
 static int forthi_word_SOURCE(forth_context* ctx)
 {
-    FORTH_LOG(ctx, "Unimplemented\n");
-    return FORTH_FAILURE;
+    // The code isn't in the data space, it is copied once per input buffer
+    size_t len = (size_t)(ctx->code_end - ctx->input.source);
+    if (!ctx->input.source_copy && 
+        forthi_transient_copy(ctx, ctx->input.source, len, &ctx->input.source_copy) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    if (forthi_push_pointer(ctx, ctx->input.source_copy) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    return forthi_push_int_number(ctx, (forth_int)len);
 }
 
 static int forthi_word_source_i_d(forth_context* ctx)
@@ -4161,7 +6636,7 @@ static int forthi_word_THEN(forth_context* ctx)
         if (forthi_check_valid_memory_range(ctx, if_else_branch_pointer, sizeof(forth_pointer)) == FORTH_FAILURE)
             return FORTH_FAILURE;
 
-        *(forth_pointer*)&ctx->memory[if_else_branch_pointer] = ctx->memory_pointer;
+        *(forth_pointer*)forthi_memory_at(ctx, if_else_branch_pointer) = ctx->memory_pointer;
 
         return FORTH_SUCCESS;
     }
@@ -4371,7 +6846,7 @@ static int forthi_word_UNTIL(forth_context* ctx)
             if (forthi_check_valid_memory_range(ctx, ctx->program_pointer, sizeof(forth_pointer)) == FORTH_FAILURE)
                 return FORTH_FAILURE;
 
-            ctx->program_pointer = *(forth_pointer*)&ctx->memory[ctx->program_pointer];
+            ctx->program_pointer = *(forth_pointer*)forthi_memory_at(ctx, ctx->program_pointer);
             return FORTH_SUCCESS;
         }
 
@@ -4472,8 +6947,43 @@ static int forthi_word_WITHIN(forth_context* ctx)
 
 static int forthi_word_WORD(forth_context* ctx)
 {
-    FORTH_LOG(ctx, "Unimplemented\n");
-    return FORTH_FAILURE;
+    if (forthi_pop(ctx, 1) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    char delim = (char)ctx->stack[ctx->stack_pointer].int_value;
+
+    // Skip the space after WORD, then leading delimiters. Spaces also skip
+    // tabs and new lines.
+    if (ctx->code < ctx->code_end)
+        ctx->code++;
+    while (ctx->code < ctx->code_end && (*ctx->code == delim || (delim == ' ' && forthi_is_space(*ctx->code))))
+        ctx->code++;
+
+    const char* string_start = ctx->code;
+    while (ctx->code < ctx->code_end && *ctx->code != delim && !(delim == ' ' && forthi_is_space(*ctx->code)))
+        ctx->code++;
+    const char* string_end = ctx->code;
+
+    if (ctx->code < ctx->code_end)
+        ctx->code++;
+
+    size_t len = string_end - string_start;
+    if (len > FORTHI_COUNTED_STRING_MAX_LEN)
+    {
+        FORTH_LOG(ctx, "Parsed string overflow\n");
+        return FORTH_FAILURE;
+    }
+
+    // Counted string
+    forth_pointer at;
+    if (forthi_transient_alloc(ctx, (forth_pointer)len + 1, &at) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    uint8_t* text = forthi_memory_at(ctx, at);
+    text[0] = (uint8_t)len;
+    memcpy(text + 1, string_start, len);
+
+    return forthi_push_pointer(ctx, at);
 }
 
 static int forthi_word_WORDLIST(forth_context* ctx)
@@ -4672,458 +7182,469 @@ static int forthi_word_brace_colon(forth_context* ctx)
 // INIT AND SHUTDOWN
 //---------------------------------------------------------------------------
 
+// Registered by name so images can find them again
+static const forth_c_word forthi_standard_words[] = 
+{
+    {"!", forthi_word_store},
+    {"#", forthi_word_number_sign},
+    {"#>", forthi_word_number_sign_greater},
+    {"#S", forthi_word_number_sign_s},
+    {"'", forthi_word_tick},
+    {"(", forthi_word_paren},
+    {"(LOCAL)", forthi_word_paren_local_paren},
+    {"*", forthi_word_star},
+    {"*/", forthi_word_star_slash},
+    {"*/MOD", forthi_word_star_slash_mod},
+    {"+", forthi_word_plus},
+    {"+!", forthi_word_plus_store},
+    {"+FIELD", forthi_word_plus_field},
+    {"+LOOP", forthi_word_plus_loop},
+    {"/LOOP", forthi_word_slash_loop},
+    {"+X/STRING", forthi_word_plus_x_string},
+    {",", forthi_word_comma},
+    {"-", forthi_word_minus},
+    {"-TRAILING", forthi_word_dash_trailing},
+    {"-TRAILING-GARBAGE", forthi_word_dash_trailing_garbage},
+    {".", forthi_word_dot},
+    {".\"", forthi_word_dot_quote},
+    {".(", forthi_word_dot_paren},
+    {".R", forthi_word_dot_r},
+    {".S", forthi_word_dot_s},
+    {"/", forthi_word_slash},
+    {"/MOD", forthi_word_slash_mod},
+    {"/STRING", forthi_word_slash_string},
+    {"0<", forthi_word_zero_less},
+    {"0<>", forthi_word_zero_not_equals},
+    {"0=", forthi_word_zero_equals},
+    {"0>", forthi_word_zero_greater},
+    {"1+", forthi_word_one_plus},
+    {"1-", forthi_word_one_minus},
+    {"2+", forthi_word_two_plus},
+    {"2-", forthi_word_two_minus},
+    {"2!", forthi_word_two_store},
+    {"2*", forthi_word_two_star},
+    {"2/", forthi_word_two_slash},
+    {"2>R", forthi_word_two_to_r},
+    {"2@", forthi_word_two_fetch},
+    {"2CONSTANT", forthi_word_two_constant},
+    {"2DROP", forthi_word_two_drop},
+    {"2DUP", forthi_word_two_dupe},
+    {"2LITERAL", forthi_word_two_literal},
+    {"2OVER", forthi_word_two_over},
+    {"2R>", forthi_word_two_r_from},
+    {"2R@", forthi_word_two_r_fetch},
+    {"2ROT", forthi_word_two_rote},
+    {"2SWAP", forthi_word_two_swap},
+    {"2VALUE", forthi_word_two_value},
+    {"2VARIABLE", forthi_word_two_variable},
+    {":", forthi_word_colon},
+    {":NONAME", forthi_word_colon_no_name},
+    {";", forthi_word_semicolon},
+    {";CODE", forthi_word_semicolon_code},
+    {"<", forthi_word_less_than},
+    {"<#", forthi_word_less_number_sign},
+    {"<>", forthi_word_not_equals},
+    {"=", forthi_word_equals},
+    {">", forthi_word_greater_than},
+    {">BODY", forthi_word_to_body},
+    {">FLOAT", forthi_word_to_float},
+    {">IN", forthi_word_to_in},
+    {">NUMBER", forthi_word_to_number},
+    {">R", forthi_word_to_r},
+    {"?", forthi_word_question},
+    {"?DO", forthi_word_question_do},
+    {"?DUP", forthi_word_question_dupe},
+    {"@", forthi_word_fetch},
+    {"ABORT", forthi_word_ABORT},
+    {"ABORT\"", forthi_word_abort_quote},
+    {"ABS", forthi_word_abs},
+    {"ACCEPT", forthi_word_ACCEPT},
+    {"ACTION-OF", forthi_word_ACTION_OF},
+    {"AGAIN", forthi_word_AGAIN},
+    {"AHEAD", forthi_word_AHEAD},
+    {"ALIGN", forthi_word_ALIGN},
+    {"ALIGNED", forthi_word_ALIGNED},
+    {"ALLOCATE", forthi_word_ALLOCATE},
+    {"ALLOT", forthi_word_ALLOT},
+    {"ALSO", forthi_word_ALSO},
+    {"AND", forthi_word_AND},
+    {"ASSEMBLER", forthi_word_ASSEMBLER},
+    {"AT-XY", forthi_word_at_x_y},
+    {"BASE", forthi_word_BASE},
+    {"BEGIN", forthi_word_BEGIN},
+    {"BEGIN-STRUCTURE", forthi_word_BEGIN_STRUCTURE},
+    {"BIN", forthi_word_BIN},
+    {"BL", forthi_word_b_l},
+    {"BLANK", forthi_word_BLANK},
+    {"BLK", forthi_word_b_l_k},
+    {"BLOCK", forthi_word_BLOCK},
+    {"BUFFER", forthi_word_BUFFER},
+    {"BUFFER:", forthi_word_buffer_colon},
+    {"BYE", forthi_word_BYE},
+    {"C!", forthi_word_c_store},
+    {"C\"", forthi_word_c_quote},
+    {"C,", forthi_word_c_comma},
+    {"C@", forthi_word_c_fetch},
+    {"CASE", forthi_word_CASE},
+    {"CATCH", forthi_word_CATCH},
+    {"CELL+", forthi_word_cell_plus},
+    {"CELLS", forthi_word_CELLS},
+    {"CFIELD:", forthi_word_c_field_colon},
+    {"CHAR", forthi_word_char},
+    {"CHAR+", forthi_word_char_plus},
+    {"CHARS", forthi_word_chars},
+    {"CLOSE-FILE", forthi_word_CLOSE_FILE},
+    {"CMOVE", forthi_word_c_move},
+    {"CMOVE>", forthi_word_c_move_up},
+    {"CODE", forthi_word_CODE},
+    {"COMPARE", forthi_word_COMPARE},
+    {"COMPILE,", forthi_word_compile_comma},
+    {"CONSTANT", forthi_word_CONSTANT},
+    {"COUNT", forthi_word_COUNT},
+    {"CR", forthi_word_c_r},
+    {"CREATE", forthi_word_CREATE},
+    {"CREATE-FILE", forthi_word_CREATE_FILE},
+    {"CS-PICK", forthi_word_c_s_pick},
+    {"CS-ROLL", forthi_word_c_s_roll},
+    {"D+", forthi_word_d_plus},
+    {"D-", forthi_word_d_minus},
+    {"D.", forthi_word_d_dot},
+    {"D.R", forthi_word_d_dot_r},
+    {"D0<", forthi_word_d_zero_less},
+    {"D0=", forthi_word_d_zero_equals},
+    {"D2*", forthi_word_d_two_star},
+    {"D2/", forthi_word_d_two_slash},
+    {"D<", forthi_word_d_less_than},
+    {"D=", forthi_word_d_equals},
+    {"D>F", forthi_word_d_to_f},
+    {"D>S", forthi_word_d_to_s},
+    {"DABS", forthi_word_d_abs},
+    {"DECIMAL", forthi_word_DECIMAL},
+    {"DEFER", forthi_word_DEFER},
+    {"DEFER!", forthi_word_defer_store},
+    {"DEFER@", forthi_word_defer_fetch},
+    {"DEFINITIONS", forthi_word_DEFINITIONS},
+    {"DELETE-FILE", forthi_word_DELETE_FILE},
+    {"DEPTH", forthi_word_DEPTH},
+    {"DF!", forthi_word_d_f_store},
+    {"DF@", forthi_word_d_f_fetch},
+    {"DFALIGN", forthi_word_d_f_align},
+    {"DFALIGNED", forthi_word_d_f_aligned},
+    {"DFFIELD:", forthi_word_d_f_field_colon},
+    {"DFLOAT+", forthi_word_d_float_plus},
+    {"DFLOATS", forthi_word_d_floats},
+    {"DMAX", forthi_word_d_max},
+    {"DMIN", forthi_word_d_min},
+    {"DNEGATE", forthi_word_d_negate},
+    {"DO", forthi_word_DO},
+    {"DOES>", forthi_word_does},
+    {"DROP", forthi_word_DROP},
+    {"DU<", forthi_word_d_u_less},
+    {"DUMP", forthi_word_DUMP},
+    {"DUP", forthi_word_dupe},
+    {"EDITOR", forthi_word_EDITOR},
+    {"EKEY", forthi_word_e_key},
+    {"EKEY>CHAR", forthi_word_e_key_to_char},
+    {"EKEY>FKEY", forthi_word_e_key_to_f_key},
+    {"EKEY>XCHAR", forthi_word_e_key_to_x_char},
+    {"EKEY?", forthi_word_e_key_question},
+    {"ELSE", forthi_word_ELSE},
+    {"EMIT", forthi_word_EMIT},
+    {"EMIT?", forthi_word_emit_question},
+    {"EMPTY", forthi_word_EMPTY},
+    {"EMPTY-BUFFERS", forthi_word_EMPTY_BUFFERS},
+    {"END-STRUCTURE", forthi_word_END_STRUCTURE},
+    {"ENDCASE", forthi_word_end_case},
+    {"ENDOF", forthi_word_end_of},
+    {"ENVIRONMENT?", forthi_word_environment_query},
+    {"ERASE", forthi_word_ERASE},
+    {"EVALUATE", forthi_word_EVALUATE},
+    {"EXECUTE", forthi_word_EXECUTE},
+    {"EXIT", forthi_word_EXIT},
+    {"F!", forthi_word_f_store},
+    {"F*", forthi_word_f_star},
+    {"F**", forthi_word_f_star_star},
+    {"F+", forthi_word_f_plus},
+    {"F-", forthi_word_f_minus},
+    {"F.", forthi_word_f_dot},
+    {"F/", forthi_word_f_slash},
+    {"F0<", forthi_word_f_zero_less_than},
+    {"F0=", forthi_word_f_zero_equals},
+    {"F>D", forthi_word_f_to_d},
+    {"F>S", forthi_word_F_to_S},
+    {"F@", forthi_word_f_fetch},
+    {"FABS", forthi_word_f_abs},
+    {"FACOS", forthi_word_f_a_cos},
+    {"FACOSH", forthi_word_f_a_cosh},
+    {"FALIGN", forthi_word_f_align},
+    {"FALIGNED", forthi_word_f_aligned},
+    {"FALOG", forthi_word_f_a_log},
+    {"FALSE", forthi_word_FALSE},
+    {"FASIN", forthi_word_f_a_sine},
+    {"FASINH", forthi_word_f_a_cinch},
+    {"FATAN", forthi_word_f_a_tan},
+    {"FATAN2", forthi_word_f_a_tan_two},
+    {"FATANH", forthi_word_f_a_tan_h},
+    {"FCONSTANT", forthi_word_f_constant},
+    {"FCOS", forthi_word_f_cos},
+    {"FCOSH", forthi_word_f_cosh},
+    {"FDEPTH", forthi_word_f_depth},
+    {"FDROP", forthi_word_f_drop},
+    {"FDUP", forthi_word_f_dupe},
+    {"FE.", forthi_word_f_e_dot},
+    {"FEXP", forthi_word_f_e_x_p},
+    {"FEXPM1", forthi_word_f_e_x_p_m_one},
+    {"FFIELD:", forthi_word_f_field_colon},
+    {"FIELD:", forthi_word_field_colon},
+    {"FILE-POSITION", forthi_word_FILE_POSITION},
+    {"FILE-SIZE", forthi_word_FILE_SIZE},
+    {"FILE-STATUS", forthi_word_FILE_STATUS},
+    {"FILL", forthi_word_FILL},
+    {"FIND", forthi_word_FIND},
+    {"FLITERAL", forthi_word_f_literal},
+    {"FLN", forthi_word_f_l_n},
+    {"FLNP1", forthi_word_f_l_n_p_one},
+    {"FLOAT+", forthi_word_float_plus},
+    {"FLOATS", forthi_word_FLOATS},
+    {"FLOT", forthi_word_f_log},
+    {"FLOOR", forthi_word_FLOOR},
+    //{"FLUSH", forthi_word_FLUSH}, // Undefined word, block related
+    {"FLUSH-FILE", forthi_word_FLUSH_FILE},
+    {"FM/MOD", forthi_word_f_m_slash_mod},
+    {"FMAX", forthi_word_f_max},
+    {"FMIN", forthi_word_f_min},
+    {"FNEGATE", forthi_word_f_negate},
+    {"FORGET", forthi_word_FORGET},
+    {"FORTH", forthi_word_FORTH},
+    {"FORTH-WORDLIST", forthi_word_FORTH_WORDLIST},
+    {"FOVER", forthi_word_f_over},
+    {"FREE", forthi_word_FREE},
+    {"FROT", forthi_word_f_rote},
+    {"FROUND", forthi_word_f_round},
+    {"FS.", forthi_word_f_s_dot},
+    {"FSIN", forthi_word_f_sine},
+    {"FSINCOS", forthi_word_f_sine_cos},
+    {"FSINH", forthi_word_f_cinch},
+    {"FSQRT", forthi_word_f_square_root},
+    {"FSWAP", forthi_word_f_swap},
+    {"FTAN", forthi_word_f_tan},
+    {"FTANH", forthi_word_f_tan_h},
+    {"FTRUNC", forthi_word_f_trunc},
+    {"FVALUE", forthi_word_f_value},
+    {"FVARIABLE", forthi_word_f_variable},
+    {"F~", forthi_word_f_proximate},
+    {"GET-CURRENT", forthi_word_GET_CURRENT},
+    {"GET-ORDER", forthi_word_GET_ORDER},
+    {"HERE", forthi_word_HERE},
+    {"HEX", forthi_word_HEX},
+    {"HOLD", forthi_word_HOLD},
+    {"HOLDS", forthi_word_HOLDS},
+    {"I", forthi_word_I},
+    {"I'", forthi_word_i_tick},
+    {"IF", forthi_word_IF},
+    {"IMMEDIATE", forthi_word_IMMEDIATE},
+    {"INCLUDE", forthi_word_INCLUDE},
+    {"INCLUDE-FILE", forthi_word_INCLUDE_FILE},
+    {"INCLUDED", forthi_word_INCLUDED},
+    {"INVERT", forthi_word_INVERT},
+    {"IS", forthi_word_IS},
+    {"J", forthi_word_J},
+    {"K-ALT-MASK", forthi_word_K_ALT_MASK},
+    {"K-CTRL-MASK", forthi_word_K_CTRL_MASK},
+    {"K-DELETE", forthi_word_K_DELETE},
+    {"K-DOWN", forthi_word_K_DOWN},
+    {"K-END", forthi_word_K_END},
+    {"K-F1", forthi_word_k_f_1},
+    {"K-F10", forthi_word_k_f_10},
+    {"K-F11", forthi_word_k_f_11},
+    {"K-F12", forthi_word_k_f_12},
+    {"K-F2", forthi_word_k_f_2},
+    {"K-F3", forthi_word_k_f_3},
+    {"K-F4", forthi_word_k_f_4},
+    {"K-F5", forthi_word_k_f_5},
+    {"K-F6", forthi_word_k_f_6},
+    {"K-F7", forthi_word_k_f_7},
+    {"K-F8", forthi_word_k_f_8},
+    {"K-F9", forthi_word_k_f_9},
+    {"K_HOME", forthi_word_K_HOME},
+    {"K_INSERT", forthi_word_K_INSERT},
+    {"K_LEFT", forthi_word_K_LEFT},
+    {"K_NEXT", forthi_word_K_NEXT},
+    {"K_PRIOR", forthi_word_K_PRIOR},
+    {"K_RIGHT", forthi_word_K_RIGHT},
+    {"K_SHIFT_MASK", forthi_word_K_SHIFT_MASK},
+    {"K_UP", forthi_word_K_UP},
+    {"KEY", forthi_word_KEY},
+    {"KEY?", forthi_word_key_question},
+    {"LEAVE", forthi_word_LEAVE},
+    //{"LIST", forthi_word_LIST}, // Undefined word, block related
+    {"LITERAL", forthi_word_LITERAL},
+    //{"LOAD", forthi_word_LOAD}, // Undefined word, block related
+    {"LOCALS|", forthi_word_locals_bar},
+    {"LOOP", forthi_word_LOOP},
+    {"LSHIFT", forthi_word_l_shift},
+    {"M*", forthi_word_m_star},
+    {"M*/", forthi_word_m_star_slash},
+    {"M+", forthi_word_m_plus},
+    {"MARKER", forthi_word_MARKER},
+    {"MAX", forthi_word_MAX},
+    {"MIN", forthi_word_MIN},
+    {"MOD", forthi_word_MOD},
+    {"MOVE", forthi_word_MOVE},
+    {"MS", forthi_word_MS},
+    {"N>R", forthi_word_n_to_r},
+    {"NAME>COMPILE", forthi_word_name_to_compile},
+    {"NAME>INTERPRET", forthi_word_name_to_interpret},
+    {"NAME>STRING", forthi_word_name_to_string},
+    {"NEGATE", forthi_word_NEGATE},
+    {"NIP", forthi_word_NIP},
+    {"NOT", forthi_word_zero_equals}, // For convenience
+    {"NR>", forthi_word_n_r_from},
+    {"NUMBER", forthi_word_NUMBER},
+    {"OCTAL", forthi_word_OCTAL},
+    {"OF", forthi_word_OF},
+    {"ONLY", forthi_word_ONLY},
+    {"OPEN-FILE", forthi_word_OPEN_FILE},
+    {"OR", forthi_word_OR},
+    {"ORDER", forthi_word_ORDER},
+    {"OVER", forthi_word_OVER},
+    {"PAD", forthi_word_PAD},
+    {"PAGE", forthi_word_PAGE},
+    {"PARSE", forthi_word_PARSE},
+    {"PARSE-NAME", forthi_word_PARSE_NAME},
+    {"PICK", forthi_word_PICK},
+    {"POSTPONE", forthi_word_POSTPONE},
+    {"PRECISION", forthi_word_PRECISION},
+    {"PREVIOUS", forthi_word_PREVIOUS},
+    {"QUIT", forthi_word_QUIT},
+    {"R/O", forthi_word_r_o},
+    {"R/W", forthi_word_r_w},
+    {"R>", forthi_word_r_from},
+    {"R@", forthi_word_r_fetch},
+    {"READ-FILE", forthi_word_READ_FILE},
+    {"READ-LINE", forthi_word_READ_LINE},
+    {"RECURSE", forthi_word_RECURSE},
+    {"REFILL", forthi_word_REFILL},
+    {"RENAME_FILE", forthi_word_RENAME_FILE},
+    {"REPEAT", forthi_word_REPEAT},
+    {"REPLACES", forthi_word_REPLACES},
+    {"REPOSITION-FILE", forthi_word_REPOSITION_FILE},
+    {"REPRESENT", forthi_word_REPRESENT},
+    {"REQUIRE", forthi_word_REQUIRE},
+    {"REQUIRED", forthi_word_REQUIRED},
+    {"RESIZE", forthi_word_RESIZE},
+    {"RESIZE-FILE", forthi_word_RESIZE_FILE},
+    {"RESTORE-INPUT", forthi_word_RESTORE_INPUT},
+    {"ROLL", forthi_word_ROLL},
+    {"ROT", forthi_word_rote},
+    {"RSHIFT", forthi_word_r_shift},
+    {"S\"", forthi_word_s_quote},
+    {"S>D", forthi_word_s_to_d},
+    {"S>F", forthi_word_s_to_F},
+    {"SAVE-BUFFERS", forthi_word_SAVE_BUFFERS},
+    {"SAVE-INPUT", forthi_word_SAVE_INPUT},
+    {"SCR", forthi_word_s_c_r},
+    {"SEARCH", forthi_word_SEARCH},
+    {"SEARCH-WORDLIST", forthi_word_SEARCH_WORDLIST},
+    {"SEE", forthi_word_SEE},
+    {"SET-CURRENT", forthi_word_SET_CURRENT},
+    {"SET-ORDER", forthi_word_SET_ORDER},
+    {"SET-PRECISION", forthi_word_SET_PRECISION},
+    {"SF!", forthi_word_s_f_store},
+    {"SF@", forthi_word_s_f_fetch},
+    {"SFALIGN", forthi_word_s_f_align},
+    {"SFALIGNED", forthi_word_s_f_aligned},
+    {"SFFIELD:", forthi_word_s_f_field_colon},
+    {"SFLOAT+", forthi_word_s_float_plus},
+    {"SFLOATS", forthi_word_s_floats},
+    {"SIGN", forthi_word_SIGN},
+    {"SLITERAL", forthi_word_SLITERAL},
+    {"SM/REM", forthi_word_s_m_slash_rem},
+    {"SOURCE", forthi_word_SOURCE},
+    {"SOURCE_ID", forthi_word_source_i_d},
+    {"SPACE", forthi_word_SPACE},
+    {"SPACES", forthi_word_SPACES},
+    {"STATE", forthi_word_STATE},
+    {"SUBSTITURE", forthi_word_SUBSTITURE},
+    {"SWAP", forthi_word_SWAP},
+    {"SYNONYM", forthi_word_SYNONYM},
+    {"S\\", forthi_word_s_backslash_quote},
+    {"THEN", forthi_word_THEN},
+    {"THROW", forthi_word_THROW},
+    {"THRU", forthi_word_THRU},
+    {"TIME&DATE", forthi_word_time_and_date},
+    {"TO", forthi_word_TO},
+    {"TRAVERSE-WORDLIST", forthi_word_TRAVERSE_WORDLIST},
+    {"TRUE", forthi_word_TRUE},
+    {"TUCK", forthi_word_TUCK},
+    {"TYPE", forthi_word_TYPE},
+    {"U.", forthi_word_u_dot},
+    {"U*", forthi_word_u_star},
+    {"U/MOD", forthi_word_u_slash_mod},
+    {"U.R", forthi_word_u_dot_r},
+    {"U<", forthi_word_u_less_than},
+    {"U>", forthi_word_u_greater_than},
+    {"UM*", forthi_word_u_m_star},
+    {"UM/MOD", forthi_word_u_m_slash_mod},
+    {"UNESCAPE", forthi_word_UNESCAPE},
+    {"UNLOOP", forthi_word_UNLOOP},
+    {"UNTIL", forthi_word_UNTIL},
+    {"UNUSED", forthi_word_UNUSED},
+    {"UPDATE", forthi_word_UPDATE},
+    {"VALUE", forthi_word_VALUE},
+    {"VARIABLE", forthi_word_VARIABLE},
+    {"W/O", forthi_word_w_o},
+    {"WHILE", forthi_word_WHILE},
+    {"WITHIN", forthi_word_WITHIN},
+    {"WORD", forthi_word_WORD},
+    {"WORDLIST", forthi_word_WORDLIST},
+    {"WORDS", forthi_word_WORDS},
+    {"WRITE-FILE", forthi_word_WRITE_FILE},
+    {"WRITE-LINE", forthi_word_WRITE_LINE},
+    {"X-SIZE", forthi_word_X_SIZE},
+    {"X-WIDTH", forthi_word_X_WIDTH},
+    {"XC!+", forthi_word_x_c_store_plus},
+    {"XC!+?", forthi_word_x_c_store_plus_query},
+    {"XC,", forthi_word_x_c_comma},
+    {"XC-SIZE", forthi_word_x_c_size},
+    {"XC-WIDTH", forthi_word_x_c_width},
+    {"XC@+", forthi_word_x_c_fetch_plus},
+    {"XCHAR+", forthi_word_x_char_plus},
+    {"XCHAR-", forthi_word_x_char_minus},
+    {"XEMIT", forthi_word_x_emit},
+    {"XHOLD", forthi_word_x_hold},
+    {"XKEY", forthi_word_x_key},
+    {"XKEY?", forthi_word_x_key_query},
+    {"XOR", forthi_word_x_or},
+    {"X\\STRING-", forthi_word_x_string_minus},
+    {"[", forthi_word_left_bracket},
+    {"[']", forthi_word_bracket_tick},
+    {"[CHAR]", forthi_word_bracket_char},
+    {"[COMPILE]", forthi_word_bracket_compile},
+    {"[DEFINED]", forthi_word_bracket_defined},
+    {"[ELSE]", forthi_word_bracket_else},
+    {"[IF]", forthi_word_bracket_if},
+    {"[THEN]", forthi_word_bracket_then},
+    {"[UNDEFINED]", forthi_word_bracket_undefined},
+    {"\\", forthi_word_backslash},
+    {"]", forthi_word_right_bracket},
+    {"{:", forthi_word_brace_colon},
+};
+
+// C functions compiled by words, without a word of their own
+static const forth_c_word forthi_internal_functions[] = 
+{
+    {"(marker-restore)", forthi_word_marker_restore},
+};
+
 static int forthi_defineStandardWords(forth_context* ctx)
 {
-#define FORTHI_DEFINE_STANDARD_WORD(_word_, _func_) \
-    if (forth_add_c_word(ctx, _word_, _func_) == FORTH_FAILURE) \
-        return FORTH_FAILURE;
-    
-    FORTHI_DEFINE_STANDARD_WORD("!", forthi_word_store);
-    FORTHI_DEFINE_STANDARD_WORD("#", forthi_word_number_sign);
-    FORTHI_DEFINE_STANDARD_WORD("#>", forthi_word_number_sign_greater);
-    FORTHI_DEFINE_STANDARD_WORD("#S", forthi_word_number_sign_s);
-    FORTHI_DEFINE_STANDARD_WORD("'", forthi_word_tick);
-    FORTHI_DEFINE_STANDARD_WORD("(", forthi_word_paren);
-    FORTHI_DEFINE_STANDARD_WORD("(LOCAL)", forthi_word_paren_local_paren);
-    FORTHI_DEFINE_STANDARD_WORD("*", forthi_word_star);
-    FORTHI_DEFINE_STANDARD_WORD("*/", forthi_word_star_slash);
-    FORTHI_DEFINE_STANDARD_WORD("*/MOD", forthi_word_star_slash_mod);
-    FORTHI_DEFINE_STANDARD_WORD("+", forthi_word_plus);
-    FORTHI_DEFINE_STANDARD_WORD("+!", forthi_word_plus_store);
-    FORTHI_DEFINE_STANDARD_WORD("+FIELD", forthi_word_plus_field);
-    FORTHI_DEFINE_STANDARD_WORD("+LOOP", forthi_word_plus_loop);
-    FORTHI_DEFINE_STANDARD_WORD("/LOOP", forthi_word_slash_loop);
-    FORTHI_DEFINE_STANDARD_WORD("+X/STRING", forthi_word_plus_x_string);
-    FORTHI_DEFINE_STANDARD_WORD(",", forthi_word_comma);
-    FORTHI_DEFINE_STANDARD_WORD("-", forthi_word_minus);
-    FORTHI_DEFINE_STANDARD_WORD("-TRAILING", forthi_word_dash_trailing);
-    FORTHI_DEFINE_STANDARD_WORD("-TRAILING-GARBAGE", forthi_word_dash_trailing_garbage);
-    FORTHI_DEFINE_STANDARD_WORD(".", forthi_word_dot);
-    FORTHI_DEFINE_STANDARD_WORD(".\"", forthi_word_dot_quote);
-    FORTHI_DEFINE_STANDARD_WORD(".(", forthi_word_dot_paren);
-    FORTHI_DEFINE_STANDARD_WORD(".R", forthi_word_dot_r);
-    FORTHI_DEFINE_STANDARD_WORD(".S", forthi_word_dot_s);
-    FORTHI_DEFINE_STANDARD_WORD("/", forthi_word_slash);
-    FORTHI_DEFINE_STANDARD_WORD("/MOD", forthi_word_slash_mod);
-    FORTHI_DEFINE_STANDARD_WORD("/STRING", forthi_word_slash_string);
-    FORTHI_DEFINE_STANDARD_WORD("0<", forthi_word_zero_less);
-    FORTHI_DEFINE_STANDARD_WORD("0<>", forthi_word_zero_not_equals);
-    FORTHI_DEFINE_STANDARD_WORD("0=", forthi_word_zero_equals);
-    FORTHI_DEFINE_STANDARD_WORD("0>", forthi_word_zero_greater);
-    FORTHI_DEFINE_STANDARD_WORD("1+", forthi_word_one_plus);
-    FORTHI_DEFINE_STANDARD_WORD("1-", forthi_word_one_minus);
-    FORTHI_DEFINE_STANDARD_WORD("2+", forthi_word_two_plus);
-    FORTHI_DEFINE_STANDARD_WORD("2-", forthi_word_two_minus);
-    FORTHI_DEFINE_STANDARD_WORD("2!", forthi_word_two_store);
-    FORTHI_DEFINE_STANDARD_WORD("2*", forthi_word_two_star);
-    FORTHI_DEFINE_STANDARD_WORD("2/", forthi_word_two_slash);
-    FORTHI_DEFINE_STANDARD_WORD("2>R", forthi_word_two_to_r);
-    FORTHI_DEFINE_STANDARD_WORD("2@", forthi_word_two_fetch);
-    FORTHI_DEFINE_STANDARD_WORD("2CONSTANT", forthi_word_two_constant);
-    FORTHI_DEFINE_STANDARD_WORD("2DROP", forthi_word_two_drop);
-    FORTHI_DEFINE_STANDARD_WORD("2DUP", forthi_word_two_dupe);
-    FORTHI_DEFINE_STANDARD_WORD("2LITERAL", forthi_word_two_literal);
-    FORTHI_DEFINE_STANDARD_WORD("2OVER", forthi_word_two_over);
-    FORTHI_DEFINE_STANDARD_WORD("2R>", forthi_word_two_r_from);
-    FORTHI_DEFINE_STANDARD_WORD("2R@", forthi_word_two_r_fetch);
-    FORTHI_DEFINE_STANDARD_WORD("2ROT", forthi_word_two_rote);
-    FORTHI_DEFINE_STANDARD_WORD("2SWAP", forthi_word_two_swap);
-    FORTHI_DEFINE_STANDARD_WORD("2VALUE", forthi_word_two_value);
-    FORTHI_DEFINE_STANDARD_WORD("2VARIABLE", forthi_word_two_variable);
-    FORTHI_DEFINE_STANDARD_WORD(":", forthi_word_colon);
-    FORTHI_DEFINE_STANDARD_WORD(":NONAME", forthi_word_colon_no_name);
-    FORTHI_DEFINE_STANDARD_WORD(";", forthi_word_semicolon);
-    FORTHI_DEFINE_STANDARD_WORD(";CODE", forthi_word_semicolon_code);
-    FORTHI_DEFINE_STANDARD_WORD("<", forthi_word_less_than);
-    FORTHI_DEFINE_STANDARD_WORD("<#", forthi_word_less_number_sign);
-    FORTHI_DEFINE_STANDARD_WORD("<>", forthi_word_not_equals);
-    FORTHI_DEFINE_STANDARD_WORD("=", forthi_word_equals);
-    FORTHI_DEFINE_STANDARD_WORD(">", forthi_word_greater_than);
-    FORTHI_DEFINE_STANDARD_WORD(">BODY", forthi_word_to_body);
-    FORTHI_DEFINE_STANDARD_WORD(">FLOAT", forthi_word_to_float);
-    FORTHI_DEFINE_STANDARD_WORD(">IN", forthi_word_to_in);
-    FORTHI_DEFINE_STANDARD_WORD(">NUMBER", forthi_word_to_number);
-    FORTHI_DEFINE_STANDARD_WORD(">R", forthi_word_to_r);
-    FORTHI_DEFINE_STANDARD_WORD("?", forthi_word_question);
-    FORTHI_DEFINE_STANDARD_WORD("?DO", forthi_word_question_do);
-    FORTHI_DEFINE_STANDARD_WORD("?DUP", forthi_word_question_dupe);
-    FORTHI_DEFINE_STANDARD_WORD("@", forthi_word_fetch);
-    FORTHI_DEFINE_STANDARD_WORD("ABORT", forthi_word_ABORT);
-    FORTHI_DEFINE_STANDARD_WORD("ABORT\"", forthi_word_abort_quote);
-    FORTHI_DEFINE_STANDARD_WORD("ABS", forthi_word_abs);
-    FORTHI_DEFINE_STANDARD_WORD("ACCEPT", forthi_word_ACCEPT);
-    FORTHI_DEFINE_STANDARD_WORD("ACTION-OF", forthi_word_ACTION_OF);
-    FORTHI_DEFINE_STANDARD_WORD("AGAIN", forthi_word_AGAIN);
-    FORTHI_DEFINE_STANDARD_WORD("AHEAD", forthi_word_AHEAD);
-    FORTHI_DEFINE_STANDARD_WORD("ALIGN", forthi_word_ALIGN);
-    FORTHI_DEFINE_STANDARD_WORD("ALIGNED", forthi_word_ALIGNED);
-    FORTHI_DEFINE_STANDARD_WORD("ALLOCATE", forthi_word_ALLOCATE);
-    FORTHI_DEFINE_STANDARD_WORD("ALLOT", forthi_word_ALLOT);
-    FORTHI_DEFINE_STANDARD_WORD("ALSO", forthi_word_ALSO);
-    FORTHI_DEFINE_STANDARD_WORD("AND", forthi_word_AND);
-    FORTHI_DEFINE_STANDARD_WORD("ASSEMBLER", forthi_word_ASSEMBLER);
-    FORTHI_DEFINE_STANDARD_WORD("AT-XY", forthi_word_at_x_y);
-    FORTHI_DEFINE_STANDARD_WORD("BASE", forthi_word_BASE);
-    FORTHI_DEFINE_STANDARD_WORD("BEGIN", forthi_word_BEGIN);
-    FORTHI_DEFINE_STANDARD_WORD("BEGIN-STRUCTURE", forthi_word_BEGIN_STRUCTURE);
-    FORTHI_DEFINE_STANDARD_WORD("BIN", forthi_word_BIN);
-    FORTHI_DEFINE_STANDARD_WORD("BL", forthi_word_b_l);
-    FORTHI_DEFINE_STANDARD_WORD("BLANK", forthi_word_BLANK);
-    FORTHI_DEFINE_STANDARD_WORD("BLK", forthi_word_b_l_k);
-    FORTHI_DEFINE_STANDARD_WORD("BLOCK", forthi_word_BLOCK);
-    FORTHI_DEFINE_STANDARD_WORD("BUFFER", forthi_word_BUFFER);
-    FORTHI_DEFINE_STANDARD_WORD("BUFFER:", forthi_word_buffer_colon);
-    FORTHI_DEFINE_STANDARD_WORD("BYE", forthi_word_BYE);
-    FORTHI_DEFINE_STANDARD_WORD("C!", forthi_word_c_store);
-    FORTHI_DEFINE_STANDARD_WORD("C\"", forthi_word_c_quote);
-    FORTHI_DEFINE_STANDARD_WORD("C,", forthi_word_c_comma);
-    FORTHI_DEFINE_STANDARD_WORD("C@", forthi_word_c_fetch);
-    FORTHI_DEFINE_STANDARD_WORD("CASE", forthi_word_CASE);
-    FORTHI_DEFINE_STANDARD_WORD("CATCH", forthi_word_CATCH);
-    FORTHI_DEFINE_STANDARD_WORD("CELL+", forthi_word_cell_plus);
-    FORTHI_DEFINE_STANDARD_WORD("CELLS", forthi_word_CELLS);
-    FORTHI_DEFINE_STANDARD_WORD("CFIELD:", forthi_word_c_field_colon);
-    FORTHI_DEFINE_STANDARD_WORD("CHAR", forthi_word_char);
-    FORTHI_DEFINE_STANDARD_WORD("CHAR+", forthi_word_char_plus);
-    FORTHI_DEFINE_STANDARD_WORD("CHARS", forthi_word_chars);
-    FORTHI_DEFINE_STANDARD_WORD("CLOSE-FILE", forthi_word_CLOSE_FILE);
-    FORTHI_DEFINE_STANDARD_WORD("CMOVE", forthi_word_c_move);
-    FORTHI_DEFINE_STANDARD_WORD("CMOVE>", forthi_word_c_move_up);
-    FORTHI_DEFINE_STANDARD_WORD("CODE", forthi_word_CODE);
-    FORTHI_DEFINE_STANDARD_WORD("COMPARE", forthi_word_COMPARE);
-    FORTHI_DEFINE_STANDARD_WORD("COMPILE,", forthi_word_compile_comma);
-    FORTHI_DEFINE_STANDARD_WORD("CONSTANT", forthi_word_CONSTANT);
-    FORTHI_DEFINE_STANDARD_WORD("COUNT", forthi_word_COUNT);
-    FORTHI_DEFINE_STANDARD_WORD("CR", forthi_word_c_r);
-    FORTHI_DEFINE_STANDARD_WORD("CREATE", forthi_word_CREATE);
-    FORTHI_DEFINE_STANDARD_WORD("CREATE-FILE", forthi_word_CREATE_FILE);
-    FORTHI_DEFINE_STANDARD_WORD("CS-PICK", forthi_word_c_s_pick);
-    FORTHI_DEFINE_STANDARD_WORD("CS-ROLL", forthi_word_c_s_roll);
-    FORTHI_DEFINE_STANDARD_WORD("D+", forthi_word_d_plus);
-    FORTHI_DEFINE_STANDARD_WORD("D-", forthi_word_d_minus);
-    FORTHI_DEFINE_STANDARD_WORD("D.", forthi_word_d_dot);
-    FORTHI_DEFINE_STANDARD_WORD("D.R", forthi_word_d_dot_r);
-    FORTHI_DEFINE_STANDARD_WORD("D0<", forthi_word_d_zero_less);
-    FORTHI_DEFINE_STANDARD_WORD("D0=", forthi_word_d_zero_equals);
-    FORTHI_DEFINE_STANDARD_WORD("D2*", forthi_word_d_two_star);
-    FORTHI_DEFINE_STANDARD_WORD("D2/", forthi_word_d_two_slash);
-    FORTHI_DEFINE_STANDARD_WORD("D<", forthi_word_d_less_than);
-    FORTHI_DEFINE_STANDARD_WORD("D=", forthi_word_d_equals);
-    FORTHI_DEFINE_STANDARD_WORD("D>F", forthi_word_d_to_f);
-    FORTHI_DEFINE_STANDARD_WORD("D>S", forthi_word_d_to_s);
-    FORTHI_DEFINE_STANDARD_WORD("DABS", forthi_word_d_abs);
-    FORTHI_DEFINE_STANDARD_WORD("DECIMAL", forthi_word_DECIMAL);
-    FORTHI_DEFINE_STANDARD_WORD("DEFER", forthi_word_DEFER);
-    FORTHI_DEFINE_STANDARD_WORD("DEFER!", forthi_word_defer_store);
-    FORTHI_DEFINE_STANDARD_WORD("DEFER@", forthi_word_defer_fetch);
-    FORTHI_DEFINE_STANDARD_WORD("DEFINITIONS", forthi_word_DEFINITIONS);
-    FORTHI_DEFINE_STANDARD_WORD("DELETE-FILE", forthi_word_DELETE_FILE);
-    FORTHI_DEFINE_STANDARD_WORD("DEPTH", forthi_word_DEPTH);
-    FORTHI_DEFINE_STANDARD_WORD("DF!", forthi_word_d_f_store);
-    FORTHI_DEFINE_STANDARD_WORD("DF@", forthi_word_d_f_fetch);
-    FORTHI_DEFINE_STANDARD_WORD("DFALIGN", forthi_word_d_f_align);
-    FORTHI_DEFINE_STANDARD_WORD("DFALIGNED", forthi_word_d_f_aligned);
-    FORTHI_DEFINE_STANDARD_WORD("DFFIELD:", forthi_word_d_f_field_colon);
-    FORTHI_DEFINE_STANDARD_WORD("DFLOAT+", forthi_word_d_float_plus);
-    FORTHI_DEFINE_STANDARD_WORD("DFLOATS", forthi_word_d_floats);
-    FORTHI_DEFINE_STANDARD_WORD("DMAX", forthi_word_d_max);
-    FORTHI_DEFINE_STANDARD_WORD("DMIN", forthi_word_d_min);
-    FORTHI_DEFINE_STANDARD_WORD("DNEGATE", forthi_word_d_negate);
-    FORTHI_DEFINE_STANDARD_WORD("DO", forthi_word_DO);
-    FORTHI_DEFINE_STANDARD_WORD("DOES>", forthi_word_does);
-    FORTHI_DEFINE_STANDARD_WORD("DROP", forthi_word_DROP);
-    FORTHI_DEFINE_STANDARD_WORD("DU<", forthi_word_d_u_less);
-    FORTHI_DEFINE_STANDARD_WORD("DUMP", forthi_word_DUMP);
-    FORTHI_DEFINE_STANDARD_WORD("DUP", forthi_word_dupe);
-    FORTHI_DEFINE_STANDARD_WORD("EDITOR", forthi_word_EDITOR);
-    FORTHI_DEFINE_STANDARD_WORD("EKEY", forthi_word_e_key);
-    FORTHI_DEFINE_STANDARD_WORD("EKEY>CHAR", forthi_word_e_key_to_char);
-    FORTHI_DEFINE_STANDARD_WORD("EKEY>FKEY", forthi_word_e_key_to_f_key);
-    FORTHI_DEFINE_STANDARD_WORD("EKEY>XCHAR", forthi_word_e_key_to_x_char);
-    FORTHI_DEFINE_STANDARD_WORD("EKEY?", forthi_word_e_key_question);
-    FORTHI_DEFINE_STANDARD_WORD("ELSE", forthi_word_ELSE);
-    FORTHI_DEFINE_STANDARD_WORD("EMIT", forthi_word_EMIT);
-    FORTHI_DEFINE_STANDARD_WORD("EMIT?", forthi_word_emit_question);
-    FORTHI_DEFINE_STANDARD_WORD("EMPTY", forthi_word_EMPTY);
-    FORTHI_DEFINE_STANDARD_WORD("EMPTY-BUFFERS", forthi_word_EMPTY_BUFFERS);
-    FORTHI_DEFINE_STANDARD_WORD("END-STRUCTURE", forthi_word_END_STRUCTURE);
-    FORTHI_DEFINE_STANDARD_WORD("ENDCASE", forthi_word_end_case);
-    FORTHI_DEFINE_STANDARD_WORD("ENDOF", forthi_word_end_of);
-    FORTHI_DEFINE_STANDARD_WORD("ENVIRONMENT?", forthi_word_environment_query);
-    FORTHI_DEFINE_STANDARD_WORD("ERASE", forthi_word_ERASE);
-    FORTHI_DEFINE_STANDARD_WORD("EVALUATE", forthi_word_EVALUATE);
-    FORTHI_DEFINE_STANDARD_WORD("EXECUTE", forthi_word_EXECUTE);
-    FORTHI_DEFINE_STANDARD_WORD("EXIT", forthi_word_EXIT);
-    FORTHI_DEFINE_STANDARD_WORD("F!", forthi_word_f_store);
-    FORTHI_DEFINE_STANDARD_WORD("F*", forthi_word_f_star);
-    FORTHI_DEFINE_STANDARD_WORD("F**", forthi_word_f_star_star);
-    FORTHI_DEFINE_STANDARD_WORD("F+", forthi_word_f_plus);
-    FORTHI_DEFINE_STANDARD_WORD("F-", forthi_word_f_minus);
-    FORTHI_DEFINE_STANDARD_WORD("F.", forthi_word_f_dot);
-    FORTHI_DEFINE_STANDARD_WORD("F/", forthi_word_f_slash);
-    FORTHI_DEFINE_STANDARD_WORD("F0<", forthi_word_f_zero_less_than);
-    FORTHI_DEFINE_STANDARD_WORD("F0=", forthi_word_f_zero_equals);
-    FORTHI_DEFINE_STANDARD_WORD("F>D", forthi_word_f_to_d);
-    FORTHI_DEFINE_STANDARD_WORD("F>S", forthi_word_F_to_S);
-    FORTHI_DEFINE_STANDARD_WORD("F@", forthi_word_f_fetch);
-    FORTHI_DEFINE_STANDARD_WORD("FABS", forthi_word_f_abs);
-    FORTHI_DEFINE_STANDARD_WORD("FACOS", forthi_word_f_a_cos);
-    FORTHI_DEFINE_STANDARD_WORD("FACOSH", forthi_word_f_a_cosh);
-    FORTHI_DEFINE_STANDARD_WORD("FALIGN", forthi_word_f_align);
-    FORTHI_DEFINE_STANDARD_WORD("FALIGNED", forthi_word_f_aligned);
-    FORTHI_DEFINE_STANDARD_WORD("FALOG", forthi_word_f_a_log);
-    FORTHI_DEFINE_STANDARD_WORD("FALSE", forthi_word_FALSE);
-    FORTHI_DEFINE_STANDARD_WORD("FASIN", forthi_word_f_a_sine);
-    FORTHI_DEFINE_STANDARD_WORD("FASINH", forthi_word_f_a_cinch);
-    FORTHI_DEFINE_STANDARD_WORD("FATAN", forthi_word_f_a_tan);
-    FORTHI_DEFINE_STANDARD_WORD("FATAN2", forthi_word_f_a_tan_two);
-    FORTHI_DEFINE_STANDARD_WORD("FATANH", forthi_word_f_a_tan_h);
-    FORTHI_DEFINE_STANDARD_WORD("FCONSTANT", forthi_word_f_constant);
-    FORTHI_DEFINE_STANDARD_WORD("FCOS", forthi_word_f_cos);
-    FORTHI_DEFINE_STANDARD_WORD("FCOSH", forthi_word_f_cosh);
-    FORTHI_DEFINE_STANDARD_WORD("FDEPTH", forthi_word_f_depth);
-    FORTHI_DEFINE_STANDARD_WORD("FDROP", forthi_word_f_drop);
-    FORTHI_DEFINE_STANDARD_WORD("FDUP", forthi_word_f_dupe);
-    FORTHI_DEFINE_STANDARD_WORD("FE.", forthi_word_f_e_dot);
-    FORTHI_DEFINE_STANDARD_WORD("FEXP", forthi_word_f_e_x_p);
-    FORTHI_DEFINE_STANDARD_WORD("FEXPM1", forthi_word_f_e_x_p_m_one);
-    FORTHI_DEFINE_STANDARD_WORD("FFIELD:", forthi_word_f_field_colon);
-    FORTHI_DEFINE_STANDARD_WORD("FIELD:", forthi_word_field_colon);
-    FORTHI_DEFINE_STANDARD_WORD("FILE-POSITION", forthi_word_FILE_POSITION);
-    FORTHI_DEFINE_STANDARD_WORD("FILE-SIZE", forthi_word_FILE_SIZE);
-    FORTHI_DEFINE_STANDARD_WORD("FILE-STATUS", forthi_word_FILE_STATUS);
-    FORTHI_DEFINE_STANDARD_WORD("FILL", forthi_word_FILL);
-    FORTHI_DEFINE_STANDARD_WORD("FIND", forthi_word_FIND);
-    FORTHI_DEFINE_STANDARD_WORD("FLITERAL", forthi_word_f_literal);
-    FORTHI_DEFINE_STANDARD_WORD("FLN", forthi_word_f_l_n);
-    FORTHI_DEFINE_STANDARD_WORD("FLNP1", forthi_word_f_l_n_p_one);
-    FORTHI_DEFINE_STANDARD_WORD("FLOAT+", forthi_word_float_plus);
-    FORTHI_DEFINE_STANDARD_WORD("FLOATS", forthi_word_FLOATS);
-    FORTHI_DEFINE_STANDARD_WORD("FLOT", forthi_word_f_log);
-    FORTHI_DEFINE_STANDARD_WORD("FLOOR", forthi_word_FLOOR);
-    //FORTHI_DEFINE_STANDARD_WORD("FLUSH", forthi_word_FLUSH); // Undefined word, block related
-    FORTHI_DEFINE_STANDARD_WORD("FLUSH-FILE", forthi_word_FLUSH_FILE);
-    FORTHI_DEFINE_STANDARD_WORD("FM/MOD", forthi_word_f_m_slash_mod);
-    FORTHI_DEFINE_STANDARD_WORD("FMAX", forthi_word_f_max);
-    FORTHI_DEFINE_STANDARD_WORD("FMIN", forthi_word_f_min);
-    FORTHI_DEFINE_STANDARD_WORD("FNEGATE", forthi_word_f_negate);
-    FORTHI_DEFINE_STANDARD_WORD("FORGET", forthi_word_FORGET);
-    FORTHI_DEFINE_STANDARD_WORD("FORTH", forthi_word_FORTH);
-    FORTHI_DEFINE_STANDARD_WORD("FORTH-WORDLIST", forthi_word_FORTH_WORDLIST);
-    FORTHI_DEFINE_STANDARD_WORD("FOVER", forthi_word_f_over);
-    FORTHI_DEFINE_STANDARD_WORD("FREE", forthi_word_FREE);
-    FORTHI_DEFINE_STANDARD_WORD("FROT", forthi_word_f_rote);
-    FORTHI_DEFINE_STANDARD_WORD("FROUND", forthi_word_f_round);
-    FORTHI_DEFINE_STANDARD_WORD("FS.", forthi_word_f_s_dot);
-    FORTHI_DEFINE_STANDARD_WORD("FSIN", forthi_word_f_sine);
-    FORTHI_DEFINE_STANDARD_WORD("FSINCOS", forthi_word_f_sine_cos);
-    FORTHI_DEFINE_STANDARD_WORD("FSINH", forthi_word_f_cinch);
-    FORTHI_DEFINE_STANDARD_WORD("FSQRT", forthi_word_f_square_root);
-    FORTHI_DEFINE_STANDARD_WORD("FSWAP", forthi_word_f_swap);
-    FORTHI_DEFINE_STANDARD_WORD("FTAN", forthi_word_f_tan);
-    FORTHI_DEFINE_STANDARD_WORD("FTANH", forthi_word_f_tan_h);
-    FORTHI_DEFINE_STANDARD_WORD("FTRUNC", forthi_word_f_trunc);
-    FORTHI_DEFINE_STANDARD_WORD("FVALUE", forthi_word_f_value);
-    FORTHI_DEFINE_STANDARD_WORD("FVARIABLE", forthi_word_f_variable);
-    FORTHI_DEFINE_STANDARD_WORD("F~", forthi_word_f_proximate);
-    FORTHI_DEFINE_STANDARD_WORD("GET-CURRENT", forthi_word_GET_CURRENT);
-    FORTHI_DEFINE_STANDARD_WORD("GET-ORDER", forthi_word_GET_ORDER);
-    FORTHI_DEFINE_STANDARD_WORD("HERE", forthi_word_HERE);
-    FORTHI_DEFINE_STANDARD_WORD("HEX", forthi_word_HEX);
-    FORTHI_DEFINE_STANDARD_WORD("HOLD", forthi_word_HOLD);
-    FORTHI_DEFINE_STANDARD_WORD("HOLDS", forthi_word_HOLDS);
-    FORTHI_DEFINE_STANDARD_WORD("I", forthi_word_I);
-    FORTHI_DEFINE_STANDARD_WORD("I'", forthi_word_i_tick);
-    FORTHI_DEFINE_STANDARD_WORD("IF", forthi_word_IF);
-    FORTHI_DEFINE_STANDARD_WORD("IMMEDIATE", forthi_word_IMMEDIATE);
-    FORTHI_DEFINE_STANDARD_WORD("INCLUDE", forthi_word_INCLUDE);
-    FORTHI_DEFINE_STANDARD_WORD("INCLUDE-FILE", forthi_word_INCLUDE_FILE);
-    FORTHI_DEFINE_STANDARD_WORD("INCLUDED", forthi_word_INCLUDED);
-    FORTHI_DEFINE_STANDARD_WORD("INVERT", forthi_word_INVERT);
-    FORTHI_DEFINE_STANDARD_WORD("IS", forthi_word_IS);
-    FORTHI_DEFINE_STANDARD_WORD("J", forthi_word_J);
-    FORTHI_DEFINE_STANDARD_WORD("K-ALT-MASK", forthi_word_K_ALT_MASK);
-    FORTHI_DEFINE_STANDARD_WORD("K-CTRL-MASK", forthi_word_K_CTRL_MASK);
-    FORTHI_DEFINE_STANDARD_WORD("K-DELETE", forthi_word_K_DELETE);
-    FORTHI_DEFINE_STANDARD_WORD("K-DOWN", forthi_word_K_DOWN);
-    FORTHI_DEFINE_STANDARD_WORD("K-END", forthi_word_K_END);
-    FORTHI_DEFINE_STANDARD_WORD("K-F1", forthi_word_k_f_1);
-    FORTHI_DEFINE_STANDARD_WORD("K-F10", forthi_word_k_f_10);
-    FORTHI_DEFINE_STANDARD_WORD("K-F11", forthi_word_k_f_11);
-    FORTHI_DEFINE_STANDARD_WORD("K-F12", forthi_word_k_f_12);
-    FORTHI_DEFINE_STANDARD_WORD("K-F2", forthi_word_k_f_2);
-    FORTHI_DEFINE_STANDARD_WORD("K-F3", forthi_word_k_f_3);
-    FORTHI_DEFINE_STANDARD_WORD("K-F4", forthi_word_k_f_4);
-    FORTHI_DEFINE_STANDARD_WORD("K-F5", forthi_word_k_f_5);
-    FORTHI_DEFINE_STANDARD_WORD("K-F6", forthi_word_k_f_6);
-    FORTHI_DEFINE_STANDARD_WORD("K-F7", forthi_word_k_f_7);
-    FORTHI_DEFINE_STANDARD_WORD("K-F8", forthi_word_k_f_8);
-    FORTHI_DEFINE_STANDARD_WORD("K-F9", forthi_word_k_f_9);
-    FORTHI_DEFINE_STANDARD_WORD("K_HOME", forthi_word_K_HOME);
-    FORTHI_DEFINE_STANDARD_WORD("K_INSERT", forthi_word_K_INSERT);
-    FORTHI_DEFINE_STANDARD_WORD("K_LEFT", forthi_word_K_LEFT);
-    FORTHI_DEFINE_STANDARD_WORD("K_NEXT", forthi_word_K_NEXT);
-    FORTHI_DEFINE_STANDARD_WORD("K_PRIOR", forthi_word_K_PRIOR);
-    FORTHI_DEFINE_STANDARD_WORD("K_RIGHT", forthi_word_K_RIGHT);
-    FORTHI_DEFINE_STANDARD_WORD("K_SHIFT_MASK", forthi_word_K_SHIFT_MASK);
-    FORTHI_DEFINE_STANDARD_WORD("K_UP", forthi_word_K_UP);
-    FORTHI_DEFINE_STANDARD_WORD("KEY", forthi_word_KEY);
-    FORTHI_DEFINE_STANDARD_WORD("KEY?", forthi_word_key_question);
-    FORTHI_DEFINE_STANDARD_WORD("LEAVE", forthi_word_LEAVE);
-    //FORTHI_DEFINE_STANDARD_WORD("LIST", forthi_word_LIST); // Undefined word, block related
-    FORTHI_DEFINE_STANDARD_WORD("LITERAL", forthi_word_LITERAL);
-    //FORTHI_DEFINE_STANDARD_WORD("LOAD", forthi_word_LOAD); // Undefined word, block related
-    FORTHI_DEFINE_STANDARD_WORD("LOCALS|", forthi_word_locals_bar);
-    FORTHI_DEFINE_STANDARD_WORD("LOOP", forthi_word_LOOP);
-    FORTHI_DEFINE_STANDARD_WORD("LSHIFT", forthi_word_l_shift);
-    FORTHI_DEFINE_STANDARD_WORD("M*", forthi_word_m_star);
-    FORTHI_DEFINE_STANDARD_WORD("M*/", forthi_word_m_star_slash);
-    FORTHI_DEFINE_STANDARD_WORD("M+", forthi_word_m_plus);
-    FORTHI_DEFINE_STANDARD_WORD("MARKER", forthi_word_MARKER);
-    FORTHI_DEFINE_STANDARD_WORD("MAX", forthi_word_MAX);
-    FORTHI_DEFINE_STANDARD_WORD("MIN", forthi_word_MIN);
-    FORTHI_DEFINE_STANDARD_WORD("MOD", forthi_word_MOD);
-    FORTHI_DEFINE_STANDARD_WORD("MOVE", forthi_word_MOVE);
-    FORTHI_DEFINE_STANDARD_WORD("MS", forthi_word_MS);
-    FORTHI_DEFINE_STANDARD_WORD("N>R", forthi_word_n_to_r);
-    FORTHI_DEFINE_STANDARD_WORD("NAME>COMPILE", forthi_word_name_to_compile);
-    FORTHI_DEFINE_STANDARD_WORD("NAME>INTERPRET", forthi_word_name_to_interpret);
-    FORTHI_DEFINE_STANDARD_WORD("NAME>STRING", forthi_word_name_to_string);
-    FORTHI_DEFINE_STANDARD_WORD("NEGATE", forthi_word_NEGATE);
-    FORTHI_DEFINE_STANDARD_WORD("NIP", forthi_word_NIP);
-    FORTHI_DEFINE_STANDARD_WORD("NOT", forthi_word_zero_equals); // For convenience
-    FORTHI_DEFINE_STANDARD_WORD("NR>", forthi_word_n_r_from);
-    FORTHI_DEFINE_STANDARD_WORD("NUMBER", forthi_word_NUMBER);
-    FORTHI_DEFINE_STANDARD_WORD("OCTAL", forthi_word_OCTAL);
-    FORTHI_DEFINE_STANDARD_WORD("OF", forthi_word_OF);
-    FORTHI_DEFINE_STANDARD_WORD("ONLY", forthi_word_ONLY);
-    FORTHI_DEFINE_STANDARD_WORD("OPEN-FILE", forthi_word_OPEN_FILE);
-    FORTHI_DEFINE_STANDARD_WORD("OR", forthi_word_OR);
-    FORTHI_DEFINE_STANDARD_WORD("ORDER", forthi_word_ORDER);
-    FORTHI_DEFINE_STANDARD_WORD("OVER", forthi_word_OVER);
-    FORTHI_DEFINE_STANDARD_WORD("PAD", forthi_word_PAD);
-    FORTHI_DEFINE_STANDARD_WORD("PAGE", forthi_word_PAGE);
-    FORTHI_DEFINE_STANDARD_WORD("PARSE", forthi_word_PARSE);
-    FORTHI_DEFINE_STANDARD_WORD("PARSE-NAME", forthi_word_PARSE_NAME);
-    FORTHI_DEFINE_STANDARD_WORD("PICK", forthi_word_PICK);
-    FORTHI_DEFINE_STANDARD_WORD("POSTPONE", forthi_word_POSTPONE);
-    FORTHI_DEFINE_STANDARD_WORD("PRECISION", forthi_word_PRECISION);
-    FORTHI_DEFINE_STANDARD_WORD("PREVIOUS", forthi_word_PREVIOUS);
-    FORTHI_DEFINE_STANDARD_WORD("QUIT", forthi_word_QUIT);
-    FORTHI_DEFINE_STANDARD_WORD("R/O", forthi_word_r_o);
-    FORTHI_DEFINE_STANDARD_WORD("R/W", forthi_word_r_w);
-    FORTHI_DEFINE_STANDARD_WORD("R>", forthi_word_r_from);
-    FORTHI_DEFINE_STANDARD_WORD("R@", forthi_word_r_fetch);
-    FORTHI_DEFINE_STANDARD_WORD("READ-FILE", forthi_word_READ_FILE);
-    FORTHI_DEFINE_STANDARD_WORD("READ-LINE", forthi_word_READ_LINE);
-    FORTHI_DEFINE_STANDARD_WORD("RECURSE", forthi_word_RECURSE);
-    FORTHI_DEFINE_STANDARD_WORD("REFILL", forthi_word_REFILL);
-    FORTHI_DEFINE_STANDARD_WORD("RENAME_FILE", forthi_word_RENAME_FILE);
-    FORTHI_DEFINE_STANDARD_WORD("REPEAT", forthi_word_REPEAT);
-    FORTHI_DEFINE_STANDARD_WORD("REPLACES", forthi_word_REPLACES);
-    FORTHI_DEFINE_STANDARD_WORD("REPOSITION-FILE", forthi_word_REPOSITION_FILE);
-    FORTHI_DEFINE_STANDARD_WORD("REPRESENT", forthi_word_REPRESENT);
-    FORTHI_DEFINE_STANDARD_WORD("REQUIRE", forthi_word_REQUIRE);
-    FORTHI_DEFINE_STANDARD_WORD("REQUIRED", forthi_word_REQUIRED);
-    FORTHI_DEFINE_STANDARD_WORD("RESIZE", forthi_word_RESIZE);
-    FORTHI_DEFINE_STANDARD_WORD("RESIZE-FILE", forthi_word_RESIZE_FILE);
-    FORTHI_DEFINE_STANDARD_WORD("RESTORE-INPUT", forthi_word_RESTORE_INPUT);
-    FORTHI_DEFINE_STANDARD_WORD("ROLL", forthi_word_ROLL);
-    FORTHI_DEFINE_STANDARD_WORD("ROT", forthi_word_rote);
-    FORTHI_DEFINE_STANDARD_WORD("RSHIFT", forthi_word_r_shift);
-    FORTHI_DEFINE_STANDARD_WORD("S\"", forthi_word_s_quote);
-    FORTHI_DEFINE_STANDARD_WORD("S>D", forthi_word_s_to_d);
-    FORTHI_DEFINE_STANDARD_WORD("S>F", forthi_word_s_to_F);
-    FORTHI_DEFINE_STANDARD_WORD("SAVE-BUFFERS", forthi_word_SAVE_BUFFERS);
-    FORTHI_DEFINE_STANDARD_WORD("SAVE-INPUT", forthi_word_SAVE_INPUT);
-    FORTHI_DEFINE_STANDARD_WORD("SCR", forthi_word_s_c_r);
-    FORTHI_DEFINE_STANDARD_WORD("SEARCH", forthi_word_SEARCH);
-    FORTHI_DEFINE_STANDARD_WORD("SEARCH-WORDLIST", forthi_word_SEARCH_WORDLIST);
-    FORTHI_DEFINE_STANDARD_WORD("SEE", forthi_word_SEE);
-    FORTHI_DEFINE_STANDARD_WORD("SET-CURRENT", forthi_word_SET_CURRENT);
-    FORTHI_DEFINE_STANDARD_WORD("SET-ORDER", forthi_word_SET_ORDER);
-    FORTHI_DEFINE_STANDARD_WORD("SET-PRECISION", forthi_word_SET_PRECISION);
-    FORTHI_DEFINE_STANDARD_WORD("SF!", forthi_word_s_f_store);
-    FORTHI_DEFINE_STANDARD_WORD("SF@", forthi_word_s_f_fetch);
-    FORTHI_DEFINE_STANDARD_WORD("SFALIGN", forthi_word_s_f_align);
-    FORTHI_DEFINE_STANDARD_WORD("SFALIGNED", forthi_word_s_f_aligned);
-    FORTHI_DEFINE_STANDARD_WORD("SFFIELD:", forthi_word_s_f_field_colon);
-    FORTHI_DEFINE_STANDARD_WORD("SFLOAT+", forthi_word_s_float_plus);
-    FORTHI_DEFINE_STANDARD_WORD("SFLOATS", forthi_word_s_floats);
-    FORTHI_DEFINE_STANDARD_WORD("SIGN", forthi_word_SIGN);
-    FORTHI_DEFINE_STANDARD_WORD("SLITERAL", forthi_word_SLITERAL);
-    FORTHI_DEFINE_STANDARD_WORD("SM/REM", forthi_word_s_m_slash_rem);
-    FORTHI_DEFINE_STANDARD_WORD("SOURCE", forthi_word_SOURCE);
-    FORTHI_DEFINE_STANDARD_WORD("SOURCE_ID", forthi_word_source_i_d);
-    FORTHI_DEFINE_STANDARD_WORD("SPACE", forthi_word_SPACE);
-    FORTHI_DEFINE_STANDARD_WORD("SPACES", forthi_word_SPACES);
-    FORTHI_DEFINE_STANDARD_WORD("STATE", forthi_word_STATE);
-    FORTHI_DEFINE_STANDARD_WORD("SUBSTITURE", forthi_word_SUBSTITURE);
-    FORTHI_DEFINE_STANDARD_WORD("SWAP", forthi_word_SWAP);
-    FORTHI_DEFINE_STANDARD_WORD("SYNONYM", forthi_word_SYNONYM);
-    FORTHI_DEFINE_STANDARD_WORD("S\\", forthi_word_s_backslash_quote);
-    FORTHI_DEFINE_STANDARD_WORD("THEN", forthi_word_THEN);
-    FORTHI_DEFINE_STANDARD_WORD("THROW", forthi_word_THROW);
-    FORTHI_DEFINE_STANDARD_WORD("THRU", forthi_word_THRU);
-    FORTHI_DEFINE_STANDARD_WORD("TIME&DATE", forthi_word_time_and_date);
-    FORTHI_DEFINE_STANDARD_WORD("TO", forthi_word_TO);
-    FORTHI_DEFINE_STANDARD_WORD("TRAVERSE-WORDLIST", forthi_word_TRAVERSE_WORDLIST);
-    FORTHI_DEFINE_STANDARD_WORD("TRUE", forthi_word_TRUE);
-    FORTHI_DEFINE_STANDARD_WORD("TUCK", forthi_word_TUCK);
-    FORTHI_DEFINE_STANDARD_WORD("TYPE", forthi_word_TYPE);
-    FORTHI_DEFINE_STANDARD_WORD("U.", forthi_word_u_dot);
-    FORTHI_DEFINE_STANDARD_WORD("U*", forthi_word_u_star);
-    FORTHI_DEFINE_STANDARD_WORD("U/MOD", forthi_word_u_slash_mod);
-    FORTHI_DEFINE_STANDARD_WORD("U.R", forthi_word_u_dot_r);
-    FORTHI_DEFINE_STANDARD_WORD("U<", forthi_word_u_less_than);
-    FORTHI_DEFINE_STANDARD_WORD("U>", forthi_word_u_greater_than);
-    FORTHI_DEFINE_STANDARD_WORD("UM*", forthi_word_u_m_star);
-    FORTHI_DEFINE_STANDARD_WORD("UM/MOD", forthi_word_u_m_slash_mod);
-    FORTHI_DEFINE_STANDARD_WORD("UNESCAPE", forthi_word_UNESCAPE);
-    FORTHI_DEFINE_STANDARD_WORD("UNLOOP", forthi_word_UNLOOP);
-    FORTHI_DEFINE_STANDARD_WORD("UNTIL", forthi_word_UNTIL);
-    FORTHI_DEFINE_STANDARD_WORD("UNUSED", forthi_word_UNUSED);
-    FORTHI_DEFINE_STANDARD_WORD("UPDATE", forthi_word_UPDATE);
-    FORTHI_DEFINE_STANDARD_WORD("VALUE", forthi_word_VALUE);
-    FORTHI_DEFINE_STANDARD_WORD("VARIABLE", forthi_word_VARIABLE);
-    FORTHI_DEFINE_STANDARD_WORD("W/O", forthi_word_w_o);
-    FORTHI_DEFINE_STANDARD_WORD("WHILE", forthi_word_WHILE);
-    FORTHI_DEFINE_STANDARD_WORD("WITHIN", forthi_word_WITHIN);
-    FORTHI_DEFINE_STANDARD_WORD("WORD", forthi_word_WORD);
-    FORTHI_DEFINE_STANDARD_WORD("WORDLIST", forthi_word_WORDLIST);
-    FORTHI_DEFINE_STANDARD_WORD("WORDS", forthi_word_WORDS);
-    FORTHI_DEFINE_STANDARD_WORD("WRITE-FILE", forthi_word_WRITE_FILE);
-    FORTHI_DEFINE_STANDARD_WORD("WRITE-LINE", forthi_word_WRITE_LINE);
-    FORTHI_DEFINE_STANDARD_WORD("X-SIZE", forthi_word_X_SIZE);
-    FORTHI_DEFINE_STANDARD_WORD("X-WIDTH", forthi_word_X_WIDTH);
-    FORTHI_DEFINE_STANDARD_WORD("XC!+", forthi_word_x_c_store_plus);
-    FORTHI_DEFINE_STANDARD_WORD("XC!+?", forthi_word_x_c_store_plus_query);
-    FORTHI_DEFINE_STANDARD_WORD("XC,", forthi_word_x_c_comma);
-    FORTHI_DEFINE_STANDARD_WORD("XC-SIZE", forthi_word_x_c_size);
-    FORTHI_DEFINE_STANDARD_WORD("XC-WIDTH", forthi_word_x_c_width);
-    FORTHI_DEFINE_STANDARD_WORD("XC@+", forthi_word_x_c_fetch_plus);
-    FORTHI_DEFINE_STANDARD_WORD("XCHAR+", forthi_word_x_char_plus);
-    FORTHI_DEFINE_STANDARD_WORD("XCHAR-", forthi_word_x_char_minus);
-    FORTHI_DEFINE_STANDARD_WORD("XEMIT", forthi_word_x_emit);
-    FORTHI_DEFINE_STANDARD_WORD("XHOLD", forthi_word_x_hold);
-    FORTHI_DEFINE_STANDARD_WORD("XKEY", forthi_word_x_key);
-    FORTHI_DEFINE_STANDARD_WORD("XKEY?", forthi_word_x_key_query);
-    FORTHI_DEFINE_STANDARD_WORD("XOR", forthi_word_x_or);
-    FORTHI_DEFINE_STANDARD_WORD("X\\STRING-", forthi_word_x_string_minus);
-    FORTHI_DEFINE_STANDARD_WORD("[", forthi_word_left_bracket);
-    FORTHI_DEFINE_STANDARD_WORD("[']", forthi_word_bracket_tick);
-    FORTHI_DEFINE_STANDARD_WORD("[CHAR]", forthi_word_bracket_char);
-    FORTHI_DEFINE_STANDARD_WORD("[COMPILE]", forthi_word_bracket_compile);
-    FORTHI_DEFINE_STANDARD_WORD("[DEFINED]", forthi_word_bracket_defined);
-    FORTHI_DEFINE_STANDARD_WORD("[ELSE]", forthi_word_bracket_else);
-    FORTHI_DEFINE_STANDARD_WORD("[IF]", forthi_word_bracket_if);
-    FORTHI_DEFINE_STANDARD_WORD("[THEN]", forthi_word_bracket_then);
-    FORTHI_DEFINE_STANDARD_WORD("[UNDEFINED]", forthi_word_bracket_undefined);
-    FORTHI_DEFINE_STANDARD_WORD("\\", forthi_word_backslash);
-    FORTHI_DEFINE_STANDARD_WORD("]", forthi_word_right_bracket);
-    FORTHI_DEFINE_STANDARD_WORD("{:", forthi_word_brace_colon);
+    for (size_t i = 0; i < sizeof(forthi_standard_words) / sizeof(forth_c_word); i++)
+        if (forth_add_c_word(ctx, forthi_standard_words[i].name, forthi_standard_words[i].fn) == FORTH_FAILURE)
+            return FORTH_FAILURE;
 
     ctx->default_dict_pointer = ctx->dict_pointer;
+    ctx->default_memory_pointer = ctx->memory_pointer;
 
     //forth_pointer reminder = ctx->memory_pointer % sizeof(uintptr_t);
     //if (reminder > 0)
@@ -5132,41 +7653,138 @@ static int forthi_defineStandardWords(forth_context* ctx)
     return FORTH_SUCCESS;
 }
 
-forth_context* forth_create_context(int memory_size, int stack_size, int return_stack_size, int dict_size)
+static int forthi_check_context_sizes(int memory_size, int stack_size, int return_stack_size, int dict_size)
 {
     if (memory_size <= 0 && memory_size != FORTH_MEM_INFINITE)
-        return NULL;
+        return FORTH_FAILURE;
 
     if (stack_size <= 0 && stack_size != FORTH_MEM_INFINITE)
-        return NULL;
+        return FORTH_FAILURE;
 
     if (return_stack_size <= 0 && return_stack_size != FORTH_MEM_INFINITE)
-        return NULL;
+        return FORTH_FAILURE;
 
     if (dict_size <= 0 && dict_size != FORTH_MEM_INFINITE)
-        return NULL;
+        return FORTH_FAILURE;
+
+    return FORTH_SUCCESS;
+}
+
+// Reserves the address space of the data space and commits its first pages.
+// The commited part then grows like regular memory, up to the reserved size.
+static int forthi_reserve_memory(forth_context* ctx, int reserve_size, int commit_size)
+{
+#if FORTHI_HAS_MMAN
+    int page_size = ctx->huge_pages ? FORTHI_HUGE_PAGE_SIZE : (int)sysconf(_SC_PAGESIZE);
+    if (reserve_size == FORTH_MEM_INFINITE)
+        reserve_size = FORTH_DEFAULT_RESERVE_SIZE;
+    if (reserve_size > INT_MAX - page_size)
+        return FORTH_FAILURE;
+
+    reserve_size = forthi_commit_size(ctx, reserve_size);
+    commit_size = forthi_commit_size(ctx, commit_size);
+    if (commit_size > reserve_size)
+        commit_size = reserve_size;
+
+    // Huge pages need the mapping aligned on them. Map one more and unmap
+    // what's around the aligned range.
+    size_t map_size = (size_t)reserve_size + (ctx->huge_pages ? FORTHI_HUGE_PAGE_SIZE : 0);
+    uint8_t* memory = (uint8_t*)mmap(NULL, map_size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if ((void*)memory == MAP_FAILED)
+        return FORTH_FAILURE;
+
+    if (ctx->huge_pages)
+    {
+        uint8_t* aligned = (uint8_t*)(((uintptr_t)memory + FORTHI_HUGE_PAGE_SIZE - 1) & 
+                                      ~(uintptr_t)(FORTHI_HUGE_PAGE_SIZE - 1));
+        if (aligned > memory)
+            munmap(memory, aligned - memory);
+        if (aligned + reserve_size < memory + map_size)
+            munmap(aligned + reserve_size, memory + map_size - (aligned + reserve_size));
+        memory = aligned;
+        forthi_advise_huge_pages(memory, reserve_size);
+    }
+
+    ctx->memory = memory;
+    ctx->memory_reserved_size = reserve_size;
+    if (mprotect(ctx->memory, commit_size, PROT_READ | PROT_WRITE) != 0)
+        return FORTH_FAILURE;
+
+    ctx->memory_size = commit_size;
+    ctx->memory_auto_resize = 1;
 
-    forth_context* ctx = (forth_context*)malloc(sizeof(forth_context));
+    return FORTH_SUCCESS;
+#else
+    return FORTH_FAILURE;
+#endif
+}
+
+// Allocates a context and its buffers. Sizes set to FORTH_MEM_INFINITE are
+// auto resized, starting at the given default sizes.
+static forth_context* forthi_alloc_context(int memory_size, 
+                                           int stack_size, 
+                                           int return_stack_size, 
+                                           int dict_size,
+                                           int default_memory_size,
+                                           int default_size,
+                                           int dict_names_size,
+                                           uint8_t reserve_memory,
+                                           uint8_t huge_pages,
+                                           const forth_allocator* allocator)
+{
+    forth_allocator context_allocator = allocator ? *allocator : forthi_default_allocator();
+    forth_context* ctx = (forth_context*)context_allocator.alloc(context_allocator.user, sizeof(forth_context));
     if (!ctx)
         return NULL;
 
     memset(ctx, 0, sizeof(forth_context));
+    ctx->allocator = context_allocator;
+    ctx->huge_pages = huge_pages;
+    forthi_init_heap(&ctx->heap);
+
+    if (reserve_memory || (huge_pages && FORTHI_HAS_MMAN))
+    {
+        if (forthi_reserve_memory(ctx, memory_size, default_memory_size) == FORTH_FAILURE)
+        {
+            forth_destroy_context(ctx);
+            return NULL;
+        }
+    }
+    else
+    {
+        ctx->memory_auto_resize = memory_size == FORTH_MEM_INFINITE ? 1 : 0;
+        ctx->memory_size = ctx->memory_auto_resize ? default_memory_size : memory_size;
+        ctx->memory = (uint8_t*)forthi_alloc_buffer(ctx, ctx->memory_size);
+        if (!ctx->memory)
+        {
+            forth_destroy_context(ctx);
+            return NULL;
+        }
+    }
 
-    ctx->memory_auto_resize = memory_size == FORTH_MEM_INFINITE ? 1 : 0;
-    ctx->memory_size = ctx->memory_auto_resize 
-        ? (435 * (sizeof(forth_c_func) + 2) / FORTHI_MEM_ALLOC_CHUNK_SIZE * FORTHI_MEM_ALLOC_CHUNK_SIZE + 
-            FORTHI_MEM_ALLOC_CHUNK_SIZE) 
-        : memory_size;
-    ctx->memory = (uint8_t*)malloc(ctx->memory_size);
-    if (!ctx->memory)
+#if FORTH_GUARDED_STACKS
+    // Guarded stacks don't resize
+    forthi_install_guard_handler();
+
+    ctx->stack_size = stack_size == FORTH_MEM_INFINITE ? FORTH_GUARDED_STACK_SIZE : stack_size;
+    ctx->stack = forthi_alloc_guarded_stack(ctx->stack_size);
+    if (!ctx->stack)
     {
         forth_destroy_context(ctx);
         return NULL;
     }
 
+    ctx->return_stack_size = return_stack_size == FORTH_MEM_INFINITE ? FORTH_GUARDED_STACK_SIZE : return_stack_size;
+    ctx->return_stack = forthi_alloc_guarded_stack(ctx->return_stack_size);
+    if (!ctx->return_stack)
+    {
+        forth_destroy_context(ctx);
+        return NULL;
+    }
+#else
     ctx->stack_auto_resize = stack_size == FORTH_MEM_INFINITE ? 1 : 0;
-    ctx->stack_size = ctx->stack_auto_resize ? FORTHI_MEM_ALLOC_CHUNK_SIZE : stack_size;
-    ctx->stack = (forth_cell*)malloc(sizeof(forth_cell) * ctx->stack_size);
+    ctx->stack_size = ctx->stack_auto_resize ? default_size : stack_size;
+    ctx->stack = (forth_cell*)forthi_alloc_buffer(ctx, sizeof(forth_cell) * ctx->stack_size);
     if (!ctx->stack)
     {
         forth_destroy_context(ctx);
@@ -5174,43 +7792,53 @@ forth_context* forth_create_context(int memory_size, int stack_size, int return_
     }
 
     ctx->return_stack_auto_resize = return_stack_size == FORTH_MEM_INFINITE ? 1 : 0;
-    ctx->return_stack_size = ctx->return_stack_auto_resize ? FORTHI_MEM_ALLOC_CHUNK_SIZE : return_stack_size;
-    ctx->return_stack = (forth_cell*)malloc(sizeof(forth_cell) * ctx->return_stack_size);
+    ctx->return_stack_size = ctx->return_stack_auto_resize ? default_size : return_stack_size;
+    ctx->return_stack = (forth_cell*)forthi_alloc_buffer(ctx, sizeof(forth_cell) * ctx->return_stack_size);
     if (!ctx->return_stack)
     {
         forth_destroy_context(ctx);
         return NULL;
     }
+#endif
+
+    if (huge_pages)
+    {
+        forthi_advise_huge_pages(ctx->stack, sizeof(forth_cell) * ctx->stack_size);
+        forthi_advise_huge_pages(ctx->return_stack, sizeof(forth_cell) * ctx->return_stack_size);
+    }
 
     ctx->dict_auto_resize = dict_size == FORTH_MEM_INFINITE ? 1 : 0;
-    ctx->dict_size = ctx->dict_auto_resize ? FORTHI_MEM_ALLOC_CHUNK_SIZE : dict_size;
-    ctx->dict_name_lens = (uint8_t*)malloc(ctx->dict_size);
-    if (!ctx->dict_name_lens)
+    ctx->dict_size = ctx->dict_auto_resize ? default_size : dict_size;
+    ctx->dict_name_offsets = (int*)forthi_alloc_buffer(ctx, sizeof(int) * ctx->dict_size);
+    if (!ctx->dict_name_offsets)
     {
         forth_destroy_context(ctx);
         return NULL;
     }
-    ctx->dict_names = (char*)malloc(FORTH_DICT_CHAR_COUNT * ctx->dict_size);
-    if (!ctx->dict_names)
+    ctx->dict_name_lens = (int*)forthi_alloc_buffer(ctx, sizeof(int) * ctx->dict_size);
+    if (!ctx->dict_name_lens)
     {
         forth_destroy_context(ctx);
         return NULL;
     }
-    ctx->dict_pointers = (forth_pointer*)malloc(sizeof(forth_pointer) * ctx->dict_size);
+    ctx->dict_pointers = (forth_pointer*)forthi_alloc_buffer(ctx, sizeof(forth_pointer) * ctx->dict_size);
     if (!ctx->dict_pointers)
     {
         forth_destroy_context(ctx);
         return NULL;
     }
 
-    ctx->base = ctx->memory_pointer;
-    if (forthi_write_number(ctx, 10) == FORTH_FAILURE)
+    ctx->dict_names_size = dict_names_size;
+    ctx->dict_names = (char*)forthi_alloc_buffer(ctx, ctx->dict_names_size);
+    if (!ctx->dict_names)
     {
         forth_destroy_context(ctx);
         return NULL;
     }
 
-    if (forthi_defineStandardWords(ctx) == FORTH_FAILURE)
+    ctx->fn_offsets_size = ctx->dict_size;
+    ctx->fn_offsets = (forth_pointer*)forthi_alloc_buffer(ctx, sizeof(forth_pointer) * ctx->fn_offsets_size);
+    if (!ctx->fn_offsets)
     {
         forth_destroy_context(ctx);
         return NULL;
@@ -5219,30 +7847,1364 @@ forth_context* forth_create_context(int memory_size, int stack_size, int return_
     return ctx;
 }
 
-void forth_destroy_context(forth_context* ctx)
+forth_context* forth_create_context(int memory_size, int stack_size, int return_stack_size, int dict_size)
 {
-    if (!ctx)
-        return;
-
-    if (ctx->memory)
-        free(ctx->memory);
+    forth_context_options options = forth_default_context_options();
+    options.memory_size = memory_size;
+    options.stack_size = stack_size;
+    options.return_stack_size = return_stack_size;
+    options.dict_size = dict_size;
 
-    if (ctx->stack)
-        free(ctx->stack);
+    return forth_create_context_ex(&options);
+}
 
-    if (ctx->return_stack)
-        free(ctx->return_stack);
+forth_context_options forth_default_context_options()
+{
+    forth_context_options options;
+    memset(&options, 0, sizeof(forth_context_options));
 
-    if (ctx->dict_name_lens)
-        free(ctx->dict_name_lens);
+    options.memory_size = FORTH_MEM_INFINITE;
+    options.stack_size = FORTH_MEM_INFINITE;
+    options.return_stack_size = FORTH_MEM_INFINITE;
+    options.dict_size = FORTH_MEM_INFINITE;
 
-    if (ctx->dict_names)
-        free(ctx->dict_names);
+    return options;
+}
+
+forth_context* forth_create_context_ex(const forth_context_options* options)
+{
+    if (!options)
+        return NULL;
+
+    if (forthi_check_context_sizes(options->memory_size, options->stack_size, 
+                                   options->return_stack_size, options->dict_size) == FORTH_FAILURE)
+        return NULL;
+
+    forth_context* ctx = forthi_alloc_context(options->memory_size, options->stack_size, 
+        options->return_stack_size, options->dict_size,
+        435 * (sizeof(forth_c_func) + 2) / FORTHI_MEM_ALLOC_CHUNK_SIZE * FORTHI_MEM_ALLOC_CHUNK_SIZE + 
+            FORTHI_MEM_ALLOC_CHUNK_SIZE,
+        FORTHI_MEM_ALLOC_CHUNK_SIZE,
+        FORTHI_DICT_NAMES_ALLOC_SIZE,
+        options->reserve_memory,
+        options->huge_pages,
+        options->allocator);
+    if (!ctx)
+        return NULL;
+
+    ctx->include_cache_dir = options->include_cache_dir;
+    ctx->base = ctx->memory_pointer;
+    if (forthi_write_number(ctx, 10) == FORTH_FAILURE)
+    {
+        forth_destroy_context(ctx);
+        return NULL;
+    }
+
+    if (forthi_defineStandardWords(ctx) == FORTH_FAILURE)
+    {
+        forth_destroy_context(ctx);
+        return NULL;
+    }
+
+    return ctx;
+}
+
+int forth_reserve(forth_context* ctx, int memory_bytes, int stack_cells, int return_stack_cells, int dict_words,
+                  int transient_bytes, int heap_bytes)
+{
+    if (!ctx || memory_bytes < 0 || stack_cells < 0 || return_stack_cells < 0 || dict_words < 0 ||
+        transient_bytes < 0 || heap_bytes < 0)
+        return FORTH_FAILURE;
+
+    // Buffers that can't grow must already be big enough
+    while ((forth_pointer)ctx->memory_size - ctx->memory_pointer < (forth_pointer)memory_bytes)
+        if (!ctx->memory_auto_resize || forthi_grow_memory(ctx) == FORTH_FAILURE)
+            return FORTH_FAILURE;
+
+    while (ctx->stack_size - ctx->stack_pointer < stack_cells)
+        if (!ctx->stack_auto_resize || forthi_grow_stack(ctx) == FORTH_FAILURE)
+            return FORTH_FAILURE;
+
+    while (ctx->return_stack_size - ctx->return_stack_pointer < return_stack_cells)
+        if (!ctx->return_stack_auto_resize || forthi_grow_return_stack(ctx) == FORTH_FAILURE)
+            return FORTH_FAILURE;
+
+    while (ctx->dict_size - ctx->dict_pointer < dict_words)
+        if (!ctx->dict_auto_resize || forthi_grow_dictionnary(ctx) == FORTH_FAILURE)
+            return FORTH_FAILURE;
+
+    // Names are assumed to be of a typical length
+    if (dict_words > INT_MAX / FORTHI_RESERVED_NAME_LEN)
+        return FORTH_FAILURE;
+    while (ctx->dict_names_size - ctx->dict_names_pointer < dict_words * FORTHI_RESERVED_NAME_LEN)
+        if (forthi_grow_dictionnary_names(ctx) == FORTH_FAILURE)
+            return FORTH_FAILURE;
+
+    // At most one C function per call instruction written in that memory
+    int fn_count = memory_bytes / (1 + (int)sizeof(forth_c_func));
+    while (ctx->fn_offsets_size - ctx->fn_offsets_pointer < fn_count)
+        if (forthi_grow_fn_offsets(ctx) == FORTH_FAILURE)
+            return FORTH_FAILURE;
+
+    // Transient data starts over with each evaluation
+    if (forthi_grow_transient(ctx, transient_bytes) == FORTH_FAILURE ||
+        forthi_grow_heap(ctx, heap_bytes) == FORTH_FAILURE)
+        return FORTH_FAILURE;
+
+    return FORTH_SUCCESS;
+}
+
+// Shrinks a buffer, keeping the old one if it can't be
+static void* forthi_shrink_buffer(forth_context* ctx, void* buffer, size_t new_size)
+{
+    if (forthi_is_in_clone_block(ctx, buffer))
+        return buffer;
+
+    void* new_buffer = forthi_realloc_buffer(ctx, buffer, new_size, new_size);
+    return new_buffer ? new_buffer : buffer;
+}
+
+static void forthi_trim_memory(forth_context* ctx)
+{
+    int own_size = ctx->memory_size - (int)ctx->shared_memory_size;
+    int used = (int)(ctx->memory_pointer - ctx->shared_memory_size);
+    int new_size = used + FORTHI_TRIM_SLACK;
+    if (new_size >= own_size)
+        return;
+
+#if FORTHI_HAS_MMAN
+    // Reserved memory gives its pages back and keeps its address range
+    if (ctx->memory_reserved_size)
+    {
+        new_size = forthi_commit_size(ctx, new_size);
+        if (new_size >= own_size)
+            return;
+
+        madvise(ctx->memory + new_size, own_size - new_size, MADV_DONTNEED);
+        mprotect(ctx->memory + new_size, own_size - new_size, PROT_NONE);
+        ctx->memory_size -= own_size - new_size;
+        return;
+    }
+#endif
+
+    if (!ctx->memory_auto_resize || forthi_is_in_clone_block(ctx, ctx->memory))
+    {
+        forthi_release_memory(ctx);
+        return;
+    }
+
+    ctx->memory = (uint8_t*)forthi_shrink_buffer(ctx, ctx->memory, new_size);
+    ctx->memory_size -= own_size - new_size;
+}
+
+static void forthi_trim_stacks(forth_context* ctx)
+{
+#if FORTH_GUARDED_STACKS
+    // Guarded stacks keep their size, only the pages are released
+    forthi_release_pages(ctx->stack + ctx->stack_pointer + FORTHI_TRIM_SLACK, ctx->stack + ctx->stack_size);
+    forthi_release_pages(ctx->return_stack + ctx->return_stack_pointer + FORTHI_TRIM_SLACK, 
+        ctx->return_stack + ctx->return_stack_size);
+#else
+    int new_size = ctx->stack_pointer + FORTHI_TRIM_SLACK;
+    if (ctx->stack_auto_resize && new_size < ctx->stack_size && !forthi_is_in_clone_block(ctx, ctx->stack))
+    {
+        ctx->stack = (forth_cell*)forthi_shrink_buffer(ctx, ctx->stack, sizeof(forth_cell) * new_size);
+        ctx->stack_size = new_size;
+    }
+
+    new_size = ctx->return_stack_pointer + FORTHI_TRIM_SLACK;
+    if (ctx->return_stack_auto_resize && new_size < ctx->return_stack_size && 
+        !forthi_is_in_clone_block(ctx, ctx->return_stack))
+    {
+        ctx->return_stack = (forth_cell*)forthi_shrink_buffer(ctx, ctx->return_stack, 
+            sizeof(forth_cell) * new_size);
+        ctx->return_stack_size = new_size;
+    }
+#endif
+}
+
+static void forthi_trim_dictionnary(forth_context* ctx)
+{
+    int new_size = ctx->dict_pointer + FORTHI_TRIM_SLACK;
+    if (ctx->dict_auto_resize && new_size < ctx->dict_size && 
+        !forthi_is_in_clone_block(ctx, ctx->dict_pointers))
+    {
+        // Entries are stored at the end of the arrays, move them down first.
+        // Arrays that fail to shrink are just bigger than needed.
+        int from = ctx->dict_size - ctx->dict_pointer;
+        int to = new_size - ctx->dict_pointer;
+        memmove(ctx->dict_name_offsets + to, ctx->dict_name_offsets + from, sizeof(int) * ctx->dict_pointer);
+        memmove(ctx->dict_name_lens + to, ctx->dict_name_lens + from, sizeof(int) * ctx->dict_pointer);
+        memmove(ctx->dict_pointers + to, ctx->dict_pointers + from, sizeof(forth_pointer) * ctx->dict_pointer);
+        ctx->dict_size = new_size;
+
+        ctx->dict_name_offsets = (int*)forthi_shrink_buffer(ctx, ctx->dict_name_offsets, sizeof(int) * new_size);
+        ctx->dict_name_lens = (int*)forthi_shrink_buffer(ctx, ctx->dict_name_lens, sizeof(int) * new_size);
+        ctx->dict_pointers = (forth_pointer*)forthi_shrink_buffer(ctx, ctx->dict_pointers, 
+            sizeof(forth_pointer) * new_size);
+
+        // Cached positions count from the start of the dictionnary, they 
+        // still hold
+    }
+
+    new_size = ctx->dict_names_pointer + FORTHI_TRIM_SLACK;
+    if (new_size < ctx->dict_names_size && !forthi_is_in_clone_block(ctx, ctx->dict_names))
+    {
+        ctx->dict_names = (char*)forthi_shrink_buffer(ctx, ctx->dict_names, new_size);
+        ctx->dict_names_size = new_size;
+    }
+
+    new_size = ctx->fn_offsets_pointer + FORTHI_TRIM_SLACK;
+    if (new_size < ctx->fn_offsets_size && !forthi_is_in_clone_block(ctx, ctx->fn_offsets))
+    {
+        ctx->fn_offsets = (forth_pointer*)forthi_shrink_buffer(ctx, ctx->fn_offsets, 
+            sizeof(forth_pointer) * new_size);
+        ctx->fn_offsets_size = new_size;
+    }
+}
+
+int forth_trim(forth_context* ctx)
+{
+    if (!ctx || ctx->frozen || ctx->eval_depth > 0)
+        return FORTH_FAILURE;
+
+    forthi_update_high_water(ctx);
+
+    forthi_trim_memory(ctx);
+    forthi_trim_stacks(ctx);
+    forthi_trim_dictionnary(ctx);
+
+    // Transient data doesn't outlive an evaluation
+    if (ctx->transient)
+    {
+        forthi_free_buffer(ctx, ctx->transient);
+        ctx->transient = NULL;
+        ctx->transient_size = 0;
+        forthi_reset_transient(ctx);
+    }
+
+    return FORTH_SUCCESS;
+}
+
+void forth_freeze_context(forth_context* ctx)
+{
+    if (!ctx)
+        return;
+
+    ctx->frozen = 1;
+}
+
+forth_context* forth_create_child_context(const forth_context* base, int memory_size, int stack_size, int return_stack_size, int dict_size)
+{
+    if (!base || !base->frozen)
+        return NULL;
+
+    if (forthi_check_context_sizes(memory_size, stack_size, return_stack_size, dict_size) == FORTH_FAILURE)
+        return NULL;
+
+    forth_context* ctx = forthi_alloc_context(memory_size, stack_size, return_stack_size, dict_size,
+        FORTHI_MEM_ALLOC_CHUNK_SIZE,
+        FORTHI_CHILD_ALLOC_SIZE,
+        FORTHI_MEM_ALLOC_CHUNK_SIZE,
+        0,
+        0,
+        &base->allocator);
+    if (!ctx)
+        return NULL;
+
+    // The child's own memory starts right where the base's memory ends
+    ctx->parent = base;
+    ctx->shared_memory_size = base->memory_pointer;
+    ctx->memory_size += (int)ctx->shared_memory_size;
+    ctx->memory_pointer = ctx->shared_memory_size;
+    ctx->log = base->log;
+
+    // Each child gets its own BASE
+    forth_int base_value = *(forth_int*)forthi_memory_at(base, base->base);
+    ctx->base = ctx->memory_pointer;
+    if (forthi_write_number(ctx, base_value) == FORTH_FAILURE)
+    {
+        forth_destroy_context(ctx);
+        return NULL;
+    }
+
+    ctx->default_memory_pointer = ctx->memory_pointer;
+
+    return ctx;
+}
+
+static size_t forthi_align_block_size(size_t size)
+{
+    return (size + 15) & ~(size_t)15;
+}
+
+forth_context* forth_clone_context(const forth_context* ctx)
+{
+    if (!ctx)
+        return NULL;
+
+    size_t own_memory_size = (size_t)ctx->memory_size - ctx->shared_memory_size;
+    size_t used_memory_size = ctx->memory_pointer - ctx->shared_memory_size;
+    int used_dict_index = ctx->dict_size - ctx->dict_pointer;
+
+    size_t context_block_size = forthi_align_block_size(sizeof(forth_context));
+    size_t memory_block_size = forthi_align_block_size(own_memory_size);
+#if FORTH_GUARDED_STACKS
+    // Guarded stacks are mapped on their own
+    size_t stack_block_size = 0;
+    size_t return_stack_block_size = 0;
+#else
+    size_t stack_block_size = forthi_align_block_size(sizeof(forth_cell) * ctx->stack_size);
+    size_t return_stack_block_size = forthi_align_block_size(sizeof(forth_cell) * ctx->return_stack_size);
+#endif
+    size_t offsets_block_size = forthi_align_block_size(sizeof(int) * ctx->dict_size);
+    size_t pointers_block_size = forthi_align_block_size(sizeof(forth_pointer) * ctx->dict_size);
+    size_t names_block_size = forthi_align_block_size(ctx->dict_names_size);
+    size_t fn_offsets_block_size = forthi_align_block_size(sizeof(forth_pointer) * ctx->fn_offsets_size);
+    size_t included_files_block_size = forthi_align_block_size(sizeof(forth_included_file) * ctx->included_files_size);
+    size_t heap_block_size = forthi_align_block_size(ctx->heap.size);
+    size_t block_starts_block_size = forthi_align_block_size(forthi_heap_block_starts_size(ctx->heap.size));
+
+    size_t block_size = context_block_size + memory_block_size + stack_block_size + return_stack_block_size +
+        offsets_block_size * 2 + pointers_block_size + names_block_size + fn_offsets_block_size +
+        included_files_block_size + heap_block_size + block_starts_block_size;
+
+    uint8_t* block = (uint8_t*)ctx->allocator.alloc(ctx->allocator.user, block_size);
+    if (!block)
+        return NULL;
+
+    forth_context* clone = (forth_context*)block;
+    memcpy(clone, ctx, sizeof(forth_context));
+    clone->block_size = block_size;
+    clone->memory_reserved_size = 0;
+    clone->image = NULL;
+    clone->image_size = 0;
+    clone->frozen = 0;
+    clone->transient = NULL;
+    clone->transient_size = 0;
+    forthi_reset_transient(clone);
+    memset(&clone->input, 0, sizeof(clone->input));
+    forthi_clear_dict_cache(clone);
+    block += context_block_size;
+
+    clone->memory = block;
+    memcpy(clone->memory, ctx->memory, used_memory_size);
+    block += memory_block_size;
+
+#if FORTH_GUARDED_STACKS
+    forthi_install_guard_handler();
+
+    clone->stack = forthi_alloc_guarded_stack(ctx->stack_size);
+    clone->return_stack = clone->stack ? forthi_alloc_guarded_stack(ctx->return_stack_size) : NULL;
+    if (!clone->return_stack)
+    {
+        if (clone->stack)
+            forthi_free_guarded_stack(clone->stack, clone->stack_size);
+        clone->allocator.free(clone->allocator.user, clone);
+        return NULL;
+    }
+#else
+    clone->stack = (forth_cell*)block;
+    block += stack_block_size;
+
+    clone->return_stack = (forth_cell*)block;
+    block += return_stack_block_size;
+#endif
+    memcpy(clone->stack, ctx->stack, sizeof(forth_cell) * ctx->stack_pointer);
+    memcpy(clone->return_stack, ctx->return_stack, sizeof(forth_cell) * ctx->return_stack_pointer);
+
+    // Dictionnary entries are stored at the end of the arrays
+    clone->dict_name_offsets = (int*)block;
+    memcpy(clone->dict_name_offsets + used_dict_index, ctx->dict_name_offsets + used_dict_index, 
+        sizeof(int) * ctx->dict_pointer);
+    block += offsets_block_size;
+
+    clone->dict_name_lens = (int*)block;
+    memcpy(clone->dict_name_lens + used_dict_index, ctx->dict_name_lens + used_dict_index, 
+        sizeof(int) * ctx->dict_pointer);
+    block += offsets_block_size;
+
+    clone->dict_pointers = (forth_pointer*)block;
+    memcpy(clone->dict_pointers + used_dict_index, ctx->dict_pointers + used_dict_index, 
+        sizeof(forth_pointer) * ctx->dict_pointer);
+    block += pointers_block_size;
+
+    clone->dict_names = (char*)block;
+    memcpy(clone->dict_names, ctx->dict_names, ctx->dict_names_pointer);
+    block += names_block_size;
+
+    clone->fn_offsets = (forth_pointer*)block;
+    memcpy(clone->fn_offsets, ctx->fn_offsets, sizeof(forth_pointer) * ctx->fn_offsets_pointer);
+    block += fn_offsets_block_size;
+
+    clone->included_files = ctx->included_files ? (forth_included_file*)block : NULL;
+    if (ctx->included_files)
+        memcpy(clone->included_files, ctx->included_files, sizeof(forth_included_file) * ctx->included_files_pointer);
+    block += included_files_block_size;
+
+    // Free lists are offsets, they stay valid in the copy
+    clone->heap.memory = ctx->heap.memory ? block : NULL;
+    if (ctx->heap.memory)
+        memcpy(clone->heap.memory, ctx->heap.memory, ctx->heap.pointer);
+    block += heap_block_size;
+
+    clone->heap.block_starts = ctx->heap.block_starts ? block : NULL;
+    if (ctx->heap.block_starts)
+        memcpy(clone->heap.block_starts, ctx->heap.block_starts, forthi_heap_block_starts_size(ctx->heap.size));
+
+    return clone;
+}
+
+void forth_destroy_context(forth_context* ctx)
+{
+    if (!ctx)
+        return;
+
+    if (ctx->memory)
+    {
+#if FORTHI_HAS_MMAN
+        if (ctx->memory_reserved_size)
+            munmap(ctx->memory, ctx->memory_reserved_size);
+        else
+#endif
+            forthi_free_buffer(ctx, ctx->memory);
+    }
+
+#if FORTH_GUARDED_STACKS
+    if (ctx->stack)
+        forthi_free_guarded_stack(ctx->stack, ctx->stack_size);
+
+    if (ctx->return_stack)
+        forthi_free_guarded_stack(ctx->return_stack, ctx->return_stack_size);
+#else
+    if (ctx->stack)
+        forthi_free_buffer(ctx, ctx->stack);
+
+    if (ctx->return_stack)
+        forthi_free_buffer(ctx, ctx->return_stack);
+#endif
+
+    if (ctx->dict_name_offsets)
+        forthi_free_buffer(ctx, ctx->dict_name_offsets);
+
+    if (ctx->dict_name_lens)
+        forthi_free_buffer(ctx, ctx->dict_name_lens);
 
     if (ctx->dict_pointers)
-        free(ctx->dict_pointers);
+        forthi_free_buffer(ctx, ctx->dict_pointers);
+
+    if (ctx->dict_names)
+        forthi_free_buffer(ctx, ctx->dict_names);
+
+    if (ctx->fn_offsets)
+        forthi_free_buffer(ctx, ctx->fn_offsets);
+
+    if (ctx->included_files)
+        forthi_free_buffer(ctx, ctx->included_files);
+
+    if (ctx->heap.memory)
+        forthi_free_buffer(ctx, ctx->heap.memory);
+
+    if (ctx->heap.block_starts)
+        forthi_free_buffer(ctx, ctx->heap.block_starts);
+
+    if (ctx->transient)
+        forthi_free_buffer(ctx, ctx->transient);
+
+#if FORTHI_HAS_MMAN
+    if (ctx->image)
+        munmap(ctx->image, ctx->image_size);
+#endif
+
+    forth_allocator allocator = ctx->allocator;
+    allocator.free(allocator.user, ctx);
+}
+
+//---------------------------------------------------------------------------
+// IMAGES
+//---------------------------------------------------------------------------
+
+// Followed by the sections, in an order keeping them aligned: dictionnary
+// pointers, C function offsets, dictionnary name offsets and lengths, C
+// function name indices, dictionnary names and C function names. Each C
+// function name is a kind byte and a null terminated string. The data space
+// comes last, at memory_offset, aligned so it can be mapped on its own pages.
+typedef struct forthi_image_header
+{
+    char magic[8];
+    uint32_t version;
+    uint8_t int_size;
+    uint8_t pointer_size;
+    uint8_t function_size;
+    uint8_t padding;
+    uint64_t memory_offset;
+    uint64_t memory_pointer;
+    uint64_t default_memory_pointer;
+    uint64_t base;
+    int32_t dict_pointer;
+    int32_t default_dict_pointer;
+    int32_t dict_names_pointer;
+    int32_t fn_offset_count;
+    int32_t fn_name_count;
+    int32_t fn_names_size;
+} forthi_image_header;
+
+typedef struct forthi_image
+{
+    forthi_image_header header;
+    const forth_pointer* dict_pointers;
+    const forth_pointer* fn_offsets;
+    const int* dict_name_offsets;
+    const int* dict_name_lens;
+    const int32_t* fn_name_indices;
+    const char* dict_names;
+    const char* fn_names;
+    const uint8_t* memory;
+} forthi_image;
+
+typedef struct forthi_image_function
+{
+    uintptr_t key;
+    const char* name;
+    int name_len;
+    uint8_t kind;
+    int index;              // In the image names, -1 if not used
+} forthi_image_function;
+
+static int forthi_compare_image_functions(const void* a, const void* b)
+{
+    const forthi_image_function* function_a = (const forthi_image_function*)a;
+    const forthi_image_function* function_b = (const forthi_image_function*)b;
+    if (function_a->key != function_b->key)
+        return function_a->key < function_b->key ? -1 : 1;
+
+    // Builtins first, they're found first and don't need to be given back
+    return (int)function_a->kind - (int)function_b->kind;
+}
+
+static void forthi_set_image_function(forthi_image_function* function, forth_c_func fn, 
+                                      const char* name, int name_len, uint8_t kind)
+{
+    function->key = forthi_function_key(fn);
+    function->name = name;
+    function->name_len = name_len;
+    function->kind = kind;
+    function->index = -1;
+}
+
+// Every C function the context can have written: the builtin ones, then the
+// ones of the C words it got
+static int forthi_collect_image_functions(forth_context* ctx, forthi_image_function* functions)
+{
+    int count = 0;
+    for (size_t i = 0; i < sizeof(forthi_standard_words) / sizeof(forth_c_word); i++)
+        forthi_set_image_function(&functions[count++], forthi_standard_words[i].fn, forthi_standard_words[i].name,
+            (int)strlen(forthi_standard_words[i].name), FORTHI_IMAGE_BUILTIN);
+    for (size_t i = 0; i < sizeof(forthi_internal_functions) / sizeof(forth_c_word); i++)
+        forthi_set_image_function(&functions[count++], forthi_internal_functions[i].fn, 
+            forthi_internal_functions[i].name, (int)strlen(forthi_internal_functions[i].name), FORTHI_IMAGE_BUILTIN);
+
+    for (int i = ctx->dict_size - ctx->dict_pointer; i < ctx->dict_size; i++)
+    {
+        const uint8_t* code = forthi_memory_at(ctx, ctx->dict_pointers[i]);
+        if (*code != FORTHI_INST_CALL_C_FUNCTION)
+            continue;
+
+        forthi_set_image_function(&functions[count++], forthi_function_at(code + 1), 
+            ctx->dict_names + ctx->dict_name_offsets[i], ctx->dict_name_lens[i], FORTHI_IMAGE_USER);
+    }
+
+    qsort(functions, count, sizeof(forthi_image_function), forthi_compare_image_functions);
+    return count;
+}
+
+static forthi_image_function* forthi_find_image_function(forthi_image_function* functions, int count, uintptr_t key)
+{
+    int low = 0;
+    int high = count;
+    while (low < high)
+    {
+        int middle = (low + high) / 2;
+        if (functions[middle].key < key)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    if (low < count && functions[low].key == key)
+        return &functions[low];
+    return NULL;
+}
+
+static uint64_t forthi_align_image_offset(uint64_t offset)
+{
+    return (offset + FORTHI_IMAGE_ALIGNMENT - 1) / FORTHI_IMAGE_ALIGNMENT * FORTHI_IMAGE_ALIGNMENT;
+}
+
+static int forthi_write_image(forth_context* ctx, FILE* file, forthi_image_function* functions, int function_count,
+                              int32_t* name_indices, forthi_image_function** names)
+{
+    forthi_image_header header;
+    memset(&header, 0, sizeof(forthi_image_header));
+    memcpy(header.magic, FORTHI_IMAGE_MAGIC, sizeof(header.magic));
+    header.version = FORTHI_IMAGE_VERSION;
+    header.int_size = (uint8_t)sizeof(forth_int);
+    header.pointer_size = (uint8_t)sizeof(forth_pointer);
+    header.function_size = (uint8_t)sizeof(forth_c_func);
+    header.memory_pointer = (uint64_t)ctx->memory_pointer;
+    header.default_memory_pointer = (uint64_t)ctx->default_memory_pointer;
+    header.base = (uint64_t)ctx->base;
+    header.dict_pointer = ctx->dict_pointer;
+    header.default_dict_pointer = ctx->default_dict_pointer;
+    header.dict_names_pointer = ctx->dict_names_pointer;
+    header.fn_offset_count = ctx->fn_offsets_pointer;
+
+    for (int i = 0; i < ctx->fn_offsets_pointer; i++)
+    {
+        forth_c_func fn = forthi_function_at(forthi_memory_at(ctx, ctx->fn_offsets[i]));
+        forthi_image_function* function = forthi_find_image_function(functions, function_count, 
+            forthi_function_key(fn));
+        if (!function)
+        {
+            FORTH_LOG(ctx, "Unknown C function\n");
+            return FORTH_FAILURE;
+        }
+
+        if (function->index < 0)
+        {
+            function->index = header.fn_name_count++;
+            names[function->index] = function;
+            header.fn_names_size += 1 + function->name_len + 1;
+        }
+        name_indices[i] = function->index;
+    }
+
+    uint64_t metadata_end = sizeof(forthi_image_header) + 
+        (uint64_t)(sizeof(forth_pointer) + sizeof(int) * 2) * ctx->dict_pointer + 
+        (uint64_t)(sizeof(forth_pointer) + sizeof(int32_t)) * ctx->fn_offsets_pointer + 
+        ctx->dict_names_pointer + header.fn_names_size;
+    header.memory_offset = forthi_align_image_offset(metadata_end);
+
+    int dict_index = ctx->dict_size - ctx->dict_pointer;
+    uint8_t result = 
+        fwrite(&header, sizeof(forthi_image_header), 1, file) == 1 &&
+        fwrite(ctx->dict_pointers + dict_index, sizeof(forth_pointer), ctx->dict_pointer, file) == 
+            (size_t)ctx->dict_pointer &&
+        fwrite(ctx->fn_offsets, sizeof(forth_pointer), ctx->fn_offsets_pointer, file) == 
+            (size_t)ctx->fn_offsets_pointer &&
+        fwrite(ctx->dict_name_offsets + dict_index, sizeof(int), ctx->dict_pointer, file) == (size_t)ctx->dict_pointer &&
+        fwrite(ctx->dict_name_lens + dict_index, sizeof(int), ctx->dict_pointer, file) == (size_t)ctx->dict_pointer &&
+        fwrite(name_indices, sizeof(int32_t), ctx->fn_offsets_pointer, file) == (size_t)ctx->fn_offsets_pointer &&
+        fwrite(ctx->dict_names, 1, ctx->dict_names_pointer, file) == (size_t)ctx->dict_names_pointer;
+
+    for (int i = 0; result && i < header.fn_name_count; i++)
+    {
+        const char zero = '\0';
+        result = fwrite(&names[i]->kind, 1, 1, file) == 1 &&
+                 fwrite(names[i]->name, 1, names[i]->name_len, file) == (size_t)names[i]->name_len &&
+                 fwrite(&zero, 1, 1, file) == 1;
+    }
+
+    for (uint64_t i = metadata_end; result && i < header.memory_offset; i++)
+        result = fputc(0, file) != EOF;
+
+    result = result && fwrite(ctx->memory, 1, ctx->memory_pointer, file) == ctx->memory_pointer;
+    if (!result)
+    {
+        FORTH_LOG(ctx, "Error writing file\n");
+        return FORTH_FAILURE;
+    }
+
+    return FORTH_SUCCESS;
+}
+
+static int forthi_save_image(forth_context* ctx, const char* path)
+{
+    int max_function_count = (int)(sizeof(forthi_standard_words) / sizeof(forth_c_word) + 
+                                   sizeof(forthi_internal_functions) / sizeof(forth_c_word)) + ctx->dict_pointer;
+    forthi_image_function* functions = (forthi_image_function*)forthi_alloc_buffer(ctx, 
+        sizeof(forthi_image_function) * max_function_count);
+    forthi_image_function** names = (forthi_image_function**)forthi_alloc_buffer(ctx, 
+        sizeof(forthi_image_function*) * max_function_count);
+    int32_t* name_indices = (int32_t*)forthi_alloc_buffer(ctx, sizeof(int32_t) * (ctx->fn_offsets_pointer + 1));
+    FILE* file = NULL;
+
+    int result = FORTH_FAILURE;
+    if (!functions || !names || !name_indices)
+    {
+        FORTH_LOG(ctx, "Out of memory\n");
+    }
+    else if (!(file = fopen(path, "wb")))
+    {
+        FORTH_LOG(ctx, "Error writing file\n");
+    }
+    else
+    {
+        int function_count = forthi_collect_image_functions(ctx, functions);
+        result = forthi_write_image(ctx, file, functions, function_count, name_indices, names);
+        if (fclose(file) != 0 && result == FORTH_SUCCESS)
+        {
+            FORTH_LOG(ctx, "Error writing file\n");
+            result = FORTH_FAILURE;
+        }
+    }
+
+    if (functions)
+        forthi_free_buffer(ctx, functions);
+    if (names)
+        forthi_free_buffer(ctx, names);
+    if (name_indices)
+        forthi_free_buffer(ctx, name_indices);
+
+    return result;
+}
+
+// What follows a compiled call to a C function
+#define FORTHI_OPERAND_NONE 0
+#define FORTHI_OPERAND_BRANCH 1     // Pointer in the same word
+#define FORTHI_OPERAND_TEXT 2       // Length and text
+#define FORTHI_OPERAND_MARKER 3     // Memory and dictionnary pointers to go back to
+
+static int forthi_operand_kind(forth_c_func fn)
+{
+    if (fn == forthi_word_IF ||
+        fn == forthi_word_ELSE ||
+        fn == forthi_word_LOOP ||
+        fn == forthi_word_plus_loop ||
+        fn == forthi_word_slash_loop ||
+        fn == forthi_word_UNTIL ||
+        fn == forthi_word_WHILE ||
+        fn == forthi_word_REPEAT)
+        return FORTHI_OPERAND_BRANCH;
+
+    if (fn == forthi_word_abort_quote ||
+        fn == forthi_word_dot_quote ||
+        fn == forthi_word_s_quote)
+        return FORTHI_OPERAND_TEXT;
+
+    if (fn == forthi_word_marker_restore)
+        return FORTHI_OPERAND_MARKER;
+
+    return FORTHI_OPERAND_NONE;
+}
+
+typedef struct forthi_shake
+{
+    forth_context* ctx;
+    forth_pointer* starts;          // Code of every word, sorted
+    forth_pointer* new_starts;      // Where it's copied
+    uint8_t* reached;
+    int* pending;
+    int word_count;
+    int pending_count;
+    uintptr_t* functions;           // Keys of the C functions called
+    int function_count;
+} forthi_shake;
+
+static int forthi_compare_pointers(const void* a, const void* b)
+{
+    forth_pointer pointer_a = *(const forth_pointer*)a;
+    forth_pointer pointer_b = *(const forth_pointer*)b;
+    return pointer_a < pointer_b ? -1 : (pointer_a > pointer_b ? 1 : 0);
+}
+
+static int forthi_compare_keys(const void* a, const void* b)
+{
+    uintptr_t key_a = *(const uintptr_t*)a;
+    uintptr_t key_b = *(const uintptr_t*)b;
+    return key_a < key_b ? -1 : (key_a > key_b ? 1 : 0);
+}
+
+static int forthi_find_shake_word(forthi_shake* shake, forth_pointer start)
+{
+    const forth_pointer* found = (const forth_pointer*)bsearch(&start, shake->starts, shake->word_count, 
+        sizeof(forth_pointer), forthi_compare_pointers);
+    return found ? (int)(found - shake->starts) : -1;
+}
+
+static void forthi_reach_shake_word(forthi_shake* shake, int word)
+{
+    if (shake->reached[word])
+        return;
+
+    shake->reached[word] = 1;
+    shake->pending[shake->pending_count++] = word;
+}
+
+// Where a memory pointer goes once the words are copied: the first word 
+// kept after it
+static forth_pointer forthi_shaken_pointer(forthi_shake* shake, forth_pointer pointer, forth_pointer end)
+{
+    for (int i = 0; i < shake->word_count; i++)
+        if (shake->reached[i] && shake->starts[i] >= pointer)
+            return shake->new_starts[i];
+    return end;
+}
+
+static int forthi_shaken_dict_pointer(forthi_shake* shake, int dict_pointer)
+{
+    forth_context* ctx = shake->ctx;
+    int count = 0;
+    for (int i = ctx->dict_size - 1; i >= ctx->dict_size - dict_pointer; i--)
+        if (shake->reached[forthi_find_shake_word(shake, ctx->dict_pointers[i])])
+            count++;
+    return count;
+}
+
+// Walks the code of a word. Without out, marks what it uses as reached. 
+// With out, copies it there, moving its pointers to where the words are
+// copied. Words only call the ones defined before them, or themselves, so
+// those are already copied.
+static int forthi_shake_word(forthi_shake* shake, int word, forth_context* out)
+{
+    forth_context* ctx = shake->ctx;
+    forth_pointer start = shake->starts[word];
+    forth_pointer end = ctx->memory_pointer;
+    forth_pointer at = start;
+    if (out)
+        shake->new_starts[word] = out->memory_pointer;
+
+    uint8_t first = 1;
+    while (at < end)
+    {
+        uint8_t inst = *forthi_memory_at(ctx, at++);
+        if (out && forthi_write_byte(out, inst) == FORTH_FAILURE)
+            return FORTH_FAILURE;
+
+        if (first && inst == FORTHI_INST_EXECUTE)
+        {
+            first = 0;
+            continue;
+        }
+
+        if (first && inst != FORTHI_INST_CALL_C_FUNCTION)
+            break;
+
+        if (inst == FORTHI_INST_PUSH_INT_NUMBER && at + sizeof(forth_int) <= end)
+        {
+            if (out && forthi_write_number(out, *(forth_int*)forthi_memory_at(ctx, at)) == FORTH_FAILURE)
+                return FORTH_FAILURE;
+            at += sizeof(forth_int);
+        }
+        else if (inst == FORTHI_INST_CALL_WORD && at + sizeof(forth_pointer) <= end)
+        {
+            int target = forthi_find_shake_word(shake, *(forth_pointer*)forthi_memory_at(ctx, at) - 1);
+            if (target < 0 || target > word)
+                break;
+
+            if (out && forthi_write_pointer(out, shake->new_starts[target] + 1) == FORTH_FAILURE)
+                return FORTH_FAILURE;
+            if (!out)
+                forthi_reach_shake_word(shake, target);
+            at += sizeof(forth_pointer);
+        }
+        else if (inst == FORTHI_INST_CALL_C_FUNCTION && at + sizeof(forth_c_func) <= end)
+        {
+            forth_c_func fn = forthi_function_at(forthi_memory_at(ctx, at));
+            if (out && forthi_write_function(out, fn) == FORTH_FAILURE)
+                return FORTH_FAILURE;
+            if (!out)
+                shake->functions[shake->function_count++] = forthi_function_key(fn);
+            at += sizeof(forth_c_func);
+
+            // A C word, or the end of a definition
+            if (first || fn == forthi_word_semicolon)
+                return FORTH_SUCCESS;
+
+            int kind = forthi_operand_kind(fn);
+            if (kind == FORTHI_OPERAND_BRANCH && at + sizeof(forth_pointer) <= end)
+            {
+                forth_pointer pointer = *(forth_pointer*)forthi_memory_at(ctx, at);
+                if (pointer < start || pointer > end)
+                    break;
+
+                if (out && forthi_write_pointer(out, pointer - start + shake->new_starts[word]) == FORTH_FAILURE)
+                    return FORTH_FAILURE;
+                at += sizeof(forth_pointer);
+            }
+            else if (kind == FORTHI_OPERAND_TEXT && at + sizeof(forth_int) <= end)
+            {
+                forth_int len = *(forth_int*)forthi_memory_at(ctx, at);
+                at += sizeof(forth_int);
+                if (len < 0 || (forth_pointer)len > end - at)
+                    break;
+
+                if (out && forthi_write_text(out, (const char*)forthi_memory_at(ctx, at), (size_t)len) == FORTH_FAILURE)
+                    return FORTH_FAILURE;
+                at += (forth_pointer)len;
+            }
+            else if (kind == FORTHI_OPERAND_MARKER && at + sizeof(forth_pointer) * 2 <= end)
+            {
+                forth_pointer memory_pointer = *(forth_pointer*)forthi_memory_at(ctx, at);
+                forth_pointer dict_pointer = *(forth_pointer*)forthi_memory_at(ctx, at + sizeof(forth_pointer));
+                if (out && 
+                    (forthi_write_pointer(out, forthi_shaken_pointer(shake, memory_pointer, out->memory_pointer)) == 
+                        FORTH_FAILURE ||
+                     forthi_write_pointer(out, (forth_pointer)forthi_shaken_dict_pointer(shake, (int)dict_pointer)) == 
+                        FORTH_FAILURE))
+                    return FORTH_FAILURE;
+                return FORTH_SUCCESS;
+            }
+            else if (kind != FORTHI_OPERAND_NONE)
+            {
+                break;
+            }
+        }
+        else
+        {
+            break;
+        }
+
+        first = 0;
+    }
+
+    FORTH_LOG(ctx, "Invalid code\n");
+    return FORTH_FAILURE;
+}
+
+// Copies the roots and what they use, through word calls and C functions,
+// to a new context
+static forth_context* forthi_shake_context(forthi_shake* shake, const char* const* roots, int root_count)
+{
+    forth_context* ctx = shake->ctx;
+    int dict_index = ctx->dict_size - ctx->dict_pointer;
 
-    free(ctx);
+    for (int i = 0; i < ctx->dict_pointer; i++)
+        shake->starts[i] = ctx->dict_pointers[dict_index + i];
+    qsort(shake->starts, ctx->dict_pointer, sizeof(forth_pointer), forthi_compare_pointers);
+    for (int i = 0; i < ctx->dict_pointer; i++)
+        if (shake->word_count == 0 || shake->starts[shake->word_count - 1] != shake->starts[i])
+            shake->starts[shake->word_count++] = shake->starts[i];
+    memset(shake->reached, 0, shake->word_count);
+
+    for (int i = 0; i < root_count; i++)
+    {
+        forth_pointer pointer = forthi_get_word(ctx, roots[i], strlen(roots[i]));
+        if (pointer == (forth_pointer)-1)
+        {
+            FORTH_LOG(ctx, "Undefined word\n");
+            return NULL;
+        }
+        forthi_reach_shake_word(shake, forthi_find_shake_word(shake, pointer));
+    }
+
+    while (shake->pending_count > 0)
+        if (forthi_shake_word(shake, shake->pending[--shake->pending_count], NULL) == FORTH_FAILURE)
+            return NULL;
+
+    // C words come along with the functions the code calls
+    qsort(shake->functions, shake->function_count, sizeof(uintptr_t), forthi_compare_keys);
+    for (int i = 0; i < shake->word_count; i++)
+    {
+        const uint8_t* code = forthi_memory_at(ctx, shake->starts[i]);
+        if (*code != FORTHI_INST_CALL_C_FUNCTION || shake->starts[i] + 1 + sizeof(forth_c_func) > ctx->memory_pointer)
+            continue;
+
+        uintptr_t key = forthi_function_key(forthi_function_at(code + 1));
+        if (bsearch(&key, shake->functions, shake->function_count, sizeof(uintptr_t), forthi_compare_keys))
+            shake->reached[i] = 1;
+    }
+
+    forth_context* out = forthi_alloc_context(FORTH_MEM_INFINITE, FORTH_MEM_INFINITE, FORTH_MEM_INFINITE, 
+        FORTH_MEM_INFINITE,
+        (int)ctx->memory_pointer + FORTHI_MEM_ALLOC_CHUNK_SIZE,
+        FORTHI_MEM_ALLOC_CHUNK_SIZE,
+        ctx->dict_names_pointer + FORTHI_DICT_NAMES_ALLOC_SIZE,
+        0,
+        0,
+        &ctx->allocator);
+    if (!out)
+    {
+        FORTH_LOG(ctx, "Out of memory\n");
+        return NULL;
+    }
+    out->log = ctx->log;
+
+    out->base = out->memory_pointer;
+    uint8_t result = forthi_write_number(out, *(forth_int*)forthi_memory_at(ctx, ctx->base)) == FORTH_SUCCESS;
+    for (int i = 0; result && i < shake->word_count; i++)
+        if (shake->reached[i])
+            result = forthi_shake_word(shake, i, out) == FORTH_SUCCESS;
+
+    for (int i = ctx->dict_size - 1; result && i >= dict_index; i--)
+    {
+        int word = forthi_find_shake_word(shake, ctx->dict_pointers[i]);
+        if (shake->reached[word])
+            result = forthi_add_word(out, ctx->dict_names + ctx->dict_name_offsets[i], ctx->dict_name_lens[i], 
+                shake->new_starts[word]) == FORTH_SUCCESS;
+    }
+
+    if (!result)
+    {
+        forth_destroy_context(out);
+        return NULL;
+    }
+
+    out->default_memory_pointer = forthi_shaken_pointer(shake, ctx->default_memory_pointer, out->memory_pointer);
+    out->default_dict_pointer = forthi_shaken_dict_pointer(shake, ctx->default_dict_pointer);
+    return out;
+}
+
+static int forthi_save_shaken_image(forth_context* ctx, const char* path, const char* const* roots, int root_count)
+{
+    // Every word is walked once, so the C functions called are at most all
+    // the ones written
+    forthi_shake shake;
+    memset(&shake, 0, sizeof(forthi_shake));
+    shake.ctx = ctx;
+    shake.starts = (forth_pointer*)forthi_alloc_buffer(ctx, sizeof(forth_pointer) * (ctx->dict_pointer + 1));
+    shake.new_starts = (forth_pointer*)forthi_alloc_buffer(ctx, sizeof(forth_pointer) * (ctx->dict_pointer + 1));
+    shake.reached = (uint8_t*)forthi_alloc_buffer(ctx, ctx->dict_pointer + 1);
+    shake.pending = (int*)forthi_alloc_buffer(ctx, sizeof(int) * (ctx->dict_pointer + 1));
+    shake.functions = (uintptr_t*)forthi_alloc_buffer(ctx, sizeof(uintptr_t) * (ctx->fn_offsets_pointer + 1));
+
+    int result = FORTH_FAILURE;
+    if (!shake.starts || !shake.new_starts || !shake.reached || !shake.pending || !shake.functions)
+    {
+        FORTH_LOG(ctx, "Out of memory\n");
+    }
+    else
+    {
+        forth_context* shaken = forthi_shake_context(&shake, roots, root_count);
+        if (shaken)
+        {
+            result = forthi_save_image(shaken, path);
+            forth_destroy_context(shaken);
+        }
+    }
+
+    if (shake.starts)
+        forthi_free_buffer(ctx, shake.starts);
+    if (shake.new_starts)
+        forthi_free_buffer(ctx, shake.new_starts);
+    if (shake.reached)
+        forthi_free_buffer(ctx, shake.reached);
+    if (shake.pending)
+        forthi_free_buffer(ctx, shake.pending);
+    if (shake.functions)
+        forthi_free_buffer(ctx, shake.functions);
+
+    return result;
+}
+
+int forth_save_image(forth_context* ctx, const char* path, const char* const* roots, int root_count)
+{
+    if (!ctx || !path || root_count < 0 || (root_count > 0 && !roots))
+        return FORTH_FAILURE;
+
+    if (ctx->parent)
+    {
+        FORTH_LOG(ctx, "Can't save a child context\n");
+        return FORTH_FAILURE;
+    }
+
+    if (roots)
+        return forthi_save_shaken_image(ctx, path, roots, root_count);
+    return forthi_save_image(ctx, path);
+}
+
+// Gives the next section the header announces, checking it's in the image
+static const uint8_t* forthi_image_section(const uint8_t** at, const uint8_t* end, size_t size)
+{
+    if ((size_t)(end - *at) < size)
+        return NULL;
+
+    const uint8_t* section = *at;
+    *at += size;
+    return section;
+}
+
+// Finds the sections of an image and checks they're consistent, so loading
+// can trust them
+static int forthi_parse_image(const uint8_t* data, size_t size, forthi_image* image)
+{
+    forthi_image_header* header = &image->header;
+    if (size < sizeof(forthi_image_header))
+        return FORTH_FAILURE;
+    memcpy(header, data, sizeof(forthi_image_header));
+
+    if (memcmp(header->magic, FORTHI_IMAGE_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != FORTHI_IMAGE_VERSION ||
+        header->int_size != sizeof(forth_int) ||
+        header->pointer_size != sizeof(forth_pointer) ||
+        header->function_size != sizeof(forth_c_func) ||
+        header->memory_offset % FORTHI_IMAGE_ALIGNMENT != 0 ||
+        header->memory_offset > size ||
+        header->memory_pointer != size - header->memory_offset ||
+        header->memory_pointer > (uint64_t)(INT_MAX - FORTHI_MEM_ALLOC_CHUNK_SIZE) ||
+        header->dict_pointer < 0 || header->dict_names_pointer < 0 || header->fn_offset_count < 0 ||
+        header->fn_name_count < 0 || header->fn_names_size < 0 ||
+        header->dict_names_pointer > INT_MAX - FORTHI_DICT_NAMES_ALLOC_SIZE ||
+        header->default_dict_pointer < 0 || header->default_dict_pointer > header->dict_pointer ||
+        header->default_memory_pointer > header->memory_pointer ||
+        header->base + sizeof(forth_int) > header->memory_pointer)
+        return FORTH_FAILURE;
+
+    const uint8_t* at = data + sizeof(forthi_image_header);
+    const uint8_t* end = data + header->memory_offset;
+    image->dict_pointers = (const forth_pointer*)forthi_image_section(&at, end, 
+        sizeof(forth_pointer) * header->dict_pointer);
+    image->fn_offsets = (const forth_pointer*)forthi_image_section(&at, end, 
+        sizeof(forth_pointer) * header->fn_offset_count);
+    image->dict_name_offsets = (const int*)forthi_image_section(&at, end, sizeof(int) * header->dict_pointer);
+    image->dict_name_lens = (const int*)forthi_image_section(&at, end, sizeof(int) * header->dict_pointer);
+    image->fn_name_indices = (const int32_t*)forthi_image_section(&at, end, 
+        sizeof(int32_t) * header->fn_offset_count);
+    image->dict_names = (const char*)forthi_image_section(&at, end, header->dict_names_pointer);
+    image->fn_names = (const char*)forthi_image_section(&at, end, header->fn_names_size);
+    image->memory = data + header->memory_offset;
+    if (!image->dict_pointers || !image->fn_offsets || !image->dict_name_offsets || !image->dict_name_lens || 
+        !image->fn_name_indices || !image->dict_names || !image->fn_names)
+        return FORTH_FAILURE;
+
+    for (int i = 0; i < header->dict_pointer; i++)
+    {
+        if (image->dict_pointers[i] >= header->memory_pointer || image->dict_name_offsets[i] < 0 || 
+            image->dict_name_lens[i] < 0 || 
+            image->dict_name_offsets[i] > header->dict_names_pointer - image->dict_name_lens[i])
+            return FORTH_FAILURE;
+    }
+
+    for (int i = 0; i < header->fn_offset_count; i++)
+    {
+        forth_pointer offset = image->fn_offsets[i];
+        if (image->fn_name_indices[i] < 0 || image->fn_name_indices[i] >= header->fn_name_count ||
+            offset + sizeof(forth_c_func) > header->memory_pointer ||
+            (i > 0 && offset < image->fn_offsets[i - 1] + sizeof(forth_c_func)))
+            return FORTH_FAILURE;
+    }
+
+    return FORTH_SUCCESS;
+}
+
+static forth_c_func forthi_find_function_by_name(const forth_c_word* c_words, size_t count, const char* name)
+{
+    for (size_t i = 0; i < count; i++)
+        if (strcmp(c_words[i].name, name) == 0)
+            return c_words[i].fn;
+    return NULL;
+}
+
+// Finds the C function of each name in the image
+static int forthi_resolve_image_functions(const forthi_image* image, const forth_c_word* c_words, int c_word_count,
+                                          forth_c_func* functions)
+{
+    const char* name = image->fn_names;
+    const char* names_end = name + image->header.fn_names_size;
+    for (int i = 0; i < image->header.fn_name_count; i++)
+    {
+        const char* name_end = names_end - name > 1 ? (const char*)memchr(name + 1, '\0', names_end - name - 1) : NULL;
+        if (!name_end)
+            return FORTH_FAILURE;
+
+        if (*name == FORTHI_IMAGE_BUILTIN)
+        {
+            functions[i] = forthi_find_function_by_name(forthi_standard_words, 
+                sizeof(forthi_standard_words) / sizeof(forth_c_word), name + 1);
+            if (!functions[i])
+                functions[i] = forthi_find_function_by_name(forthi_internal_functions, 
+                    sizeof(forthi_internal_functions) / sizeof(forth_c_word), name + 1);
+        }
+        else
+        {
+            functions[i] = c_words ? forthi_find_function_by_name(c_words, (size_t)c_word_count, name + 1) : NULL;
+        }
+
+        if (!functions[i])
+            return FORTH_FAILURE;
+        name = name_end + 1;
+    }
+
+    return FORTH_SUCCESS;
+}
+
+// Only writes what differs, so the pages of a mapped image stay shared when
+// it's loaded by the program that saved it
+static void forthi_relocate_image(const forthi_image* image, const forth_c_func* functions, uint8_t* memory)
+{
+    for (int i = 0; i < image->header.fn_offset_count; i++)
+    {
+        uint8_t* at = memory + image->fn_offsets[i];
+        uintptr_t value = forthi_encode_function(functions[image->fn_name_indices[i]]);
+        if (memcmp(at, &value, sizeof(uintptr_t)) != 0)
+            memcpy(at, &value, sizeof(uintptr_t));
+    }
+}
+
+static forth_context* forthi_load_image(const uint8_t* data, size_t size, 
+                                        const forth_c_word* c_words, int c_word_count)
+{
+    forthi_image image;
+    if (forthi_parse_image(data, size, &image) == FORTH_FAILURE)
+        return NULL;
+    const forthi_image_header* header = &image.header;
+
+    forth_context* ctx = forthi_alloc_context(FORTH_MEM_INFINITE, FORTH_MEM_INFINITE, FORTH_MEM_INFINITE, 
+        FORTH_MEM_INFINITE,
+        (int)header->memory_pointer + FORTHI_MEM_ALLOC_CHUNK_SIZE,
+        FORTHI_MEM_ALLOC_CHUNK_SIZE,
+        header->dict_names_pointer + FORTHI_DICT_NAMES_ALLOC_SIZE,
+        0,
+        0,
+        NULL);
+    if (!ctx)
+        return NULL;
+
+    forth_c_func* functions = (forth_c_func*)forthi_alloc_buffer(ctx, 
+        sizeof(forth_c_func) * (header->fn_name_count + 1));
+    uint8_t result = functions != NULL;
+
+    while (result && ctx->dict_size < header->dict_pointer)
+        result = forthi_grow_dictionnary(ctx);
+    while (result && ctx->fn_offsets_size < header->fn_offset_count)
+        result = forthi_grow_fn_offsets(ctx);
+
+    result = result && forthi_resolve_image_functions(&image, c_words, c_word_count, functions);
+    if (result)
+    {
+        memcpy(ctx->memory, image.memory, (size_t)header->memory_pointer);
+        ctx->memory_pointer = (forth_pointer)header->memory_pointer;
+        ctx->default_memory_pointer = (forth_pointer)header->default_memory_pointer;
+        ctx->base = (forth_pointer)header->base;
+        forthi_relocate_image(&image, functions, ctx->memory);
+
+        int dict_index = ctx->dict_size - header->dict_pointer;
+        memcpy(ctx->dict_name_offsets + dict_index, image.dict_name_offsets, sizeof(int) * header->dict_pointer);
+        memcpy(ctx->dict_name_lens + dict_index, image.dict_name_lens, sizeof(int) * header->dict_pointer);
+        memcpy(ctx->dict_pointers + dict_index, image.dict_pointers, sizeof(forth_pointer) * header->dict_pointer);
+        memcpy(ctx->dict_names, image.dict_names, header->dict_names_pointer);
+        ctx->dict_pointer = header->dict_pointer;
+        ctx->default_dict_pointer = header->default_dict_pointer;
+        ctx->dict_names_pointer = header->dict_names_pointer;
+
+        memcpy(ctx->fn_offsets, image.fn_offsets, sizeof(forth_pointer) * header->fn_offset_count);
+        ctx->fn_offsets_pointer = header->fn_offset_count;
+    }
+
+    if (functions)
+        forthi_free_buffer(ctx, functions);
+
+    if (!result)
+    {
+        forth_destroy_context(ctx);
+        return NULL;
+    }
+
+    return ctx;
+}
+
+forth_context* forth_load_image(const char* path, const forth_c_word* c_words, int c_word_count)
+{
+    if (!path)
+        return NULL;
+
+    FILE* file = fopen(path, "rb");
+    if (!file)
+        return NULL;
+
+    fseek(file, 0, SEEK_END);
+    long file_size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    uint8_t* data = file_size > 0 ? (uint8_t*)malloc((size_t)file_size) : NULL;
+    size_t byte_read = data ? fread(data, 1, (size_t)file_size, file) : 0;
+    fclose(file);
+
+    forth_context* ctx = NULL;
+    if (data && byte_read == (size_t)file_size)
+        ctx = forthi_load_image(data, byte_read, c_words, c_word_count);
+
+    free(data);
+    return ctx;
+}
+
+forth_context* forth_map_image(const char* path, const forth_c_word* c_words, int c_word_count)
+{
+    if (!path)
+        return NULL;
+
+#if FORTHI_HAS_MMAN
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size <= 0)
+    {
+        close(fd);
+        return NULL;
+    }
+
+    // Private, so relocating only copies the pages it touches
+    size_t size = (size_t)file_stat.st_size;
+    uint8_t* data = (uint8_t*)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if ((void*)data == MAP_FAILED)
+        return NULL;
+
+    forthi_image image;
+    forth_c_func* functions = NULL;
+    forth_allocator allocator = forthi_default_allocator();
+    forth_context* ctx = NULL;
+    if (forthi_parse_image(data, size, &image) == FORTH_SUCCESS)
+    {
+        functions = (forth_c_func*)allocator.alloc(allocator.user, 
+            sizeof(forth_c_func) * (image.header.fn_name_count + 1));
+        if (functions && forthi_resolve_image_functions(&image, c_words, c_word_count, functions) == FORTH_SUCCESS)
+        {
+            forthi_relocate_image(&image, functions, data + image.header.memory_offset);
+            if (mprotect(data, size, PROT_READ) == 0)
+                ctx = (forth_context*)allocator.alloc(allocator.user, sizeof(forth_context));
+        }
+    }
+
+    if (functions)
+        allocator.free(allocator.user, functions);
+
+    if (!ctx)
+    {
+        munmap(data, size);
+        return NULL;
+    }
+
+    // The context's buffers are the image's sections. It can't change them, 
+    // it's only a base for child contexts.
+    const forthi_image_header* header = &image.header;
+    memset(ctx, 0, sizeof(forth_context));
+    ctx->allocator = allocator;
+    forthi_init_heap(&ctx->heap);
+    ctx->image = data;
+    ctx->image_size = size;
+    ctx->frozen = 1;
+
+    ctx->memory = data + header->memory_offset;
+    ctx->memory_size = (int)header->memory_pointer;
+    ctx->memory_pointer = (forth_pointer)header->memory_pointer;
+    ctx->default_memory_pointer = (forth_pointer)header->default_memory_pointer;
+    ctx->base = (forth_pointer)header->base;
+
+    ctx->dict_name_offsets = (int*)image.dict_name_offsets;
+    ctx->dict_name_lens = (int*)image.dict_name_lens;
+    ctx->dict_pointers = (forth_pointer*)image.dict_pointers;
+    ctx->dict_names = (char*)image.dict_names;
+    ctx->dict_names_size = header->dict_names_pointer;
+    ctx->dict_names_pointer = header->dict_names_pointer;
+    ctx->dict_size = header->dict_pointer;
+    ctx->dict_pointer = header->dict_pointer;
+    ctx->default_dict_pointer = header->default_dict_pointer;
+
+    ctx->fn_offsets = (forth_pointer*)image.fn_offsets;
+    ctx->fn_offsets_size = header->fn_offset_count;
+    ctx->fn_offsets_pointer = header->fn_offset_count;
+
+    return ctx;
+#else
+    // Read it instead
+    forth_context* ctx = forth_load_image(path, c_words, c_word_count);
+    if (ctx)
+        forth_freeze_context(ctx);
+    return ctx;
+#endif
 }
 
 #endif
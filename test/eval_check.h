@@ -121,3 +121,30 @@ void evalTest(forth_context* ctx,
         REQUIRE(LogCapturer::log == expected_log);
     }
 }
+
+// Returns the ( c-addr u ) string on top of the stack
+std::string topString(forth_context* ctx)
+{
+    auto addr = forth_get_top(ctx, 1);
+    auto len = forth_get_top(ctx, 0);
+    if (!addr || !len)
+        return "";
+
+    return std::string((const char*)forthi_memory_at(ctx, addr->pointer_value), (size_t)len->uint_value);
+}
+
+// Source defining count words named prefix0, prefix1, ... each pushing its
+// index modulo 100
+std::string generatedWords(const std::string& prefix, int count)
+{
+    std::string source;
+    for (int i = 0; i < count; i++)
+        source += ": " + prefix + std::to_string(i) + " " + std::to_string(i % 100) + " ; ";
+    return source;
+}
+
+void defineGeneratedWords(forth_context* ctx, const std::string& prefix, int count)
+{
+    std::string source = generatedWords(prefix, count);
+    REQUIRE(forth_eval(ctx, source.c_str()) == FORTH_SUCCESS);
+}
@@ -23,6 +23,11 @@ SOFTWARE.
 */
 
 #define CATCH_CONFIG_MAIN
+#if FORTH_GUARDED_STACKS
+// Catch puts back its own SIGSEGV handler after each test, which would drop
+// the guard handler installed once by the first context
+#define CATCH_CONFIG_NO_POSIX_SIGNALS
+#endif
 #include <catch/catch.hpp>
 
 #define FORTH_IMPLEMENT
@@ -30,6 +35,33 @@ SOFTWARE.
 
 #include "eval_check.h"
 
+#include <chrono>
+
+#if FORTH_GUARDED_STACKS
+// A host handler recovering from faults on its own page, and chaining the
+// others to the handler it replaced
+static sigjmp_buf testFaultJump;
+static void* testFaultPage;
+static struct sigaction testPreviousAction;
+
+static void testFaultHandler(int sig, siginfo_t* info, void* ucontext)
+{
+    if (info->si_addr == testFaultPage)
+        siglongjmp(testFaultJump, 1);
+    testPreviousAction.sa_sigaction(sig, info, ucontext);
+}
+
+static bool testFaultRecovered()
+{
+    if (sigsetjmp(testFaultJump, 1) == 0)
+    {
+        *(volatile uint8_t*)testFaultPage = 1;
+        return false;
+    }
+    return true;
+}
+#endif
+
 TEST_CASE("forth_context", "[forth_context]")
 {
     SECTION("Not enough memory for standard WORDs")
@@ -53,6 +85,962 @@ TEST_CASE("forth_context", "[forth_context]")
 
         forth_destroy_context(ctx);
     }
+
+    SECTION("Return stack overflow")
+    {
+        forth_context* ctx = forth_create_context(-1, -1, 2);
+
+        evalTestSection(ctx, ": TEST 1 >R 2 >R 3 >R ; TEST", FORTH_FAILURE, {}, "Return stack overflow\n");
+
+        forth_destroy_context(ctx);
+    }
+
+#if FORTH_GUARDED_STACKS
+    SECTION("Guarded stacks")
+    {
+        forth_context* ctx = forth_create_context();
+        REQUIRE(ctx->stack_size == FORTH_GUARDED_STACK_SIZE);
+
+        evalTest(ctx, ": TEST BEGIN 1 0 UNTIL ; TEST", FORTH_FAILURE, {}, "Stack overflow\n");
+        evalTest(ctx, "1 2 +", FORTH_SUCCESS, {3});
+
+        forth_context* clone = forth_clone_context(ctx);
+        evalTest(clone, "TEST", FORTH_FAILURE, {}, "Stack overflow\n");
+        evalTest(ctx, "DUP", FORTH_SUCCESS, {3, 3});
+
+        forth_destroy_context(clone);
+        forth_destroy_context(ctx);
+    }
+
+    SECTION("Faults of others")
+    {
+        // The guard handler is installed by the first context
+        forth_destroy_context(forth_create_context());
+
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_sigaction = testFaultHandler;
+        action.sa_flags = SA_SIGINFO;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGSEGV, &action, &testPreviousAction);
+        REQUIRE(testPreviousAction.sa_sigaction == forthi_guard_handler);
+
+        // Later contexts leave the host handler in front
+        forth_context* ctx = forth_create_context();
+        REQUIRE(forthi_previous_sigsegv.sa_sigaction != testFaultHandler);
+        size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+        testFaultPage = mmap(NULL, page_size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        REQUIRE(testFaultPage != MAP_FAILED);
+
+        for (int i = 0; i < 2; i++)
+        {
+            REQUIRE(testFaultRecovered());
+            evalTest(ctx, ": TEST BEGIN 1 0 UNTIL ; TEST", FORTH_FAILURE, {}, "Stack overflow\n");
+        }
+
+        munmap(testFaultPage, page_size);
+        forth_destroy_context(ctx);
+        sigaction(SIGSEGV, &testPreviousAction, NULL);
+    }
+#endif
+
+    SECTION("Geometric growth")
+    {
+        forth_context* ctx = forth_create_context();
+
+        // A few MB of source compiling to even more code
+        std::string source;
+        for (int i = 0; i < 400; i++)
+        {
+            source += ": generated-" + std::to_string(i);
+            for (int j = 0; j < 1000; j++)
+                source += " DUP DROP";
+            source += " ;\n";
+        }
+        for (int i = 0; i < 5000; i++)
+            source += ": small-" + std::to_string(i) + " ;\n";
+        source += "1";
+        for (int i = 0; i < 100000; i++)
+            source += " DUP";
+
+        REQUIRE(source.size() > 3 * 1024 * 1024);
+        REQUIRE(forth_eval(ctx, source.c_str()) == FORTH_SUCCESS);
+        REQUIRE(ctx->stack_pointer == 100001);
+        REQUIRE(ctx->memory_pointer > 4 * 1024 * 1024);
+
+        // Memory, stack, dictionnary and names each grow a logarithmic number
+        // of times
+        REQUIRE(ctx->grow_count < 40);
+
+        forth_destroy_context(ctx);
+    }
+}
+
+TEST_CASE("reserved_memory", "[reserved_memory]")
+{
+    forth_context_options options = forth_default_context_options();
+    options.reserve_memory = 1;
+
+    SECTION("Data space never moves")
+    {
+        forth_context* ctx = forth_create_context_ex(&options);
+        REQUIRE(ctx);
+        REQUIRE(ctx->memory_reserved_size == FORTH_DEFAULT_RESERVE_SIZE);
+
+        uint8_t* memory = ctx->memory;
+        forth_int* base = (forth_int*)forthi_memory_at(ctx, ctx->base);
+        int committed = ctx->memory_size;
+
+        std::string source;
+        for (int i = 0; i < 200; i++)
+        {
+            source += ": generated-" + std::to_string(i);
+            for (int j = 0; j < 1000; j++)
+                source += " DUP DROP";
+            source += " ;\n";
+        }
+        source += "1 generated-199";
+        evalTest(ctx, source.c_str(), FORTH_SUCCESS, {1});
+
+        REQUIRE(ctx->memory_size > committed);
+        REQUIRE(ctx->memory == memory);
+        REQUIRE(*base == 10);
+
+        forth_destroy_context(ctx);
+    }
+
+    SECTION("Out of reserved memory")
+    {
+        options.memory_size = 64 * 1024;
+        forth_context* ctx = forth_create_context_ex(&options);
+        REQUIRE(ctx);
+
+        std::string source = ": generated";
+        for (int j = 0; j < 10000; j++)
+            source += " DUP DROP";
+        source += " ;";
+        evalTest(ctx, source.c_str(), FORTH_FAILURE, {}, "Out of memory\n");
+
+        REQUIRE(ctx->memory_size == 64 * 1024);
+
+        forth_destroy_context(ctx);
+    }
+
+    SECTION("Clone")
+    {
+        forth_context* ctx = forth_create_context_ex(&options);
+        REQUIRE(ctx);
+        evalTest(ctx, ": SQUARE DUP * ;", FORTH_SUCCESS, {});
+
+        forth_context* clone = forth_clone_context(ctx);
+        REQUIRE(clone);
+        REQUIRE(clone->memory_reserved_size == 0);
+        evalTest(clone, "3 SQUARE", FORTH_SUCCESS, {9});
+
+        forth_destroy_context(clone);
+        forth_destroy_context(ctx);
+    }
+
+    SECTION("Huge pages")
+    {
+        options.reserve_memory = 0;
+        options.huge_pages = 1;
+        forth_context* ctx = forth_create_context_ex(&options);
+        REQUIRE(ctx);
+        REQUIRE(ctx->memory_reserved_size == FORTH_DEFAULT_RESERVE_SIZE);
+        REQUIRE(((uintptr_t)ctx->memory & (FORTHI_HUGE_PAGE_SIZE - 1)) == 0);
+        REQUIRE(ctx->memory_size % FORTHI_HUGE_PAGE_SIZE == 0);
+
+        // Commits whole huge pages
+        int committed = ctx->memory_size;
+        REQUIRE(forthi_reserve_memory_space(ctx, committed) == FORTH_SUCCESS);
+        REQUIRE(ctx->memory_size > committed);
+        REQUIRE(ctx->memory_size % FORTHI_HUGE_PAGE_SIZE == 0);
+        evalTest(ctx, ": SQUARE DUP * ; 3 SQUARE", FORTH_SUCCESS, {9});
+
+        forth_destroy_context(ctx);
+    }
+}
+
+// Random reads over a large array in the data space, with and without huge 
+// pages. Run with the [.benchmark] tag.
+TEST_CASE("huge_pages_benchmark", "[.benchmark]")
+{
+    const int array_size = 256 * 1024 * 1024;
+    const int read_count = 20 * 1000 * 1000;
+
+    for (int huge_pages = 0; huge_pages < 2; huge_pages++)
+    {
+        forth_context_options options = forth_default_context_options();
+        options.reserve_memory = 1;
+        options.huge_pages = (uint8_t)huge_pages;
+        forth_context* ctx = forth_create_context_ex(&options);
+        REQUIRE(ctx);
+
+        // What CREATE and ALLOT would do
+        forth_pointer array = ctx->memory_pointer;
+        REQUIRE(forthi_reserve_memory_space(ctx, array_size) == FORTH_SUCCESS);
+        ctx->memory_pointer += array_size;
+        for (int i = 0; i < array_size; i += 64)
+            *forthi_memory_at(ctx, array + i) = (uint8_t)i;
+
+        auto start = std::chrono::steady_clock::now();
+        uint32_t seed = 12345;
+        uint32_t sum = 0;
+        for (int i = 0; i < read_count; i++)
+        {
+            seed = seed * 1664525 + 1013904223;
+            sum += *forthi_memory_at(ctx, array + (seed % array_size));
+        }
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+        WARN((huge_pages ? "Huge pages: " : "Regular pages: ") << elapsed.count() << " ms (" << sum << ")");
+
+        forth_destroy_context(ctx);
+    }
+}
+
+struct CountingAllocatorStats
+{
+    int allocs = 0;
+    int reallocs = 0;
+    int frees = 0;
+};
+
+static void* countingAlloc(void* user, size_t size)
+{
+    ((CountingAllocatorStats*)user)->allocs++;
+    return malloc(size);
+}
+
+static void* countingRealloc(void* user, void* ptr, size_t size)
+{
+    ((CountingAllocatorStats*)user)->reallocs++;
+    return realloc(ptr, size);
+}
+
+static void countingFree(void* user, void* ptr)
+{
+    ((CountingAllocatorStats*)user)->frees++;
+    free(ptr);
+}
+
+TEST_CASE("allocator", "[allocator]")
+{
+    CountingAllocatorStats stats;
+    forth_allocator allocator = {countingAlloc, countingRealloc, countingFree, &stats};
+
+    forth_context_options options = forth_default_context_options();
+    options.allocator = &allocator;
+
+    SECTION("All buffers go through the allocator")
+    {
+        forth_context* ctx = forth_create_context_ex(&options);
+        REQUIRE(ctx);
+        REQUIRE(stats.allocs > 0);
+
+        defineGeneratedWords(ctx, "generated-word-", 2000);
+        REQUIRE(stats.reallocs > 0);
+
+        forth_freeze_context(ctx);
+        forth_context* child = forth_create_child_context(ctx);
+        REQUIRE(child);
+        forth_context* clone = forth_clone_context(child);
+        REQUIRE(clone);
+        evalTest(clone, "generated-word-1999", FORTH_SUCCESS, {99});
+
+        forth_destroy_context(clone);
+        forth_destroy_context(child);
+        forth_destroy_context(ctx);
+        REQUIRE(stats.allocs == stats.frees);
+    }
+
+    SECTION("Without realloc")
+    {
+        allocator.realloc = NULL;
+        forth_context* ctx = forth_create_context_ex(&options);
+        REQUIRE(ctx);
+
+        defineGeneratedWords(ctx, "generated-word-", 2000);
+        evalTest(ctx, "generated-word-1999", FORTH_SUCCESS, {99});
+
+        forth_destroy_context(ctx);
+        REQUIRE(stats.reallocs == 0);
+        REQUIRE(stats.allocs == stats.frees);
+    }
+}
+
+TEST_CASE("reserve", "[reserve]")
+{
+    forth_context* ctx = forth_create_context();
+
+    std::string words = generatedWords("warm-", 300);
+    std::string pushes;
+    for (int i = 0; i < 2000; i++)
+        pushes += "1 ";
+
+    SECTION("Allocations are counted")
+    {
+        REQUIRE(forth_eval(ctx, words.c_str()) == FORTH_SUCCESS);
+        REQUIRE(ctx->eval_allocation_count > 0);
+    }
+
+    SECTION("Steady state")
+    {
+        REQUIRE(forth_reserve(ctx, 64 * 1024, 4096, 1024, 512) == FORTH_SUCCESS);
+        ctx->forbid_eval_allocations = 1;
+
+        REQUIRE(forth_eval(ctx, words.c_str()) == FORTH_SUCCESS);
+        REQUIRE(forth_eval(ctx, pushes.c_str()) == FORTH_SUCCESS);
+        REQUIRE(ctx->eval_allocation_count == 0);
+
+        // Going past the reservation fails loudly
+        std::string more_words = generatedWords("more-", 3000);
+        evalTest(ctx, more_words.c_str(), FORTH_FAILURE, {}, "Allocation during evaluation\nOut of memory\n");
+        REQUIRE(ctx->eval_allocation_count == 1);
+    }
+
+    SECTION("Transient and heap")
+    {
+        REQUIRE(forth_reserve(ctx, 64 * 1024, 256, 256, 512, FORTH_DEFAULT_TRANSIENT_RESERVE, 4096) == FORTH_SUCCESS);
+        ctx->forbid_eval_allocations = 1;
+
+        evalTest(ctx, "S\" hi\" SWAP DROP", FORTH_SUCCESS, {2});
+        evalTest(ctx, "DROP PAD DROP", FORTH_SUCCESS, {});
+        evalTest(ctx, "123 0 <# #S #> SWAP DROP", FORTH_SUCCESS, {3});
+        evalTest(ctx, "DROP 5 ALLOCATE SWAP DROP", FORTH_SUCCESS, {0});
+        REQUIRE(ctx->eval_allocation_count == 0);
+
+        // Trimming gives the reservation back
+        ctx->forbid_eval_allocations = 0;
+        REQUIRE(forth_trim(ctx) == FORTH_SUCCESS);
+        ctx->forbid_eval_allocations = 1;
+        evalTest(ctx, "DROP PAD DROP", FORTH_FAILURE, {}, "Allocation during evaluation\nOut of memory\n");
+    }
+
+    SECTION("Fixed sizes")
+    {
+        forth_context* fixed = forth_create_context(-1, 16);
+        REQUIRE(forth_reserve(fixed, 0, 16, 0, 0) == FORTH_SUCCESS);
+        REQUIRE(forth_reserve(fixed, 0, 17, 0, 0) == FORTH_FAILURE);
+        forth_destroy_context(fixed);
+    }
+
+    forth_destroy_context(ctx);
+}
+
+TEST_CASE("stats", "[stats]")
+{
+    forth_context* ctx = forth_create_context();
+    forth_stats stats;
+
+    forth_get_stats(ctx, &stats);
+    REQUIRE(stats.memory_used == ctx->memory_pointer);
+    REQUIRE(stats.memory_size == (size_t)ctx->memory_size);
+    REQUIRE(stats.memory_reserved == stats.memory_size);
+    REQUIRE(stats.data_bytes == sizeof(forth_int)); // BASE
+    REQUIRE(stats.code_bytes == stats.memory_used - sizeof(forth_int));
+    REQUIRE(stats.dict_entries == ctx->dict_pointer);
+    REQUIRE(stats.dict_capacity == ctx->dict_size);
+    REQUIRE(stats.stack_depth == 0);
+    REQUIRE(stats.stack_capacity == ctx->stack_size);
+    REQUIRE(stats.return_stack_capacity == ctx->return_stack_size);
+
+    size_t code_bytes = stats.code_bytes;
+    int grow_count = stats.grow_count;
+
+    defineGeneratedWords(ctx, "counted-", 2000);
+    REQUIRE(forth_eval(ctx, "1 2 3") == FORTH_SUCCESS);
+
+    forth_get_stats(ctx, &stats);
+    REQUIRE(stats.code_bytes > code_bytes);
+    REQUIRE(stats.data_bytes == sizeof(forth_int));
+    REQUIRE(stats.dict_entries == ctx->dict_pointer);
+    REQUIRE(stats.stack_depth == 3);
+    REQUIRE(stats.stack_high_water >= 3);
+    REQUIRE(stats.grow_count > grow_count);
+    REQUIRE(stats.grow_time > 0.0);
+
+    forth_destroy_context(ctx);
+
+    SECTION("Child context")
+    {
+        forth_context* base = forth_create_context();
+        forth_freeze_context(base);
+        forth_context* child = forth_create_child_context(base);
+        REQUIRE(child);
+
+        forth_get_stats(child, &stats);
+        REQUIRE(stats.memory_used == sizeof(forth_int)); // Own BASE
+        REQUIRE(stats.code_bytes == 0);
+        REQUIRE(stats.dict_entries == 0);
+
+        REQUIRE(forth_eval(child, ": SQUARE DUP * ;") == FORTH_SUCCESS);
+        forth_get_stats(child, &stats);
+        REQUIRE(stats.code_bytes > 0);
+        REQUIRE(stats.data_bytes == sizeof(forth_int));
+        REQUIRE(stats.dict_entries == 1);
+
+        forth_destroy_context(child);
+        forth_destroy_context(base);
+    }
+}
+
+TEST_CASE("trim", "[trim]")
+{
+    forth_context* ctx = forth_create_context();
+
+    std::string words = generatedWords("grown-", 2000);
+    std::string pushes;
+    for (int i = 0; i < 3000; i++)
+        pushes += "1 ";
+    std::string drops;
+    for (int i = 0; i < 3000; i++)
+        drops += "DROP ";
+
+    REQUIRE(forth_eval(ctx, words.c_str()) == FORTH_SUCCESS);
+    REQUIRE(forth_eval(ctx, pushes.c_str()) == FORTH_SUCCESS);
+    REQUIRE(forth_eval(ctx, drops.c_str()) == FORTH_SUCCESS);
+
+    int memory_size = ctx->memory_size;
+    int dict_size = ctx->dict_size;
+    int dict_names_size = ctx->dict_names_size;
+    int dict_pointer = ctx->dict_pointer;
+
+    REQUIRE(forth_trim(ctx) == FORTH_SUCCESS);
+    REQUIRE(ctx->memory_size <= memory_size);
+    REQUIRE(ctx->memory_size >= (int)ctx->memory_pointer);
+    REQUIRE(ctx->dict_size < dict_size);
+    REQUIRE(ctx->dict_size >= ctx->dict_pointer);
+    REQUIRE(ctx->dict_names_size < dict_names_size);
+    REQUIRE(ctx->dict_pointer == dict_pointer);
+#if !FORTH_GUARDED_STACKS
+    REQUIRE(ctx->stack_size < 3000);
+#endif
+
+    // Peaks survive trimming
+    REQUIRE(ctx->stack_high_water >= 3000);
+    REQUIRE(ctx->dict_high_water == dict_pointer);
+    REQUIRE(ctx->memory_high_water == ctx->memory_pointer);
+
+    // The context keeps working, and grows back
+    evalTest(ctx, "grown-0 grown-1999 +", FORTH_SUCCESS, {99});
+    REQUIRE(forth_eval(ctx, "DROP") == FORTH_SUCCESS);
+    REQUIRE(forth_eval(ctx, words.c_str()) == FORTH_SUCCESS);
+    REQUIRE(forth_eval(ctx, pushes.c_str()) == FORTH_SUCCESS);
+    REQUIRE(ctx->stack_pointer == 3000);
+
+    forth_destroy_context(ctx);
+
+    SECTION("Reserved memory")
+    {
+        forth_context_options options = forth_default_context_options();
+        options.reserve_memory = 1;
+        forth_context* reserved = forth_create_context_ex(&options);
+        REQUIRE(reserved);
+
+        REQUIRE(forth_eval(reserved, words.c_str()) == FORTH_SUCCESS);
+        uint8_t* memory = reserved->memory;
+        REQUIRE(forth_trim(reserved) == FORTH_SUCCESS);
+        REQUIRE(reserved->memory == memory);
+        evalTest(reserved, "grown-0 grown-1999 +", FORTH_SUCCESS, {99});
+
+        forth_destroy_context(reserved);
+    }
+
+    SECTION("Frozen context")
+    {
+        forth_context* frozen = forth_create_context();
+        forth_freeze_context(frozen);
+        REQUIRE(forth_trim(frozen) == FORTH_FAILURE);
+        forth_destroy_context(frozen);
+    }
+}
+
+static int imageAnswer(forth_context* ctx)
+{
+    return forthi_push_int_number(ctx, 42);
+}
+
+TEST_CASE("image", "[image]")
+{
+    const char* path = "test_image.fimg";
+    forth_c_word c_words[] = {{"ANSWER", imageAnswer}};
+
+    forth_context* ctx = forth_create_context();
+    REQUIRE(forth_add_c_word(ctx, "ANSWER", imageAnswer) == FORTH_SUCCESS);
+    REQUIRE(forth_eval(ctx, 
+        ": SQUARE DUP * ; "
+        ": COUNTDOWN BEGIN 1 - DUP 0= UNTIL ; "
+        ": GREETING S\" hello\" ; "
+        "MARKER FORGET-ME "
+        ": QUESTION ANSWER 1 + ; "
+        "HEX") == FORTH_SUCCESS);
+    REQUIRE(forth_save_image(ctx, path) == FORTH_SUCCESS);
+
+    SECTION("Load")
+    {
+        forth_context* loaded = forth_load_image(path, c_words, 1);
+        REQUIRE(loaded);
+        REQUIRE(loaded->memory_pointer == ctx->memory_pointer);
+        REQUIRE(loaded->dict_pointer == ctx->dict_pointer);
+        REQUIRE(loaded->fn_offsets_pointer == ctx->fn_offsets_pointer);
+
+        // BASE came along
+        evalTest(loaded, "10 DECIMAL", FORTH_SUCCESS, {16});
+        evalTest(loaded, "QUESTION 5 COUNTDOWN", FORTH_SUCCESS, {16, 43, 0});
+        REQUIRE(forth_eval(loaded, "2DROP DROP GREETING") == FORTH_SUCCESS);
+        REQUIRE(topString(loaded) == "hello");
+
+        // New definitions go after the loaded ones
+        evalTest(loaded, "2DROP : CUBE DUP SQUARE * ; 3 CUBE", FORTH_SUCCESS, {27});
+        evalTest(loaded, "DROP FORGET-ME QUESTION", FORTH_FAILURE, {}, "Undefined word\n");
+
+        forth_destroy_context(loaded);
+    }
+
+    SECTION("Missing C word")
+    {
+        REQUIRE_FALSE(forth_load_image(path));
+    }
+
+    SECTION("Truncated image")
+    {
+        FILE* file = fopen(path, "rb");
+        REQUIRE(file);
+        std::vector<char> image(64);
+        REQUIRE(fread(image.data(), 1, image.size(), file) == image.size());
+        fclose(file);
+
+        file = fopen(path, "wb");
+        fwrite(image.data(), 1, image.size(), file);
+        fclose(file);
+
+        REQUIRE_FALSE(forth_load_image(path, c_words, 1));
+    }
+
+    SECTION("Child context")
+    {
+        forth_freeze_context(ctx);
+        forth_context* child = forth_create_child_context(ctx);
+        REQUIRE(child);
+        LogCapturer log_capturer(child);
+        REQUIRE(forth_save_image(child, path) == FORTH_FAILURE);
+        REQUIRE(LogCapturer::log == "Can't save a child context\n");
+        forth_destroy_context(child);
+    }
+
+    SECTION("Map")
+    {
+        forth_context* mapped = forth_map_image(path, c_words, 1);
+        REQUIRE(mapped);
+        REQUIRE(mapped->frozen);
+        REQUIRE(mapped->memory_pointer == ctx->memory_pointer);
+        REQUIRE(memcmp(mapped->memory, ctx->memory, ctx->memory_pointer) == 0);
+#if FORTHI_HAS_MMAN
+        REQUIRE(mapped->memory >= mapped->image);
+        REQUIRE(mapped->memory + mapped->memory_pointer == mapped->image + mapped->image_size);
+#endif
+        evalTest(mapped, "1", FORTH_FAILURE, {}, "Context is frozen\n");
+
+        // Each child has its own data space and BASE
+        forth_context* child1 = forth_create_child_context(mapped);
+        forth_context* child2 = forth_create_child_context(mapped);
+        REQUIRE(child1);
+        REQUIRE(child2);
+        evalTest(child1, "QUESTION 5 COUNTDOWN", FORTH_SUCCESS, {43, 0});
+        REQUIRE(forth_eval(child1, "2DROP GREETING") == FORTH_SUCCESS);
+        REQUIRE(topString(child1) == "hello");
+        evalTest(child2, ": CUBE DUP SQUARE * ; 3 CUBE", FORTH_SUCCESS, {27});
+        evalTest(child1, "2DROP 3 CUBE", FORTH_FAILURE, {}, "Undefined word\n");
+
+        forth_destroy_context(child1);
+        forth_destroy_context(child2);
+        forth_destroy_context(mapped);
+
+        REQUIRE_FALSE(forth_map_image(path));
+        REQUIRE_FALSE(forth_map_image("missing.fimg"));
+    }
+
+    SECTION("Map relocates C functions")
+    {
+        // As if saved by another build of the program
+        forthi_image_header header;
+        forth_pointer offset = ctx->fn_offsets[0];
+        std::vector<uint8_t> garbage(sizeof(forth_c_func), 0xAB);
+        FILE* file = fopen(path, "r+b");
+        REQUIRE(file);
+        REQUIRE(fread(&header, sizeof(header), 1, file) == 1);
+        fseek(file, (long)(header.memory_offset + offset), SEEK_SET);
+        fwrite(garbage.data(), 1, garbage.size(), file);
+        fclose(file);
+
+        forth_context* mapped = forth_map_image(path, c_words, 1);
+        REQUIRE(mapped);
+        REQUIRE(memcmp(mapped->memory + offset, ctx->memory + offset, sizeof(forth_c_func)) == 0);
+
+        forth_context* child = forth_create_child_context(mapped);
+        REQUIRE(child);
+        evalTest(child, "QUESTION", FORTH_SUCCESS, {43});
+        forth_destroy_context(child);
+        forth_destroy_context(mapped);
+    }
+
+    SECTION("Tree shaking")
+    {
+        REQUIRE(forth_eval(ctx, ": UNUSED SWAP OVER ; : CUBE DUP SQUARE * ;") == FORTH_SUCCESS);
+        const char* roots[] = {"CUBE", "COUNTDOWN", "GREETING", "QUESTION", "DROP", "DECIMAL", "EMPTY"};
+        REQUIRE(forth_save_image(ctx, path, roots, 7) == FORTH_SUCCESS);
+
+        forth_context* loaded = forth_load_image(path, c_words, 1);
+        REQUIRE(loaded);
+        REQUIRE(loaded->memory_pointer < ctx->memory_pointer / 4);
+        REQUIRE(loaded->dict_pointer < ctx->dict_pointer / 4);
+
+        evalTest(loaded, "10 DECIMAL", FORTH_SUCCESS, {16});
+        evalTest(loaded, "DROP 3 CUBE 5 COUNTDOWN QUESTION", FORTH_SUCCESS, {27, 0, 43});
+        REQUIRE(forth_eval(loaded, "DROP DROP DROP GREETING") == FORTH_SUCCESS);
+        REQUIRE(topString(loaded) == "hello");
+
+        // Called words and C words come along, the rest doesn't
+        evalTest(loaded, "DROP DROP 4 SQUARE ANSWER", FORTH_SUCCESS, {16, 42});
+        evalTest(loaded, "UNUSED", FORTH_FAILURE, {}, "Undefined word\n");
+        evalTest(loaded, "1 2 SWAP", FORTH_FAILURE, {}, "Undefined word\n");
+        evalTest(loaded, "FORGET-ME", FORTH_FAILURE, {}, "Undefined word\n");
+
+        // Only the standard words used are left after EMPTY
+        evalTest(loaded, "EMPTY 2 DUP *", FORTH_SUCCESS, {4});
+        evalTest(loaded, "DROP 3 CUBE", FORTH_FAILURE, {}, "Undefined word\n");
+        forth_destroy_context(loaded);
+    }
+
+    SECTION("Tree shaking markers")
+    {
+        const char* roots[] = {"FORGET-ME", "QUESTION", "DROP"};
+        REQUIRE(forth_save_image(ctx, path, roots, 3) == FORTH_SUCCESS);
+
+        forth_context* loaded = forth_load_image(path, c_words, 1);
+        REQUIRE(loaded);
+        evalTest(loaded, "QUESTION", FORTH_SUCCESS, {43});
+        evalTest(loaded, "DROP FORGET-ME ANSWER", FORTH_SUCCESS, {42});
+        evalTest(loaded, "DROP QUESTION", FORTH_FAILURE, {}, "Undefined word\n");
+        forth_destroy_context(loaded);
+
+        const char* missing[] = {"MISSING"};
+        LogCapturer log_capturer(ctx);
+        REQUIRE(forth_save_image(ctx, path, missing, 1) == FORTH_FAILURE);
+        REQUIRE(LogCapturer::log == "Undefined word\n");
+    }
+
+    SECTION("Missing file")
+    {
+        REQUIRE_FALSE(forth_load_image("missing.fimg"));
+    }
+
+    forth_destroy_context(ctx);
+    std::remove(path);
+}
+
+TEST_CASE("child_context", "[child_context]")
+{
+    forth_context* base = forth_create_context();
+    REQUIRE(forth_eval(base, ": SQUARE DUP * ;") == FORTH_SUCCESS);
+
+    SECTION("Base must be frozen")
+    {
+        REQUIRE_FALSE(forth_create_child_context(base));
+    }
+
+    forth_freeze_context(base);
+
+    SECTION("Frozen base can't evaluate")
+    {
+        evalTest(base, "1", FORTH_FAILURE, {}, "Context is frozen\n");
+    }
+
+    SECTION("Children share the base words")
+    {
+        forth_context* child1 = forth_create_child_context(base);
+        forth_context* child2 = forth_create_child_context(base);
+        REQUIRE(child1);
+        REQUIRE(child2);
+
+        // Child memory starts where the base's memory ends
+        REQUIRE(child1->memory_pointer > base->memory_pointer);
+        REQUIRE(child1->memory_size - (int)child1->shared_memory_size < base->memory_size);
+
+        evalTest(child1, "3 SQUARE", FORTH_SUCCESS, {9});
+        evalTest(child1, "DROP : CUBE DUP SQUARE * ;", FORTH_SUCCESS, {});
+        evalTest(child1, "3 CUBE", FORTH_SUCCESS, {27});
+        evalTest(child2, "3 CUBE", FORTH_FAILURE, {}, "Undefined word\n");
+
+        // Words can be redefined without touching the base
+        evalTest(child2, ": SQUARE DROP 0 ;", FORTH_SUCCESS, {});
+        evalTest(child2, "3 SQUARE", FORTH_SUCCESS, {0});
+        evalTest(child1, "2 SQUARE", FORTH_SUCCESS, {27, 4});
+
+        // BASE is per context
+        evalTest(child1, "2DROP HEX 10", FORTH_SUCCESS, {16});
+        evalTest(child2, "DROP 10", FORTH_SUCCESS, {10});
+
+        // EMPTY and FORGET only affect the child's own words
+        evalTest(child1, "DROP EMPTY 3 SQUARE", FORTH_SUCCESS, {9});
+        evalTest(child1, "CUBE", FORTH_FAILURE, {}, "Undefined word\n");
+        evalTest(child2, "DROP FORGET SQUARE 3 SQUARE", FORTH_SUCCESS, {9});
+
+        forth_destroy_context(child1);
+        forth_destroy_context(child2);
+    }
+
+    forth_destroy_context(base);
+}
+
+TEST_CASE("clone_context", "[clone_context]")
+{
+    forth_context* ctx = forth_create_context();
+    REQUIRE(forth_eval(ctx, ": SQUARE DUP * ; 1 2 3") == FORTH_SUCCESS);
+
+    forth_context* clone = forth_clone_context(ctx);
+    REQUIRE(clone);
+    REQUIRE(clone->memory_pointer == ctx->memory_pointer);
+    REQUIRE(clone->dict_pointer == ctx->dict_pointer);
+
+    // Stacks and words are copied, then both contexts are independent
+    evalTest(clone, "SQUARE", FORTH_SUCCESS, {1, 2, 9});
+    evalTest(clone, ": CUBE DUP SQUARE * ; DROP 3 CUBE", FORTH_SUCCESS, {1, 2, 27});
+    evalTest(ctx, "CUBE", FORTH_FAILURE, {}, "Undefined word\n");
+    evalTest(ctx, "HEX 10", FORTH_SUCCESS, {16});
+    evalTest(clone, "DROP 10", FORTH_SUCCESS, {1, 2, 10});
+
+    // Growing buffers that live in the clone's single allocation
+    defineGeneratedWords(clone, "generated-word-", 2000);
+    evalTest(clone, "2DROP DROP generated-word-1999", FORTH_SUCCESS, {99});
+
+    forth_destroy_context(clone);
+    forth_destroy_context(ctx);
+}
+
+TEST_CASE("eval_n", "[eval_n]")
+{
+    forth_context* ctx = forth_create_context();
+
+    // Only the slice is read, whatever follows it
+    const char* code = "12 34 DUP ( comment ) S\" text\" 56";
+    REQUIRE(forth_eval_n(ctx, code, 4) == FORTH_SUCCESS);
+    REQUIRE(ctx->stack_pointer == 2);
+    REQUIRE(ctx->stack[1].int_value == 3);
+    REQUIRE(forth_eval_n(ctx, code + 6, 3) == FORTH_SUCCESS);
+    REQUIRE(ctx->stack_pointer == 3);
+    REQUIRE(forth_eval_n(ctx, code + 10, 5) == FORTH_SUCCESS);
+    REQUIRE(ctx->stack_pointer == 3);
+    REQUIRE(forth_eval_n(ctx, code + 22, 6) == FORTH_SUCCESS);
+    REQUIRE(topString(ctx) == "tex");
+
+    // No null at all
+    std::string source = ": SQUARE DUP * ; 7 SQUARE";
+    std::vector<char> buffer(source.begin(), source.end());
+    REQUIRE(forth_eval_n(ctx, buffer.data(), buffer.size()) == FORTH_SUCCESS);
+    REQUIRE(forth_get_top(ctx)->int_value == 49);
+
+    REQUIRE(forth_eval_n(ctx, code, 0) == FORTH_SUCCESS);
+    REQUIRE(forth_eval_n(ctx, NULL, 0) == FORTH_FAILURE);
+
+    forth_destroy_context(ctx);
+}
+
+static void addCellWords(forth_context* ctx);
+
+struct ChunkReader
+{
+    std::string text;
+    size_t at;
+    int chunk_size;
+};
+
+// Hands out the text a few bytes at a time, -1 chunk size fails
+static int readChunks(void* user, char* buffer, int size)
+{
+    ChunkReader* reader = (ChunkReader*)user;
+    if (reader->chunk_size < 0)
+        return -1;
+
+    size_t count = std::min(reader->text.size() - reader->at, (size_t)std::min(size, reader->chunk_size));
+    memcpy(buffer, reader->text.data() + reader->at, count);
+    reader->at += count;
+    return (int)count;
+}
+
+static int evalStream(forth_context* ctx, const std::string& text, int chunk_size)
+{
+    ChunkReader reader = {text, 0, chunk_size};
+    return forth_eval_stream(ctx, readChunks, &reader);
+}
+
+TEST_CASE("eval_stream", "[eval_stream]")
+{
+    forth_context* ctx = forth_create_context();
+
+    for (int chunk_size : {1, 5, 4096})
+    {
+        SECTION("Chunks of " + std::to_string(chunk_size))
+        {
+            // Definitions and comments span lines
+            const char* code = ": SQUARE ( n -- n*n\n  squared )\n  DUP * ;\n7 SQUARE\n\n";
+            REQUIRE(evalStream(ctx, code, chunk_size) == FORTH_SUCCESS);
+            REQUIRE(ctx->stack_pointer == 1);
+            REQUIRE(forth_get_top(ctx)->int_value == 49);
+
+            REQUIRE(evalStream(ctx, "1 REFILL 2\n3 ( 4 )\r\n5", chunk_size) == FORTH_SUCCESS);
+            REQUIRE(ctx->stack_pointer == 5);
+            REQUIRE(forth_get_top(ctx, 2)->int_value == -1);
+            REQUIRE(forth_get_top(ctx, 1)->int_value == 3);
+            REQUIRE(forth_get_top(ctx)->int_value == 5);
+        }
+    }
+
+    SECTION("Input words")
+    {
+        REQUIRE(evalStream(ctx, "REFILL", 16) == FORTH_SUCCESS);
+        REQUIRE(forth_get_top(ctx)->int_value == 0);
+
+        REQUIRE(evalStream(ctx, "SOURCE\nSOURCE", 16) == FORTH_SUCCESS);
+        REQUIRE(topString(ctx) == "SOURCE");
+        REQUIRE(forth_get_top(ctx, 2)->int_value == 6);
+
+        // >IN is per line
+        addCellWords(ctx);
+        REQUIRE(evalStream(ctx, ">IN CELL@ 1\n>IN CELL@", 16) == FORTH_SUCCESS);
+        REQUIRE(forth_get_top(ctx)->int_value == 9);
+
+        // Only the current line can be restored
+        REQUIRE(evalStream(ctx, "SAVE-INPUT\nRESTORE-INPUT", 16) == FORTH_SUCCESS);
+        REQUIRE(forth_get_top(ctx)->int_value == -1);
+    }
+
+    SECTION("Constant memory")
+    {
+        std::string line = "S\" hello world\" 2DROP\n";
+        REQUIRE(evalStream(ctx, line, 4096) == FORTH_SUCCESS);
+        int transient_size = ctx->transient_size;
+
+        std::string code;
+        for (int i = 0; i < 10000; ++i)
+            code += line;
+        REQUIRE(evalStream(ctx, code, 4096) == FORTH_SUCCESS);
+        REQUIRE(ctx->stack_pointer == 0);
+        REQUIRE(ctx->transient_size == transient_size);
+    }
+
+    SECTION("Errors")
+    {
+        LogCapturer log_capturer(ctx);
+
+        REQUIRE(evalStream(ctx, std::string(FORTH_INPUT_BUFFER_SIZE, '1'), 4096) == FORTH_FAILURE);
+        REQUIRE(LogCapturer::log == "Input line too long\n");
+
+        LogCapturer::log.clear();
+        REQUIRE(evalStream(ctx, "1", -1) == FORTH_FAILURE);
+        REQUIRE(LogCapturer::log == "Error reading input\n");
+
+        LogCapturer::log.clear();
+        REQUIRE(evalStream(ctx, "1 2\n3 FOO\n4", 16) == FORTH_FAILURE);
+        REQUIRE(ctx->stack_pointer == 0);
+
+        REQUIRE(forth_eval_stream(ctx, NULL, NULL) == FORTH_FAILURE);
+    }
+
+    SECTION("File")
+    {
+        FILE* file = tmpfile();
+        REQUIRE(file);
+        fputs(": CUBE DUP DUP * *\n;\n3 CUBE\n", file);
+        rewind(file);
+        REQUIRE(forth_eval_stream(ctx, forth_read_file, file) == FORTH_SUCCESS);
+        REQUIRE(forth_get_top(ctx)->int_value == 27);
+        fclose(file);
+    }
+
+    forth_destroy_context(ctx);
+}
+
+TEST_CASE("tokenizer", "[tokenizer]")
+{
+    forth_context* ctx = forth_create_context();
+
+    SECTION("Runs of every length")
+    {
+        // Around the scalar and block sizes, ending on each space character
+        // or right at the end of the code
+        const char separators[] = {' ', '\t', '\n', '\r', '\0'};
+        for (int len = 1; len < 80; len++)
+        {
+            for (int i = 0; i <= (int)sizeof(separators); i++)
+            {
+                std::string code = std::string(len, separators[len % sizeof(separators)]) + std::string(len, 'w');
+                if (i < (int)sizeof(separators))
+                    code += separators[i];
+
+                ctx->code = code.data();
+                ctx->code_end = code.data() + code.size();
+                size_t token_len = 0;
+                const char* token = forthi_get_next_token(ctx, &token_len);
+                REQUIRE(token == code.data() + len);
+                REQUIRE(token_len == (size_t)len);
+                REQUIRE(forthi_get_next_token(ctx, &token_len) == NULL);
+            }
+        }
+    }
+
+    SECTION("Long names and indentation")
+    {
+        std::string name(70, 'N');
+        std::string code = std::string(40, ' ') + ": " + name + "\n" + std::string(33, '\t') + "7 ;\r\n" + name;
+        evalTest(ctx, code.c_str(), FORTH_SUCCESS, {7});
+    }
+
+    forth_destroy_context(ctx);
+}
+
+// Tokenizes large scripts: a data table with short tokens, and indented code
+// with long names. Run with the [.benchmark] tag.
+TEST_CASE("tokenizer_benchmark", "[.benchmark]")
+{
+    const char* filename = "tokenizer_benchmark.f";
+    forth_context* ctx = forth_create_context();
+
+    for (int wide = 0; wide < 2; wide++)
+    {
+        FILE* file = fopen(filename, "wb");
+        REQUIRE(file);
+        for (int i = 0; i < 2 * 1000 * 1000; i++)
+        {
+            if (wide)
+                fprintf(file, "                CUSTOMER-RECORD-FIELD-%d    INVOICE-LINE-ITEM-%d    !\n", i, i);
+            else
+                fprintf(file, "%d , %d ,    %d , TABLE-ENTRY-%d\t( row %d )\r\n", i, i * 7, -i, i % 100, i);
+        }
+        fclose(file);
+
+        forthi_source source;
+        REQUIRE(forthi_open_source(ctx, filename, &source) == FORTH_SUCCESS);
+
+        auto start = std::chrono::steady_clock::now();
+        size_t token_count = 0;
+        size_t token_len;
+        ctx->code = source.text;
+        ctx->code_end = source.text + source.size;
+        while (forthi_get_next_token(ctx, &token_len))
+            token_count++;
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+        WARN((wide ? "Wide: " : "Table: ") << elapsed.count() << " ms (" << token_count << " tokens, " 
+             << source.size / (1024 * 1024) << " MB)");
+
+        forthi_close_source(ctx, &source);
+    }
+
+    forth_destroy_context(ctx);
+    remove(filename);
 }
 
 // Testing examples and exercices from the book titled "Starting FORTH"
@@ -278,7 +1266,8 @@ TEST_CASE("Starting FORTH", "[StartingForth]")
     evalTest(ctx, ": % 100 */ ;", FORTH_SUCCESS, {}, "");
 #if FORTH_INT_SIZE_8_BITS
     evalTest(ctx, "225 32 % .", FORTH_SUCCESS, {}, "-10 ");
-    evalTest(ctx, "2000 34 100 */ .", FORTH_SUCCESS, {}, "-17 ");
+    evalTest(ctx, "2000 34 100 */ .", FORTH_FAILURE, {}, "Number out of range\n");
+    evalTest(ctx, "208 34 100 */ .", FORTH_SUCCESS, {}, "-17 ");
 #else
     evalTest(ctx, "225 32 % .", FORTH_SUCCESS, {}, "72 ");
     evalTest(ctx, "2000 34 100 */ .", FORTH_SUCCESS, {}, "680 ");
@@ -465,7 +1454,13 @@ TEST_CASE("number_sign", "[number_sign]")
 {
     forth_context* ctx = forth_create_context();
 
-    evalTestSection(ctx, "#", FORTH_FAILURE, {}, "Unimplemented\n");
+    evalTestSection(ctx, "#", FORTH_FAILURE, {}, "Stack underflow\n");
+    evalTestSection(ctx, "1 0 #", FORTH_FAILURE, {}, "Missing <#\n");
+    evalTestSection(ctx, "<# 123 0 #", FORTH_SUCCESS, {12, 0});
+    evalTestSection(ctx, "<# 123 0 # # #", FORTH_SUCCESS, {0, 0});
+
+    REQUIRE(forth_eval(ctx, "<# 123 0 # # # # #>") == FORTH_SUCCESS);
+    REQUIRE(topString(ctx) == "0123");
 
     forth_destroy_context(ctx);
 }
@@ -474,7 +1469,11 @@ TEST_CASE("number_sign_greater", "[number_sign_greater]")
 {
     forth_context* ctx = forth_create_context();
 
-    evalTestSection(ctx, "#>", FORTH_FAILURE, {}, "Unimplemented\n");
+    evalTestSection(ctx, "#>", FORTH_FAILURE, {}, "Stack underflow\n");
+    evalTestSection(ctx, "0 0 #>", FORTH_FAILURE, {}, "Missing <#\n");
+
+    REQUIRE(forth_eval(ctx, "<# 65 HOLD 66 HOLD 0 0 #>") == FORTH_SUCCESS);
+    REQUIRE(topString(ctx) == "BA");
 
     forth_destroy_context(ctx);
 }
@@ -483,7 +1482,26 @@ TEST_CASE("number_sign_s", "[number_sign_s]")
 {
     forth_context* ctx = forth_create_context();
 
-    evalTestSection(ctx, "#S", FORTH_FAILURE, {}, "Unimplemented\n");
+    evalTestSection(ctx, "#S", FORTH_FAILURE, {}, "Stack underflow\n");
+    evalTestSection(ctx, "<# 123 0 #S", FORTH_SUCCESS, {0, 0});
+
+    SECTION("Bases")
+    {
+        REQUIRE(forth_eval(ctx, "<# 0 0 #S #>") == FORTH_SUCCESS);
+        REQUIRE(topString(ctx) == "0");
+        REQUIRE(forth_eval(ctx, "<# 127 0 #S #>") == FORTH_SUCCESS);
+        REQUIRE(topString(ctx) == "127");
+        REQUIRE(forth_eval(ctx, "HEX <# 7F 0 #S #>") == FORTH_SUCCESS);
+        REQUIRE(topString(ctx) == "7F");
+        REQUIRE(forth_eval(ctx, "OCTAL <# 10 0 #S #>") == FORTH_SUCCESS);
+        REQUIRE(topString(ctx) == "10");
+    }
+
+    SECTION("Compiled")
+    {
+        REQUIRE(forth_eval(ctx, ": FORMAT 0 <# #S #> ; 42 FORMAT") == FORTH_SUCCESS);
+        REQUIRE(topString(ctx) == "42");
+    }
 
     forth_destroy_context(ctx);
 }
@@ -1132,6 +2150,27 @@ TEST_CASE("two_variable", "[two_variable]")
     forth_destroy_context(ctx);
 }
 
+#if FORTH_DICT_CACHE_SIZE > 0
+// Returns another name using the same dictionnary cache slot
+static std::string collidingName(const std::string& name)
+{
+    uint32_t slot = forthi_hash_name(name.c_str(), name.size()) & (FORTH_DICT_CACHE_SIZE - 1);
+    for (int i = 0;; i++)
+    {
+        std::string other = "collide-" + std::to_string(i);
+        if ((forthi_hash_name(other.c_str(), other.size()) & (FORTH_DICT_CACHE_SIZE - 1)) == slot)
+            return other;
+    }
+}
+#endif
+
+static int dictCacheHits(forth_context* ctx)
+{
+    forth_stats stats;
+    forth_get_stats(ctx, &stats);
+    return stats.dict_cache_hits;
+}
+
 TEST_CASE("colon", "[colon]")
 {
     forth_context* ctx = forth_create_context();
@@ -1144,6 +2183,79 @@ TEST_CASE("colon", "[colon]")
     evalTestSection(ctx, ": foo : bar ; ;", FORTH_FAILURE, {}, "Undefined word\n");
     evalTestSection(ctx, "foo foo1 foo foo2", FORTH_FAILURE, {}, "Undefined word\n");
     evalTestSection(ctx, ": GDX 123 ; : GDX GDX 234 ; GDX", FORTH_SUCCESS, {123, (forth_int)234});
+    evalTestSection(ctx, ": foo 1 ; foo foo : foo 2 ; foo", FORTH_SUCCESS, {1, 1, 2});
+    evalTestSection(ctx, ": foo 1 ; foo : foo foo 2 ; foo foo", FORTH_SUCCESS, {1, 1, 2, 1, 2});
+    evalTestSection(ctx, ": generated-word-with-a-very-long-name-001 1 ; "
+                         ": generated-word-with-a-very-long-name-002 2 ; "
+                         "generated-word-with-a-very-long-name-001", FORTH_SUCCESS, {1});
+
+    SECTION("Cached lookups")
+    {
+        evalTest(ctx, ": cached 7 ; cached", FORTH_SUCCESS, {7});
+        int hits = dictCacheHits(ctx);
+        evalTest(ctx, "DROP cached", FORTH_SUCCESS, {7});
+#if FORTH_DICT_CACHE_SIZE > 0
+        REQUIRE(dictCacheHits(ctx) == hits + 1);
+#else
+        REQUIRE(dictCacheHits(ctx) == hits);
+#endif
+    }
+
+    SECTION("Cached then forgotten")
+    {
+        evalTest(ctx, ": gone 1 ; gone gone", FORTH_SUCCESS, {1, 1});
+        evalTest(ctx, "2DROP FORGET gone", FORTH_SUCCESS, {});
+        evalTest(ctx, "gone", FORTH_FAILURE, {}, "Undefined word\n");
+    }
+
+    SECTION("Cached then removed by a marker")
+    {
+        evalTest(ctx, "MARKER -mark : gone 1 ; gone gone", FORTH_SUCCESS, {1, 1});
+        evalTest(ctx, "2DROP -mark", FORTH_SUCCESS, {});
+        evalTest(ctx, "gone", FORTH_FAILURE, {}, "Undefined word\n");
+        evalTest(ctx, ": gone 2 ; gone", FORTH_SUCCESS, {2});
+    }
+
+    SECTION("Cached from a base then shadowed")
+    {
+        evalTest(ctx, ": shared 1 ;", FORTH_SUCCESS, {});
+        forth_freeze_context(ctx);
+        forth_context* child = forth_create_child_context(ctx);
+        REQUIRE(child);
+
+        evalTest(child, "shared shared", FORTH_SUCCESS, {1, 1});
+        evalTest(child, "2DROP : shared 2 ; shared", FORTH_SUCCESS, {2});
+        evalTest(child, "DROP : wrapped shared 3 ; wrapped", FORTH_SUCCESS, {2, 3});
+
+        forth_destroy_context(child);
+    }
+
+    SECTION("Cached then dictionnary grows")
+    {
+        evalTest(ctx, ": early 5 ; early", FORTH_SUCCESS, {5});
+        int dict_size = ctx->dict_size;
+        REQUIRE(forth_reserve(ctx, 0, 0, 0, dict_size) == FORTH_SUCCESS);
+        REQUIRE(ctx->dict_size > dict_size);
+
+        // Entries moved but the cached position still holds
+        int hits = dictCacheHits(ctx);
+        evalTest(ctx, "DROP early", FORTH_SUCCESS, {5});
+#if FORTH_DICT_CACHE_SIZE > 0
+        REQUIRE(dictCacheHits(ctx) == hits + 1);
+#endif
+
+        defineGeneratedWords(ctx, "grown-", 2000);
+        evalTest(ctx, "DROP early grown-1999", FORTH_SUCCESS, {5, 99});
+    }
+
+#if FORTH_DICT_CACHE_SIZE > 0
+    SECTION("Names sharing a cache slot")
+    {
+        std::string other = collidingName("first");
+        std::string code = ": first 1 ; : " + other + " 2 ; first " + other + " first " + other;
+        evalTest(ctx, code.c_str(), FORTH_SUCCESS, {1, 2, 1, 2});
+    }
+#endif
 
     //    forth::eval(ctx, ": print-stack-top  cr dup .\" The top of the stack is \" . cr .\" which looks like '\" dup emit .\" ' in ascii  \" ;");
     //forth::eval(ctx, "48 print-stack-top");
@@ -1206,7 +2318,16 @@ TEST_CASE("less_number_sign", "[less_number_sign]")
 {
     forth_context* ctx = forth_create_context();
 
-    evalTestSection(ctx, "<#", FORTH_FAILURE, {}, "Unimplemented\n");
+    evalTestSection(ctx, "<#", FORTH_SUCCESS, {});
+
+    REQUIRE(forth_eval(ctx, "<# 0 0 #>") == FORTH_SUCCESS);
+    REQUIRE(topString(ctx) == "");
+
+    forth_pointer memory_pointer = ctx->memory_pointer;
+    REQUIRE(forth_eval(ctx, "<# 1 0 #S #> <# 2 0 #S #>") == FORTH_SUCCESS);
+    REQUIRE(topString(ctx) == "2");
+    REQUIRE(forth_get_top(ctx, 1)->pointer_value == forth_get_top(ctx, 3)->pointer_value);
+    REQUIRE(ctx->memory_pointer == memory_pointer);
 
     forth_destroy_context(ctx);
 }
@@ -1289,11 +2410,43 @@ TEST_CASE("to_float", "[to_float]")
     forth_destroy_context(ctx);
 }
 
+// @ and ! aren't implemented yet
+static int cellFetch(forth_context* ctx)
+{
+    forth_cell* address = forth_get_top(ctx);
+    if (!address)
+        return FORTH_FAILURE;
+
+    address->int_value = *(forth_int*)forthi_memory_at(ctx, address->pointer_value);
+    return FORTH_SUCCESS;
+}
+
+static int cellStore(forth_context* ctx)
+{
+    if (ctx->stack_pointer < 2)
+        return FORTH_FAILURE;
+
+    *(forth_int*)forthi_memory_at(ctx, forth_get_top(ctx)->pointer_value) = forth_get_top(ctx, 1)->int_value;
+    ctx->stack_pointer -= 2;
+    return FORTH_SUCCESS;
+}
+
+static void addCellWords(forth_context* ctx)
+{
+    REQUIRE(forth_add_c_word(ctx, "CELL@", cellFetch) == FORTH_SUCCESS);
+    REQUIRE(forth_add_c_word(ctx, "CELL!", cellStore) == FORTH_SUCCESS);
+}
+
 TEST_CASE("to_in", "[to_in]")
 {
     forth_context* ctx = forth_create_context();
 
-    evalTestSection(ctx, ">IN", FORTH_FAILURE, {}, "Unimplemented\n");
+    addCellWords(ctx);
+
+    evalTestSection(ctx, ">IN CELL@", FORTH_SUCCESS, {9});
+    evalTestSection(ctx, "1 >IN CELL@ 2", FORTH_SUCCESS, {1, 11, 2});
+    evalTestSection(ctx, "1 >IN CELL@ 17 + >IN CELL! 2 3 4", FORTH_SUCCESS, {1, 3, 4});
+    evalTestSection(ctx, ": SKIP-LINE SOURCE SWAP DROP >IN CELL! ; 1 SKIP-LINE 2 3", FORTH_SUCCESS, {1});
 
     forth_destroy_context(ctx);
 }
@@ -1456,7 +2609,53 @@ TEST_CASE("ALLOCATE", "[ALLOCATE]")
 {
     forth_context* ctx = forth_create_context();
 
-    evalTestSection(ctx, "ALLOCATE", FORTH_FAILURE, {}, "Unimplemented\n");
+    evalTestSection(ctx, "ALLOCATE", FORTH_FAILURE, {}, "Stack underflow\n");
+
+    SECTION("Heap addresses")
+    {
+        REQUIRE(forth_eval(ctx, "10 ALLOCATE DROP 100 ALLOCATE") == FORTH_SUCCESS);
+        REQUIRE(ctx->stack_pointer == 3);
+        REQUIRE(forth_get_top(ctx)->int_value == 0);
+
+        // Addresses are valid Forth addresses, in distinct blocks
+        forth_pointer a = forth_get_top(ctx, 2)->pointer_value;
+        forth_pointer b = forth_get_top(ctx, 1)->pointer_value;
+        forth_pointer c = 0;
+        REQUIRE(forthi_heap_alloc(ctx, 5000, &c) == FORTH_SUCCESS);
+        REQUIRE(forthi_check_valid_memory_range(ctx, a, 10) == FORTH_SUCCESS);
+        REQUIRE(forthi_check_valid_memory_range(ctx, b, 100) == FORTH_SUCCESS);
+        REQUIRE(forthi_check_valid_memory_range(ctx, c, 5000) == FORTH_SUCCESS);
+        REQUIRE(a + 10 <= b);
+        REQUIRE(b + 100 <= c);
+        REQUIRE(a % sizeof(uintptr_t) == 0);
+
+        memset(forthi_memory_at(ctx, a), 1, 10);
+        memset(forthi_memory_at(ctx, b), 2, 100);
+        REQUIRE(*forthi_memory_at(ctx, a + 9) == 1);
+        REQUIRE(*forthi_memory_at(ctx, b) == 2);
+
+        forth_heap_stats stats;
+        forth_get_heap_stats(ctx, &stats);
+        REQUIRE(stats.block_count == 3);
+        REQUIRE(stats.used == 5110);
+        REQUIRE(stats.allocated == 32 + 128 + 8192);
+        REQUIRE(stats.free == 0);
+        REQUIRE(stats.fragmentation > 0.0);
+    }
+
+    SECTION("Cloned heap")
+    {
+        REQUIRE(forth_eval(ctx, "10 ALLOCATE DROP") == FORTH_SUCCESS);
+        forth_pointer a = forth_get_top(ctx)->pointer_value;
+        *forthi_memory_at(ctx, a) = 42;
+
+        forth_context* clone = forth_clone_context(ctx);
+        REQUIRE(*forthi_memory_at(clone, a) == 42);
+        evalTest(clone, "FREE DROP 10 ALLOCATE DROP", FORTH_SUCCESS, {(int64_t)forth_get_top(ctx)->int_value});
+        REQUIRE(forth_get_top(clone)->pointer_value == a);
+
+        forth_destroy_context(clone);
+    }
 
     forth_destroy_context(ctx);
 }
@@ -2854,6 +4053,9 @@ TEST_CASE("FORGET", "[FORGET]")
     evalTest(ctx, "FORGET", FORTH_FAILURE, {}, "Undefined word\n");
     evalTest(ctx, "FORGET ", FORTH_FAILURE, {}, "Undefined word\n");
     evalTest(ctx, "FORGET word-that-doesn't-exist", FORTH_FAILURE, {}, "Undefined word\n");
+    evalTest(ctx, "FORGET DUP", FORTH_FAILURE, {}, "Protected word\n");
+
+    auto memory_pointer = ctx->memory_pointer;
 
     evalTest(ctx, ": 3DUP ( n1 n2 n3 -- n1 n2 n3 n1 n2 n3) DUP 2OVER ROT ;", FORTH_SUCCESS, {});
     evalTest(ctx, "1 2 3 3DUP", FORTH_SUCCESS, {1, 2, 3, 1, 2, 3}, "");
@@ -2881,6 +4083,19 @@ TEST_CASE("FORGET", "[FORGET]")
     evalTest(ctx, "WILL-SERVE", FORTH_FAILURE, {}, "Undefined word\n");
     evalTest(ctx, "1 2 2.F5 .", FORTH_SUCCESS, {}, "-1 ");
     evalTest(ctx, "1 2 3 3DUP", FORTH_SUCCESS, {1, 2, 3, 1, 2, 3}, "");
+    evalTest(ctx, "2DROP 2DROP 2DROP", FORTH_SUCCESS, {}, "");
+
+    // Forgotten words release their code and names
+    auto names_pointer = ctx->dict_names_pointer;
+    auto code_pointer = ctx->memory_pointer;
+    evalTest(ctx, ": SOME-TEMPORARY-WORD 1 ;", FORTH_SUCCESS, {});
+    REQUIRE(ctx->dict_names_pointer > names_pointer);
+    evalTest(ctx, "FORGET SOME-TEMPORARY-WORD", FORTH_SUCCESS, {}, "");
+    REQUIRE(ctx->dict_names_pointer == names_pointer);
+    REQUIRE(ctx->memory_pointer == code_pointer);
+
+    evalTest(ctx, "FORGET 3DUP", FORTH_SUCCESS, {}, "");
+    REQUIRE(ctx->memory_pointer == memory_pointer);
 
     forth_destroy_context(ctx);
 }
@@ -2916,7 +4131,56 @@ TEST_CASE("FREE", "[FREE]")
 {
     forth_context* ctx = forth_create_context();
 
-    evalTestSection(ctx, "FREE", FORTH_FAILURE, {}, "Unimplemented\n");
+    evalTestSection(ctx, "FREE", FORTH_FAILURE, {}, "Stack underflow\n");
+    evalTestSection(ctx, "10 ALLOCATE DROP FREE", FORTH_SUCCESS, {0});
+    evalTestSection(ctx, "10 ALLOCATE DROP DUP FREE DROP FREE", FORTH_SUCCESS, {-60});
+    evalTestSection(ctx, "0 FREE", FORTH_SUCCESS, {-60});
+    evalTestSection(ctx, "HERE FREE", FORTH_SUCCESS, {-60});
+
+    SECTION("Interior addresses")
+    {
+        // Data looking like block headers
+        forth_pointer large = 0;
+        REQUIRE(forthi_heap_alloc(ctx, 5000, &large) == FORTH_SUCCESS);
+        memset(forthi_memory_at(ctx, large), 0xAA, 5000);
+        REQUIRE(forthi_heap_free(ctx, large + 16) == FORTH_FAILURE);
+        REQUIRE(forthi_heap_free(ctx, large + 4096) == FORTH_FAILURE);
+
+        evalTest(ctx, "100 ALLOCATE DROP DUP 16 + FREE SWAP 8 + FREE", FORTH_SUCCESS, {-60, -60});
+
+        forth_heap_stats stats;
+        forth_get_heap_stats(ctx, &stats);
+        REQUIRE(stats.block_count == 2);
+        REQUIRE(stats.used == 5100);
+        REQUIRE(stats.free == 0);
+        REQUIRE(forthi_heap_free(ctx, large) == FORTH_SUCCESS);
+    }
+
+    SECTION("Free lists")
+    {
+        forth_pointer c = 0;
+        REQUIRE(forth_eval(ctx, "20 ALLOCATE DROP 10 ALLOCATE DROP") == FORTH_SUCCESS);
+        REQUIRE(forthi_heap_alloc(ctx, 5000, &c) == FORTH_SUCCESS);
+        forth_pointer a = forth_get_top(ctx)->pointer_value;
+        REQUIRE(forthi_heap_free(ctx, c) == FORTH_SUCCESS);
+        REQUIRE(forth_eval(ctx, "FREE DROP") == FORTH_SUCCESS);
+
+        forth_heap_stats stats;
+        forth_get_heap_stats(ctx, &stats);
+        REQUIRE(stats.block_count == 1);
+        REQUIRE(stats.used == 20);
+        REQUIRE(stats.free == 32 + 8192);
+
+        // Blocks of the same size class and large blocks that fit are reused
+        forth_pointer large = 0;
+        REQUIRE(forth_eval(ctx, "12 ALLOCATE DROP 100 ALLOCATE DROP") == FORTH_SUCCESS);
+        REQUIRE(forthi_heap_alloc(ctx, 4097, &large) == FORTH_SUCCESS);
+        REQUIRE(forth_get_top(ctx, 1)->pointer_value == a);
+        REQUIRE(large == c);
+        forth_get_heap_stats(ctx, &stats);
+        REQUIRE(stats.block_count == 4);
+        REQUIRE(stats.free == 0);
+    }
 
     forth_destroy_context(ctx);
 }
@@ -3118,7 +4382,11 @@ TEST_CASE("HOLD", "[HOLD]")
 {
     forth_context* ctx = forth_create_context();
 
-    evalTestSection(ctx, "HOLD", FORTH_FAILURE, {}, "Unimplemented\n");
+    evalTestSection(ctx, "HOLD", FORTH_FAILURE, {}, "Stack underflow\n");
+    evalTestSection(ctx, "65 HOLD", FORTH_FAILURE, {}, "Missing <#\n");
+
+    REQUIRE(forth_eval(ctx, "<# 5 0 #S 46 HOLD 37 HOLD #>") == FORTH_SUCCESS);
+    REQUIRE(topString(ctx) == "%.5");
 
     forth_destroy_context(ctx);
 }
@@ -3127,7 +4395,10 @@ TEST_CASE("HOLDS", "[HOLDS]")
 {
     forth_context* ctx = forth_create_context();
 
-    evalTestSection(ctx, "HOLDS", FORTH_FAILURE, {}, "Unimplemented\n");
+    evalTestSection(ctx, "HOLDS", FORTH_FAILURE, {}, "Stack underflow\n");
+
+    REQUIRE(forth_eval(ctx, "<# 7 0 #S S\" x = \" HOLDS #>") == FORTH_SUCCESS);
+    REQUIRE(topString(ctx) == "x = 7");
 
     forth_destroy_context(ctx);
 }
@@ -3197,6 +4468,92 @@ TEST_CASE("INCLUDE", "[INCLUDE]")
     forth_destroy_context(ctx);
 }
 
+TEST_CASE("include_unterminated", "[INCLUDE]")
+{
+    // A whole page ending with a number, so reading past the file's end 
+    // would fault when it's mapped
+    const char* path = "include_unterminated.f";
+    std::string code = ": PAGED 1 + ; ( comment";
+    std::string end = ") 41 PAGED 99";
+    code += std::string(4096 - code.size() - end.size(), ' ') + end;
+    REQUIRE(code.size() == 4096);
+
+    FILE* file = fopen(path, "wb");
+    REQUIRE(file);
+    fwrite(code.data(), 1, code.size(), file);
+    fclose(file);
+
+    forth_context* ctx = forth_create_context();
+    evalTest(ctx, "INCLUDE include_unterminated.f", FORTH_SUCCESS, {42, 99});
+    evalTest(ctx, "3 PAGED", FORTH_SUCCESS, {42, 99, 4});
+    forth_destroy_context(ctx);
+    std::remove(path);
+}
+
+TEST_CASE("include_cache", "[INCLUDE]")
+{
+    const char* cache_path = "./INCLUDE.f.fcache";
+    std::remove(cache_path);
+
+    forth_context_options options = forth_default_context_options();
+    options.include_cache_dir = ".";
+    forth_context* ctx = forth_create_context_ex(&options);
+    forth_stats stats;
+
+    // Compiled, then cached
+    evalTest(ctx, "INCLUDE INCLUDE.f foo", FORTH_SUCCESS, {}, "foo\n");
+    forth_get_stats(ctx, &stats);
+    REQUIRE(stats.include_cache_hits == 0);
+    FILE* file = fopen(cache_path, "rb");
+    REQUIRE(file);
+    fclose(file);
+
+    SECTION("Same state")
+    {
+        forth_context* other = forth_create_context_ex(&options);
+        evalTest(other, "INCLUDE INCLUDE.f foo", FORTH_SUCCESS, {}, "foo\n");
+        forth_get_stats(other, &stats);
+        REQUIRE(stats.include_cache_hits == 1);
+        REQUIRE(other->memory_pointer == ctx->memory_pointer);
+        REQUIRE(other->dict_pointer == ctx->dict_pointer);
+        REQUIRE(other->fn_offsets_pointer == ctx->fn_offsets_pointer);
+        REQUIRE(memcmp(other->memory, ctx->memory, ctx->memory_pointer) == 0);
+
+        // Cached words can be forgotten like the others
+        evalTest(other, "FORGET foo foo", FORTH_FAILURE, {}, "Undefined word\n");
+        forth_destroy_context(other);
+    }
+
+    SECTION("Different state")
+    {
+        forth_context* other = forth_create_context_ex(&options);
+        evalTest(other, "HEX INCLUDE INCLUDE.f foo", FORTH_SUCCESS, {}, "foo\n");
+        evalTest(other, ": baz ; INCLUDE INCLUDE.f foo", FORTH_SUCCESS, {}, "foo\n");
+        forth_get_stats(other, &stats);
+        REQUIRE(stats.include_cache_hits == 0);
+        forth_destroy_context(other);
+    }
+
+    SECTION("Files with effects")
+    {
+        evalTest(ctx, "INCLUDE INCLUDE_INCLUDE.f bar", FORTH_SUCCESS, {}, "foo\n");
+        REQUIRE_FALSE(fopen("./INCLUDE_INCLUDE.f.fcache", "rb"));
+    }
+
+    SECTION("Child context")
+    {
+        forth_freeze_context(ctx);
+        forth_context* child = forth_create_child_context(ctx);
+        evalTest(child, "INCLUDE INCLUDE.f foo", FORTH_SUCCESS, {}, "foo\n");
+        forth_get_stats(child, &stats);
+        REQUIRE(stats.include_cache_hits == 0);
+        forth_destroy_context(child);
+    }
+
+    forth_destroy_context(ctx);
+    std::remove(cache_path);
+}
+
 TEST_CASE("INCLUDE_FILE", "[INCLUDE_FILE]")
 {
     forth_context* ctx = forth_create_context();
@@ -3206,13 +4563,35 @@ TEST_CASE("INCLUDE_FILE", "[INCLUDE_FILE]")
     forth_destroy_context(ctx);
 }
 
+// A file pushing 7 each time it's loaded
+static void writeRequiredFile(const char* path)
+{
+    FILE* file = fopen(path, "wb");
+    REQUIRE(file);
+    fputs("7\n", file);
+    fclose(file);
+}
+
 TEST_CASE("INCLUDED", "[INCLUDED]")
 {
+    const char* path = "included.f";
+    writeRequiredFile(path);
     forth_context* ctx = forth_create_context();
 
-    evalTestSection(ctx, "INCLUDED", FORTH_FAILURE, {}, "Unimplemented\n");
+    evalTestSection(ctx, "INCLUDED", FORTH_FAILURE, {}, "Stack underflow\n");
+    evalTestSection(ctx, "0 0 INCLUDED", FORTH_FAILURE, {}, "No such file or directory\n");
+    evalTestSection(ctx, "S\" bad_filename.f\" INCLUDED", FORTH_FAILURE, {}, "No such file or directory\n");
+    evalTestSection(ctx, "S\" INCLUDE.f\" INCLUDED foo", FORTH_SUCCESS, {}, "foo\n");
+
+    SECTION("Loaded every time")
+    {
+        evalTest(ctx, "S\" included.f\" INCLUDED", FORTH_SUCCESS, {7});
+        evalTest(ctx, "S\" included.f\" INCLUDED", FORTH_SUCCESS, {7, 7});
+        REQUIRE(ctx->included_files_pointer == 1);
+    }
 
     forth_destroy_context(ctx);
+    std::remove(path);
 }
 
 TEST_CASE("INVERT", "[INVERT]")
@@ -3592,7 +4971,51 @@ TEST_CASE("MARKER", "[MARKER]")
 {
     forth_context* ctx = forth_create_context();
 
-    evalTestSection(ctx, "MARKER", FORTH_FAILURE, {}, "Unimplemented\n");
+    evalTest(ctx, "MARKER", FORTH_FAILURE, {}, "Expected name after 'MARKER'\n");
+    evalTest(ctx, ": foo MARKER ;", FORTH_SUCCESS, {});
+    evalTest(ctx, "foo", FORTH_FAILURE, {}, "Interpret-only word\n");
+    evalTest(ctx, "EMPTY", FORTH_SUCCESS, {});
+
+    auto memory_pointer = ctx->memory_pointer;
+    auto dict_pointer = ctx->dict_pointer;
+    auto names_pointer = ctx->dict_names_pointer;
+
+    evalTest(ctx, "MARKER -work", FORTH_SUCCESS, {});
+    evalTest(ctx, ": foo 1 ; : bar foo 2 ;", FORTH_SUCCESS, {});
+    evalTest(ctx, "bar", FORTH_SUCCESS, {1, 2});
+    evalTest(ctx, "2DROP -work", FORTH_SUCCESS, {});
+    REQUIRE(ctx->memory_pointer == memory_pointer);
+    REQUIRE(ctx->dict_pointer == dict_pointer);
+    REQUIRE(ctx->dict_names_pointer == names_pointer);
+    evalTest(ctx, "foo", FORTH_FAILURE, {}, "Undefined word\n");
+    evalTest(ctx, "-work", FORTH_FAILURE, {}, "Undefined word\n");
+
+    // Define, run, discard many times without leaking memory
+    for (int i = 0; i < 100; i++)
+    {
+        evalTest(ctx, "MARKER -request : handler 3 4 + ; handler -request", FORTH_SUCCESS, {7});
+        evalTest(ctx, "DROP", FORTH_SUCCESS, {});
+    }
+    REQUIRE(ctx->memory_pointer == memory_pointer);
+
+    // Called from words it removes, which still return through their code
+    evalTest(ctx, "MARKER M : RESET M 42 ; : OUTER RESET 43 ; OUTER", FORTH_SUCCESS, {42, 43});
+    REQUIRE(ctx->memory_pointer == memory_pointer);
+    REQUIRE(ctx->dict_pointer == dict_pointer);
+    evalTest(ctx, "2DROP RESET", FORTH_FAILURE, {}, "Undefined word\n");
+
+    // The earliest of the markers run wins
+    evalTest(ctx, "MARKER A MARKER B : BOTH B A 1 ; BOTH", FORTH_SUCCESS, {1});
+    REQUIRE(ctx->dict_pointer == dict_pointer);
+    evalTest(ctx, "DROP A", FORTH_FAILURE, {}, "Undefined word\n");
+
+    // Errors after the marker ran still rewind
+    evalTest(ctx, "MARKER M : FAIL M DROP ; FAIL", FORTH_FAILURE, {}, "Stack underflow\n");
+    REQUIRE(ctx->dict_pointer == dict_pointer);
+#if FORTH_GUARDED_STACKS
+    evalTest(ctx, "MARKER M : OVERFLOW M BEGIN 1 0 UNTIL ; OVERFLOW", FORTH_FAILURE, {}, "Stack overflow\n");
+    REQUIRE(ctx->dict_pointer == dict_pointer);
+#endif
 
     forth_destroy_context(ctx);
 }
@@ -3751,6 +5174,84 @@ TEST_CASE("n_r_from", "[n_r_from]")
     forth_destroy_context(ctx);
 }
 
+TEST_CASE("NUMBER", "[NUMBER]")
+{
+    forth_context* ctx = forth_create_context();
+
+    evalTestSection(ctx, "#10 $10 %10 -7", FORTH_SUCCESS, {10, 16, 2, -7});
+    evalTestSection(ctx, "HEX #10 $1f $1F 0x1F DECIMAL", FORTH_SUCCESS, {10, 31, 31, 31});
+    evalTestSection(ctx, "$-10 #-10 %-10", FORTH_SUCCESS, {-16, -10, -2});
+    evalTestSection(ctx, "'A' 'a' ''' '0'", FORTH_SUCCESS, {65, 97, 39, 48});
+    evalTestSection(ctx, "1. -1. $-5. 0.", FORTH_SUCCESS, {1, 0, -1, -1, -5, -1, 0, 0});
+    evalTestSection(ctx, ": D 1. 'x' -2 ; D", FORTH_SUCCESS, {1, 0, 120, -2});
+    evalTestSection(ctx, "1-2", FORTH_FAILURE, {}, "Undefined word\n");
+    evalTestSection(ctx, "1.2", FORTH_FAILURE, {}, "Undefined word\n");
+    evalTestSection(ctx, "1..", FORTH_FAILURE, {}, "Undefined word\n");
+    evalTestSection(ctx, "$", FORTH_FAILURE, {}, "Undefined word\n");
+    evalTestSection(ctx, "#-", FORTH_FAILURE, {}, "Undefined word\n");
+    evalTestSection(ctx, "%2", FORTH_FAILURE, {}, "Undefined word\n");
+    evalTestSection(ctx, "'ab'", FORTH_FAILURE, {}, "Undefined word\n");
+    evalTestSection(ctx, "--1", FORTH_FAILURE, {}, "Undefined word\n");
+
+    SECTION("Any base")
+    {
+        forth_int* base = (forth_int*)forthi_memory_at(ctx, ctx->base);
+        *base = 36;
+        evalTest(ctx, "Z z 10 #10", FORTH_SUCCESS, {35, 35, 36, 10});
+        *base = 2;
+        evalTest(ctx, "101 -11 $F", FORTH_SUCCESS, {35, 35, 36, 10, 5, -3, 15});
+        evalTest(ctx, "2", FORTH_FAILURE, {}, "Undefined word\n");
+        *base = 37;
+        evalTest(ctx, "1", FORTH_FAILURE, {}, "Unsupported base\n");
+        *base = 1;
+        evalTest(ctx, "1", FORTH_FAILURE, {}, "Unsupported base\n");
+        evalTest(ctx, "#1", FORTH_SUCCESS, {1});
+    }
+
+    SECTION("Range")
+    {
+        // Up to the largest unsigned cell, or double cell, and down to the
+        // smallest signed one
+        uint64_t max = (uint64_t)(forth_uint)-1;
+        std::string largest = std::to_string(max);
+        std::string smallest = "-" + std::to_string((max >> 1) + 1);
+        evalTest(ctx, largest.c_str(), FORTH_SUCCESS, {-1});
+        evalTest(ctx, smallest.c_str(), FORTH_SUCCESS, {-1, (int64_t)~(max >> 1)});
+        evalTest(ctx, ("-" + largest).c_str(), FORTH_FAILURE, {}, "Number out of range\n");
+        evalTest(ctx, ("-" + std::to_string((max >> 1) + 2)).c_str(), FORTH_FAILURE, {}, "Number out of range\n");
+        evalTest(ctx, (largest + "0").c_str(), FORTH_FAILURE, {}, "Number out of range\n");
+
+        uint64_t double_max = (uint64_t)(forth_double_length_uint)-1;
+        std::string double_largest = std::to_string(double_max) + ".";
+        std::string double_smallest = "-" + std::to_string((double_max >> 1) + 1) + ".";
+        uint64_t double_min = ~(double_max >> 1);
+        int64_t double_min_high = sizeof(forth_int) == 8 ? -1 : (forth_int)(double_min >> (sizeof(forth_int) * 8));
+        evalTest(ctx, double_largest.c_str(), FORTH_SUCCESS, {-1, sizeof(forth_int) == 8 ? 0 : -1});
+        evalTest(ctx, double_smallest.c_str(), FORTH_SUCCESS, 
+                 {-1, sizeof(forth_int) == 8 ? 0 : -1, (forth_int)double_min, double_min_high});
+        evalTest(ctx, ("-" + double_largest).c_str(), FORTH_FAILURE, {}, "Number out of range\n");
+        evalTest(ctx, ("1" + double_largest).c_str(), FORTH_FAILURE, {}, "Number out of range\n");
+#if !FORTH_INT_SIZE_64_BITS
+        uint64_t ten_times = max * 10;
+        evalTest(ctx, (largest + "0.").c_str(), FORTH_SUCCESS, 
+                 {(forth_int)ten_times, (forth_int)(ten_times >> (sizeof(forth_int) * 8))});
+#endif
+    }
+
+    SECTION("Token bounds")
+    {
+        REQUIRE(forth_eval_n(ctx, "12345", 3) == FORTH_SUCCESS);
+        REQUIRE(forth_get_top(ctx)->int_value == 123);
+        LogCapturer log_capturer(ctx);
+        REQUIRE(forth_eval_n(ctx, "'A'", 2) == FORTH_FAILURE);
+        REQUIRE(LogCapturer::log == "Undefined word\n");
+        REQUIRE(forth_eval_n(ctx, "7.", 1) == FORTH_SUCCESS);
+        REQUIRE(ctx->stack_pointer == 1);
+    }
+
+    forth_destroy_context(ctx);
+}
+
 TEST_CASE("OCTAL", "[OCTAL]")
 {
     forth_context* ctx = forth_create_context();
@@ -3833,7 +5334,13 @@ TEST_CASE("PAD", "[PAD]")
 {
     forth_context* ctx = forth_create_context();
 
-    evalTestSection(ctx, "PAD", FORTH_FAILURE, {}, "Unimplemented\n");
+    forth_pointer memory_pointer = ctx->memory_pointer;
+
+    REQUIRE(forth_eval(ctx, "PAD S\" abc\" 2DROP PAD") == FORTH_SUCCESS);
+    REQUIRE(ctx->stack_pointer == 2);
+    REQUIRE(forth_get_top(ctx, 0)->pointer_value == forth_get_top(ctx, 1)->pointer_value);
+    REQUIRE(forthi_check_valid_memory_range(ctx, forth_get_top(ctx)->pointer_value, 84) == FORTH_SUCCESS);
+    REQUIRE(ctx->memory_pointer == memory_pointer);
 
     forth_destroy_context(ctx);
 }
@@ -3851,7 +5358,12 @@ TEST_CASE("PARSE", "[PARSE]")
 {
     forth_context* ctx = forth_create_context();
 
-    evalTestSection(ctx, "PARSE", FORTH_FAILURE, {}, "Unimplemented\n");
+    evalTestSection(ctx, "PARSE", FORTH_FAILURE, {}, "Stack underflow\n");
+
+    REQUIRE(forth_eval(ctx, "41 PARSE abc) DROP") == FORTH_SUCCESS);
+    REQUIRE(ctx->stack_pointer == 1);
+    REQUIRE(forth_eval(ctx, "DROP 41 PARSE  a b )") == FORTH_SUCCESS);
+    REQUIRE(topString(ctx) == " a b ");
 
     forth_destroy_context(ctx);
 }
@@ -3981,7 +5493,7 @@ TEST_CASE("REFILL", "[REFILL]")
 {
     forth_context* ctx = forth_create_context();
 
-    evalTestSection(ctx, "REFILL", FORTH_FAILURE, {}, "Unimplemented\n");
+    evalTestSection(ctx, "REFILL", FORTH_SUCCESS, {0});
 
     forth_destroy_context(ctx);
 }
@@ -4033,27 +5545,119 @@ TEST_CASE("REPRESENT", "[REPRESENT]")
 
 TEST_CASE("REQUIRE", "[REQUIRE]")
 {
+    const char* path = "require.f";
+    writeRequiredFile(path);
     forth_context* ctx = forth_create_context();
 
-    evalTestSection(ctx, "REQUIRE", FORTH_FAILURE, {}, "Unimplemented\n");
+    evalTestSection(ctx, "REQUIRE", FORTH_FAILURE, {}, "No such file or directory\n");
+    evalTestSection(ctx, "REQUIRE bad_filename.f", FORTH_FAILURE, {}, "No such file or directory\n");
+    evalTestSection(ctx, "REQUIRE require.f REQUIRE require.f", FORTH_SUCCESS, {7});
+    evalTestSection(ctx, "INCLUDE require.f REQUIRE ./require.f", FORTH_SUCCESS, {7});
+    evalTestSection(ctx, "REQUIRE INCLUDE_INCLUDE.f REQUIRE INCLUDE.f bar", FORTH_SUCCESS, {}, "foo\n");
 
     forth_destroy_context(ctx);
+    std::remove(path);
 }
 
 TEST_CASE("REQUIRED", "[REQUIRED]")
 {
+    const char* path = "required.f";
+    writeRequiredFile(path);
     forth_context* ctx = forth_create_context();
 
-    evalTestSection(ctx, "REQUIRED", FORTH_FAILURE, {}, "Unimplemented\n");
+    evalTestSection(ctx, "REQUIRED", FORTH_FAILURE, {}, "Stack underflow\n");
+    evalTestSection(ctx, "S\" bad_filename.f\" REQUIRED", FORTH_FAILURE, {}, "No such file or directory\n");
+    evalTestSection(ctx, "S\" required.f\" REQUIRED S\" required.f\" REQUIRED", FORTH_SUCCESS, {7});
+    evalTestSection(ctx, "S\" required.f\" REQUIRED S\" ./required.f\" REQUIRED", FORTH_SUCCESS, {7});
+
+    SECTION("Child context")
+    {
+        evalTest(ctx, "S\" required.f\" REQUIRED DROP", FORTH_SUCCESS, {});
+        forth_freeze_context(ctx);
+        forth_context* child = forth_create_child_context(ctx);
+        evalTest(child, "S\" required.f\" REQUIRED", FORTH_SUCCESS, {});
+        REQUIRE(child->included_files_pointer == 0);
+        forth_destroy_context(child);
+    }
+
+    SECTION("Clone")
+    {
+        evalTest(ctx, "S\" required.f\" REQUIRED DROP", FORTH_SUCCESS, {});
+        forth_context* clone = forth_clone_context(ctx);
+        REQUIRE(clone);
+        evalTest(clone, "S\" required.f\" REQUIRED", FORTH_SUCCESS, {});
+        writeRequiredFile("required_too.f");
+        evalTest(clone, "S\" required_too.f\" REQUIRED", FORTH_SUCCESS, {7});
+        REQUIRE(clone->included_files_pointer == 2);
+        forth_destroy_context(clone);
+        std::remove("required_too.f");
+    }
 
     forth_destroy_context(ctx);
+    std::remove(path);
 }
 
 TEST_CASE("RESIZE", "[RESIZE]")
 {
     forth_context* ctx = forth_create_context();
 
-    evalTestSection(ctx, "RESIZE", FORTH_FAILURE, {}, "Unimplemented\n");
+    evalTestSection(ctx, "RESIZE", FORTH_FAILURE, {}, "Stack underflow\n");
+    evalTestSection(ctx, "0 10 RESIZE", FORTH_SUCCESS, {0, -61});
+    evalTestSection(ctx, "10 ALLOCATE DROP 100 RESIZE DROP FREE", FORTH_SUCCESS, {0});
+
+    SECTION("Huge sizes")
+    {
+        forth_pointer a = 0;
+        forth_pointer new_at = 0;
+        REQUIRE(forthi_heap_alloc(ctx, 16, &a) == FORTH_SUCCESS);
+        REQUIRE(forthi_heap_resize(ctx, a, ~(forth_pointer)0, &new_at) == FORTH_FAILURE);
+        REQUIRE(forthi_heap_resize(ctx, a, (forth_pointer)UINT32_MAX, &new_at) == FORTH_FAILURE);
+
+        // -1 is a valid size when cells are small
+        if (sizeof(forth_uint) >= 4)
+            evalTest(ctx, "16 ALLOCATE DROP -1 RESIZE SWAP DROP", FORTH_SUCCESS, {-61});
+
+        forth_heap_stats stats;
+        forth_get_heap_stats(ctx, &stats);
+        REQUIRE(stats.block_count == (sizeof(forth_uint) >= 4 ? 2 : 1));
+        REQUIRE(stats.used == (sizeof(forth_uint) >= 4 ? 32 : 16));
+    }
+
+    SECTION("Interior addresses")
+    {
+        forth_pointer a = 0;
+        forth_pointer new_at = 0;
+        REQUIRE(forthi_heap_alloc(ctx, 100, &a) == FORTH_SUCCESS);
+        REQUIRE(forthi_heap_resize(ctx, a + 16, 8, &new_at) == FORTH_FAILURE);
+        REQUIRE(forthi_heap_resize(ctx, a + 32, 200, &new_at) == FORTH_FAILURE);
+
+        forth_heap_stats stats;
+        forth_get_heap_stats(ctx, &stats);
+        REQUIRE(stats.block_count == 1);
+        REQUIRE(stats.used == 100);
+    }
+
+    SECTION("Content is kept")
+    {
+        REQUIRE(forth_eval(ctx, "8 ALLOCATE DROP") == FORTH_SUCCESS);
+        forth_pointer a = forth_get_top(ctx)->pointer_value;
+        memcpy(forthi_memory_at(ctx, a), "ABCDEFGH", 8);
+
+        // Shrinking stays in place
+        REQUIRE(forth_eval(ctx, "4 RESIZE DROP") == FORTH_SUCCESS);
+        REQUIRE(forth_get_top(ctx)->pointer_value == a);
+
+        REQUIRE(forth_eval(ctx, "120 RESIZE") == FORTH_SUCCESS);
+        REQUIRE(forth_get_top(ctx)->int_value == 0);
+        forth_pointer b = forth_get_top(ctx, 1)->pointer_value;
+        REQUIRE(b != a);
+        REQUIRE(memcmp(forthi_memory_at(ctx, b), "ABCD", 4) == 0);
+
+        forth_heap_stats stats;
+        forth_get_heap_stats(ctx, &stats);
+        REQUIRE(stats.block_count == 1);
+        REQUIRE(stats.used == 120);
+    }
 
     forth_destroy_context(ctx);
 }
@@ -4071,7 +5675,11 @@ TEST_CASE("RESTORE_INPUT", "[RESTORE_INPUT]")
 {
     forth_context* ctx = forth_create_context();
 
-    evalTestSection(ctx, "RESTORE-INPUT", FORTH_FAILURE, {}, "Unimplemented\n");
+    evalTestSection(ctx, ": REPLAY DUP 3 = IF RESTORE-INPUT THEN ; SAVE-INPUT REPLAY 7", FORTH_SUCCESS, {0, 7});
+    evalTestSection(ctx, "1 2 3 3 RESTORE-INPUT", FORTH_SUCCESS, {-1});
+    evalTestSection(ctx, "5 1 RESTORE-INPUT", FORTH_SUCCESS, {-1});
+    evalTestSection(ctx, "RESTORE-INPUT", FORTH_FAILURE, {}, "Stack underflow\n");
+    evalTestSection(ctx, "3 RESTORE-INPUT", FORTH_FAILURE, {}, "Stack underflow\n");
 
     forth_destroy_context(ctx);
 }
@@ -4111,7 +5719,46 @@ TEST_CASE("s_quote", "[s_quote]")
 {
     forth_context* ctx = forth_create_context();
 
-    evalTestSection(ctx, "S\"", FORTH_FAILURE, {}, "Unimplemented\n");
+    forth_pointer memory_pointer = ctx->memory_pointer;
+
+    SECTION("Unterminated")
+    {
+        REQUIRE(forth_eval(ctx, "S\" hello") == FORTH_SUCCESS);
+        REQUIRE(topString(ctx) == "hello");
+    }
+
+    SECTION("Transient")
+    {
+        REQUIRE(forth_eval(ctx, "S\" hello world\"") == FORTH_SUCCESS);
+        REQUIRE(ctx->stack_pointer == 2);
+        REQUIRE(topString(ctx) == "hello world");
+        REQUIRE(ctx->memory_pointer == memory_pointer);
+        forth_pointer first = forth_get_top(ctx, 1)->pointer_value;
+
+        // Transient strings of an evaluation don't overlap
+        REQUIRE(forth_eval(ctx, "2DROP S\" a\" S\" b\"") == FORTH_SUCCESS);
+        REQUIRE(topString(ctx) == "b");
+        REQUIRE(forth_get_top(ctx, 3)->pointer_value == first);
+        REQUIRE(forth_get_top(ctx, 1)->pointer_value == first + 1);
+
+        // Many strings don't grow the data space or the heap
+        std::string source;
+        for (int i = 0; i < 1000; i++)
+            source += "S\" some text\" 2DROP ";
+        REQUIRE(forth_eval(ctx, source.c_str()) == FORTH_SUCCESS);
+        REQUIRE(ctx->memory_pointer == memory_pointer);
+        REQUIRE(ctx->heap.pointer == 0);
+    }
+
+    SECTION("Compiled")
+    {
+        REQUIRE(forth_eval(ctx, ": GREET S\" hi there\" ; GREET") == FORTH_SUCCESS);
+        REQUIRE(topString(ctx) == "hi there");
+        REQUIRE(forth_get_top(ctx, 1)->pointer_value < ctx->memory_pointer);
+        REQUIRE(forth_eval(ctx, "2DROP GREET GREET") == FORTH_SUCCESS);
+        REQUIRE(forth_get_top(ctx, 1)->pointer_value == forth_get_top(ctx, 3)->pointer_value);
+        REQUIRE(topString(ctx) == "hi there");
+    }
 
     forth_destroy_context(ctx);
 }
@@ -4147,7 +5794,7 @@ TEST_CASE("SAVE_INPUT", "[SAVE_INPUT]")
 {
     forth_context* ctx = forth_create_context();
 
-    evalTestSection(ctx, "SAVE-INPUT", FORTH_FAILURE, {}, "Unimplemented\n");
+    evalTestSection(ctx, "SAVE-INPUT SWAP DROP SWAP DROP", FORTH_SUCCESS, {10, 3});
 
     forth_destroy_context(ctx);
 }
@@ -4282,7 +5929,13 @@ TEST_CASE("SIGN", "[SIGN]")
 {
     forth_context* ctx = forth_create_context();
 
-    evalTestSection(ctx, "SIGN", FORTH_FAILURE, {}, "Unimplemented\n");
+    evalTestSection(ctx, "SIGN", FORTH_FAILURE, {}, "Stack underflow\n");
+    evalTestSection(ctx, "-1 SIGN", FORTH_FAILURE, {}, "Missing <#\n");
+
+    REQUIRE(forth_eval(ctx, ": SIGNED DUP ABS 0 <# #S ROT SIGN #> ; -12 SIGNED") == FORTH_SUCCESS);
+    REQUIRE(topString(ctx) == "-12");
+    REQUIRE(forth_eval(ctx, "2DROP 12 SIGNED") == FORTH_SUCCESS);
+    REQUIRE(topString(ctx) == "12");
 
     forth_destroy_context(ctx);
 }
@@ -4309,7 +5962,13 @@ TEST_CASE("SOURCE", "[SOURCE]")
 {
     forth_context* ctx = forth_create_context();
 
-    evalTestSection(ctx, "SOURCE", FORTH_FAILURE, {}, "Unimplemented\n");
+    evalTestSection(ctx, "SOURCE SWAP DROP", FORTH_SUCCESS, {16});
+
+    SECTION("Text")
+    {
+        REQUIRE(forth_eval(ctx, "1 SOURCE") == FORTH_SUCCESS);
+        REQUIRE(topString(ctx) == "1 SOURCE");
+    }
 
     forth_destroy_context(ctx);
 }
@@ -4707,7 +6366,24 @@ TEST_CASE("WORD", "[WORD]")
 {
     forth_context* ctx = forth_create_context();
 
-    evalTestSection(ctx, "WORD", FORTH_FAILURE, {}, "Unimplemented\n");
+    evalTestSection(ctx, "WORD", FORTH_FAILURE, {}, "Stack underflow\n");
+
+    SECTION("Counted strings")
+    {
+        REQUIRE(forth_eval(ctx, "32 WORD    hello 44 WORD ,,abc, 1") == FORTH_SUCCESS);
+        REQUIRE(ctx->stack_pointer == 3);
+        const uint8_t* hello = forthi_memory_at(ctx, forth_get_top(ctx, 2)->pointer_value);
+        const uint8_t* abc = forthi_memory_at(ctx, forth_get_top(ctx, 1)->pointer_value);
+        REQUIRE(std::string((const char*)hello + 1, hello[0]) == "hello");
+        REQUIRE(std::string((const char*)abc + 1, abc[0]) == "abc");
+    }
+
+    SECTION("Compiled")
+    {
+        REQUIRE(forth_eval(ctx, ": NAME 32 WORD ; NAME foo") == FORTH_SUCCESS);
+        const uint8_t* foo = forthi_memory_at(ctx, forth_get_top(ctx)->pointer_value);
+        REQUIRE(std::string((const char*)foo + 1, foo[0]) == "foo");
+    }
 
     forth_destroy_context(ctx);
 }